@@ -0,0 +1,347 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef CHARCONV_HPP
+#define CHARCONV_HPP
+
+#include <cmath>
+#include <cfloat>
+#include <limits>
+#include <locale>
+#include <string>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <system_error>
+#include "Config.hpp"
+#include "String.hpp"
+#include "PowersOfFive.hpp"
+#include "NumberFormat.hpp"
+
+//! Outcome of parse_number, modelled after std::from_chars_result (C++17).
+//! \a ptr points past the last character consumed; on failure \a ec is set
+//! and the output value is left untouched.
+struct ParseResult{
+    const char* ptr;
+    std::errc ec;
+
+    explicit operator bool () const { return ec == std::errc(); }
+};
+
+namespace charconv_detail {
+
+inline bool FORCE_INLINE is_digit(char c){
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+//! Loads 8 characters so that the first one lands in the lowest byte
+inline uint64_t FORCE_INLINE read_eight(const char* p){
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+//! SWAR test: true when all 8 bytes are in '0'..'9'
+inline bool FORCE_INLINE is_eight_digits(uint64_t v){
+    return !(((v + 0x4646464646464646ULL) | (v - 0x3030303030303030ULL)) & 0x8080808080808080ULL);
+}
+
+//! SWAR conversion of 8 digits in three multiplications instead of eight
+inline uint32_t FORCE_INLINE parse_eight_digits(uint64_t v){
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL;    // 100 + (1000000ULL << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL;    // 1 + (10000ULL << 32)
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(v);
+}
+
+//! Accumulates the decimal digits starting at \a p into \a value (modulo 2^64)
+//! and returns the end of the digits
+inline const char* accumulate_digits(const char* p, const char* last, uint64_t& value){
+    while(last - p >= 8){
+        const uint64_t chunk = read_eight(p);
+        if(!is_eight_digits(chunk))
+            break;
+        value = value * 100000000 + parse_eight_digits(chunk);
+        p += 8;
+    }
+    for(; p != last && is_digit(*p); ++p)
+        value = value * 10 + static_cast<unsigned>(*p - '0');
+    return p;
+}
+
+inline int FORCE_INLINE leading_zeroes(uint64_t v){
+#ifdef __GNUC__
+    return __builtin_clzll(v);
+#else
+    int n = 0;
+    for(; !(v & 0x8000000000000000ULL); v <<= 1) n++;
+    return n;
+#endif
+}
+
+//! Binary significand (without the implicit bit) and biased binary exponent.
+//! power2 < 0 means the fast path could not decide the rounding.
+struct AdjustedMantissa{
+    uint64_t mantissa;
+    int power2;
+
+    friend bool operator == (const AdjustedMantissa& x, const AdjustedMantissa& y){
+        return x.mantissa == y.mantissa && x.power2 == y.power2;
+    }
+};
+
+constexpr int kMantissaBits = 52;
+constexpr int kMinimumExponent = -1023;
+constexpr int kInfinitePower = 0x7FF;
+//! Any non zero significand times a larger power of ten overflows
+constexpr int kLargestPower10 = 308;
+
+//! Eisel-Lemire: rounds w * 10^q to the nearest double using a 128 bit
+//! approximation of 5^q. w must be the exact decimal significand.
+inline AdjustedMantissa compute_float(int64_t q, uint64_t w){
+    using Powers = PowersOfFive<>;
+    if(w == 0 || q < Powers::kSmallest)
+        return {0, 0};
+    if(q > kLargestPower10)
+        return {0, kInfinitePower};
+
+    const int lz = leading_zeroes(w);
+    w <<= lz;
+
+    const std::size_t index = 2 * static_cast<std::size_t>(q - Powers::kSmallest);
+    UInt128 product = full_multiplication(w, Powers::table[index]);
+    const uint64_t precision_mask = 0xFFFFFFFFFFFFFFFFULL >> (kMantissaBits + 3);
+    if((product.high & precision_mask) == precision_mask){
+        const UInt128 second = full_multiplication(w, Powers::table[index + 1]);
+        product.low += second.high;
+        if(second.high > product.low)
+            product.high++;
+        // Out of the exponent range where 5^q is exact, an all ones low word is ambiguous
+        if(product.low == 0xFFFFFFFFFFFFFFFFULL && (q < -27 || q > 55))
+            return {0, -1};
+    }
+
+    const int upperbit = static_cast<int>(product.high >> 63);
+    AdjustedMantissa answer;
+    answer.mantissa = product.high >> (upperbit + 64 - kMantissaBits - 3);
+    answer.power2 = static_cast<int>((((152170 + 65536) * q) >> 16) + 63) + upperbit - lz - kMinimumExponent;
+
+    if(answer.power2 <= 0){     // subnormal
+        if(-answer.power2 + 1 >= 64)
+            return {0, 0};
+        answer.mantissa >>= -answer.power2 + 1;
+        answer.mantissa += (answer.mantissa & 1);
+        answer.mantissa >>= 1;
+        answer.power2 = (answer.mantissa < (uint64_t(1) << kMantissaBits)) ? 0 : 1;
+        return answer;
+    }
+
+    // Ties are rounded to even, which only happens for small exponents
+    if(product.low <= 1 && q >= -4 && q <= 23 && (answer.mantissa & 3) == 1){
+        if((answer.mantissa << (upperbit + 64 - kMantissaBits - 3)) == product.high)
+            answer.mantissa &= ~uint64_t(1);
+    }
+
+    answer.mantissa += (answer.mantissa & 1);
+    answer.mantissa >>= 1;
+    if(answer.mantissa >= (uint64_t(2) << kMantissaBits)){
+        answer.mantissa = uint64_t(1) << kMantissaBits;
+        answer.power2++;
+    }
+    answer.mantissa &= ~(uint64_t(1) << kMantissaBits);
+    if(answer.power2 >= kInfinitePower)
+        return {0, kInfinitePower};
+    return answer;
+}
+
+inline double FORCE_INLINE to_double(AdjustedMantissa am, bool negative){
+    const uint64_t bits = am.mantissa | (uint64_t(am.power2) << kMantissaBits) | (uint64_t(negative) << 63);
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+//! Clinger's fast path: both w and 10^|q| are exact doubles, so a single
+//! correctly rounded operation gives the correctly rounded result
+inline bool clinger(uint64_t w, int64_t q, bool negative, double& value){
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+    (void)w; (void)q; (void)negative; (void)value;
+    return false;
+#else
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    if(q < -22 || q > 22 || w > (uint64_t(1) << 53))
+        return false;
+    double d = static_cast<double>(w);
+    d = q < 0 ? d / powers[-q] : d * powers[q];
+    value = negative ? -d : d;
+    return true;
+#endif
+}
+
+//! Correct but slow: the C locale's stream parser, only for the inputs the
+//! fast paths cannot round with certainty (more than 19 significant digits)
+inline bool parse_slow(const char* first, const char* last, double& value){
+    std::istringstream ss(std::string(first, last));
+    ss.imbue(std::locale::classic());
+    double d;
+    ss >> d;
+    if(ss.fail())
+        return false;
+    value = d;
+    return true;
+}
+
+} // namespace charconv_detail
+
+
+//! Parses a decimal integer: an optional '-' (signed types only) followed by
+//! digits. No whitespace, '+' or base prefixes are accepted, no locale is used.
+template<typename T>
+inline std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value, ParseResult>
+parse_number(const char* first, const char* last, T& value){
+    using namespace charconv_detail;
+    const char* p = first;
+    const bool negative = std::is_signed<T>::value && p != last && *p == '-';
+    if(negative)
+        ++p;
+    const char* digits = p;
+    while(p != last && *p == '0')
+        ++p;
+    const char* significant = p;
+
+    uint64_t magnitude = 0;
+    p = accumulate_digits(p, last, magnitude);
+    if(p == digits)
+        return { first, std::errc::invalid_argument };
+
+    // 20 digit values fit in 64 bits only if they start with a 1 and did not wrap
+    const std::ptrdiff_t count = p - significant;
+    const bool overflow = count > 20 ||
+            (count == 20 && (*significant != '1' || magnitude < 10000000000000000000ULL));
+    const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+    if(overflow || magnitude > limit)
+        return { p, std::errc::result_out_of_range };
+
+    value = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+    return { p, std::errc() };
+}
+
+//! Parses a decimal floating point number as accepted by JSON, plus a leading
+//! '.' or a trailing '.': -12.5e-3, .5, 5. (no inf, nan or hexadecimal).
+//! The result is always correctly rounded and independent of the locale.
+inline ParseResult parse_number(const char* first, const char* last, double& value){
+    using namespace charconv_detail;
+    const char* p = first;
+    const bool negative = p != last && *p == '-';
+    if(negative)
+        ++p;
+
+    uint64_t mantissa = 0;
+    const char* const int_begin = p;
+    p = accumulate_digits(p, last, mantissa);
+    const char* const int_end = p;
+
+    const char* frac_begin = p;
+    const char* frac_end = p;
+    if(p != last && *p == '.'){
+        frac_begin = ++p;
+        p = accumulate_digits(p, last, mantissa);
+        frac_end = p;
+    }
+    if(int_begin == int_end && frac_begin == frac_end)
+        return { first, std::errc::invalid_argument };
+
+    int64_t exponent = 0;
+    if(p != last && (*p == 'e' || *p == 'E')){
+        const char* e = p + 1;
+        const bool negative_exponent = e != last && *e == '-';
+        if(e != last && (*e == '-' || *e == '+'))
+            ++e;
+        if(e != last && is_digit(*e)){
+            int64_t number = 0;
+            for(; e != last && is_digit(*e); ++e)
+                if(number < 0x10000000)
+                    number = number * 10 + (*e - '0');
+            exponent = negative_exponent ? -number : number;
+            p = e;
+        }
+    }
+
+    // Count the significant digits; beyond 19 the mantissa above has wrapped
+    std::ptrdiff_t significant = (int_end - int_begin) + (frac_end - frac_begin);
+    for(const char* z = int_begin; z != frac_end && (*z == '0' || *z == '.'); ++z)
+        if(*z == '0')
+            --significant;
+
+    bool truncated = false;
+    if(significant > 19){
+        // Keep the leading 19 significant digits and scale for the rest
+        truncated = true;
+        mantissa = 0;
+        int taken = 0;
+        for(const char* z = int_begin; z != int_end; ++z){
+            if(taken == 0 && *z == '0')
+                continue;
+            if(taken < 19){ mantissa = mantissa * 10 + static_cast<unsigned>(*z - '0'); taken++; }
+            else exponent++;
+        }
+        for(const char* z = frac_begin; z != frac_end && taken < 19; ++z){
+            exponent--;
+            if(taken == 0 && *z == '0')
+                continue;
+            mantissa = mantissa * 10 + static_cast<unsigned>(*z - '0');
+            taken++;
+        }
+    }
+    else
+        exponent -= frac_end - frac_begin;
+
+    double result;
+    if(!truncated && clinger(mantissa, exponent, negative, result)){
+        value = result;
+        return { p, std::errc() };
+    }
+
+    AdjustedMantissa am = compute_float(exponent, mantissa);
+    // The dropped digits lie between mantissa and mantissa + 1
+    if(truncated && am.power2 >= 0 && !(am == compute_float(exponent, mantissa + 1)))
+        am.power2 = -1;
+
+    if(am.power2 < 0){
+        if(!parse_slow(first, p, result))
+            return { p, std::errc::result_out_of_range };
+    }
+    else
+        result = to_double(am, negative);
+
+    if((result == 0 && mantissa != 0) || std::abs(result) > std::numeric_limits<double>::max())
+        return { p, std::errc::result_out_of_range };
+    value = result;
+    return { p, std::errc() };
+}
+
+//! Parses the whole of \a str, or a prefix of it (see ParseResult::ptr).
+//! Also accepts FString, which converts to a view.
+template<typename T>
+inline ParseResult parse_number(FStringView str, T& value){
+    return parse_number(str.data(), str.data() + str.size(), value);
+}
+
+#endif // CHARCONV_HPP
@@ -14,6 +14,7 @@
 #define PLATFORM_CONFIG_H
 
 #include <new>
+#include <cstdlib>
 #include <limits>
 #include <iterator>
 #include <type_traits>
@@ -29,17 +30,39 @@
 
 using SizeType = unsigned int;
 
+//! Storage comes from malloc, so a buffer of relocatable elements can be
+//! grown with reallocate(), in place when the pages after it are free
 template <typename T>
 class SFAllocator {
 public:
+    template<typename U>
+    using rebind = SFAllocator<U>;
+
     static inline void* FORCE_INLINE allocate(SizeType sz){
-        return operator new(sz * sizeof(T));
+        void* m = std::malloc(sz * sizeof(T));
+        if(!m && sz)
+            throw std::bad_alloc();
+        return m;
+    }
+    static inline void* FORCE_INLINE reallocate(void* m, SizeType sz){
+        void* r = std::realloc(m, sz * sizeof(T));
+        if(!r && sz)
+            throw std::bad_alloc();
+        return r;
     }
     static inline void FORCE_INLINE deallocate(void* m){
-        operator delete (m);
+        std::free(m);
     }
 };
 
+//! Whether a T may be moved to another address with memcpy, leaving the
+//! source as raw memory: no move constructor runs and no destructor runs
+//! on the source. Trivially copyable types are; types that hold no
+//! pointer into themselves (FString, FVector, HashMap) opt in by
+//! specializing this.
+template<typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
 template <typename T>
 inline void nulled_delete(T* ptr){
     delete ptr;
@@ -0,0 +1,246 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef ESCAPE_HPP
+#define ESCAPE_HPP
+
+#include <cstring>
+#include <system_error>
+#include "Config.hpp"
+#include "Simd.hpp"
+#include "String.hpp"
+#include "Unicode.hpp"
+
+//! Outcome of unescape_json. \a str holds the decoded characters; on
+//! failure \a ec is set and \a ptr points to the offending backslash.
+struct UnescapeResult{
+    FStringView str;
+    const char* ptr;
+    std::errc ec;
+
+    explicit operator bool () const { return ec == std::errc(); }
+};
+
+namespace escape_detail {
+
+//! What a JSON string cannot hold as is: '"', '\\' and the controls below 0x20
+inline bool FORCE_INLINE needs_escape(unsigned char c){
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+inline const char* find_escape_scalar(const char* p, const char* last){
+    for(; p != last; ++p)
+        if(needs_escape(static_cast<unsigned char>(*p)))
+            return p;
+    return nullptr;
+}
+
+#ifdef SIMD_SSE2
+//! Three compares per 16 bytes; c <= 0x1F is tested as min(c, 0x1F) == c
+inline const char* find_escape_sse2(const char* p, const char* last){
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    for(; last - p >= 16; p += 16){
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+                                          _mm_cmpeq_epi8(_mm_min_epu8(block, control), block));
+        const int mask = _mm_movemask_epi8(hits);
+        if(mask)
+            return p + simd::lowest_bit(static_cast<unsigned>(mask));
+    }
+    return find_escape_scalar(p, last);
+}
+#endif // SIMD_SSE2
+
+#ifdef SIMD_AVX2
+TARGET_AVX2 inline const char* find_escape_avx2(const char* p, const char* last){
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1F);
+    for(; last - p >= 32; p += 32){
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)),
+                                             _mm256_cmpeq_epi8(_mm256_min_epu8(block, control), block));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+        if(mask)
+            return p + simd::lowest_bit(mask);
+    }
+    return find_escape_scalar(p, last);
+}
+#endif // SIMD_AVX2
+
+//! The first character of [p, last) that must be escaped, nullptr if none
+inline const char* find_escape(const char* p, const char* last){
+#ifdef SIMD_AVX2
+    if(last - p >= 32 && simd::cpu_has_avx2())
+        return find_escape_avx2(p, last);
+#endif
+#ifdef SIMD_SSE2
+    return find_escape_sse2(p, last);
+#else
+    return find_escape_scalar(p, last);
+#endif
+}
+
+//! The short escape for \a c, 0 if it is written as \\u00XX
+inline char FORCE_INLINE short_escape(unsigned char c){
+    switch(c){
+        case '"': return '"';
+        case '\\': return '\\';
+        case '\b': return 'b';
+        case '\f': return 'f';
+        case '\n': return 'n';
+        case '\r': return 'r';
+        case '\t': return 't';
+        default: return 0;
+    }
+}
+
+inline int FORCE_INLINE hex_value(char c){
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+//! Reads the four hex digits at \a p, -1 if they are not all hex digits
+inline long FORCE_INLINE read_hex4(const char* p){
+    long v = 0;
+    for(int i = 0; i < 4; i++){
+        const int d = hex_value(p[i]);
+        if(d < 0)
+            return -1;
+        v = (v << 4) | d;
+    }
+    return v;
+}
+
+//! Decodes the escape whose backslash is at \a p into \a out. Returns the
+//! end of the escape, nullptr if it is malformed. A lone surrogate becomes
+//! U+FFFD, as in the transcoders of Unicode.hpp.
+inline const char* decode_escape(const char* p, const char* last, char*& out){
+    if(last - p < 2)
+        return nullptr;
+    char c;
+    switch(p[1]){
+        case '"': c = '"'; break;
+        case '\\': c = '\\'; break;
+        case '/': c = '/'; break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u': {
+            if(last - p < 6)
+                return nullptr;
+            const long unit = read_hex4(p + 2);
+            if(unit < 0)
+                return nullptr;
+            char32_t cp = static_cast<char32_t>(unit);
+            const char* end = p + 6;
+            if(unit >= 0xD800 && unit <= 0xDBFF && last - end >= 6 && end[0] == '\\' && end[1] == 'u'){
+                const long low = read_hex4(end + 2);
+                if(low >= 0xDC00 && low <= 0xDFFF){
+                    cp = 0x10000 + ((static_cast<char32_t>(unit) - 0xD800) << 10) + (static_cast<char32_t>(low) - 0xDC00);
+                    end += 6;
+                }
+            }
+            out = transcode_detail::encode(out, transcode_detail::sanitize(cp));
+            return end;
+        }
+        default:
+            return nullptr;
+    }
+    *out++ = c;
+    return p + 2;
+}
+
+} // namespace escape_detail
+
+
+//! Appends \a str to \a out escaped for a JSON string literal (without the
+//! enclosing quotes). Clean runs are found 16 or 32 bytes at a time and
+//! copied in bulk; UTF-8 passes through unchanged.
+template<typename Allocator>
+inline void append_json_escaped(Basic_fstring<char, Allocator>& out, FStringView str){
+    using namespace escape_detail;
+    const char* p = str.data();
+    const char* const last = p + str.size();
+    out.reserve(out.size() + str.size() + str.size() / 8);
+    for(;;){
+        const char* hit = find_escape(p, last);
+        const char* stop = hit ? hit : last;
+        out.append(p, static_cast<SizeType>(stop - p));
+        if(!hit)
+            return;
+        const unsigned char c = static_cast<unsigned char>(*hit);
+        if(const char e = short_escape(c)){
+            const char escape[2] = { '\\', e };
+            out.append(escape, 2);
+        }
+        else{
+            const char* hex = "0123456789abcdef";
+            const char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+            out.append(escape, 6);
+        }
+        p = hit + 1;
+    }
+}
+
+inline FString escape_json(FStringView str){
+    FString out;
+    append_json_escaped(out, str);
+    return out;
+}
+
+//! Decodes the escapes of a JSON string literal's contents (without the
+//! quotes): \" \\ \/ \b \f \n \r \t and \uXXXX, surrogate pairs included,
+//! into UTF-8. When \a str has no backslash the result views \a str itself,
+//! nothing is copied; otherwise \a buffer receives the decoded characters,
+//! in a single allocation at most, and the result views it.
+template<typename Allocator>
+inline UnescapeResult unescape_json(FStringView str, Basic_fstring<char, Allocator>& buffer){
+    using namespace escape_detail;
+    const char* p = str.data();
+    const char* const last = p + str.size();
+    const char* hit = simd::find_char(p, last, '\\');
+    if(!hit)
+        return { str, last, std::errc() };
+
+    // Every escape decodes to fewer bytes than it is written in
+    const char* error = nullptr;
+    buffer.clear();
+    buffer.resize_and_overwrite(str.size(), [&](char* out, SizeType){
+        char* const begin = out;
+        while(hit){
+            const SizeType clean = static_cast<SizeType>(hit - p);
+            std::memcpy(out, p, clean);
+            out += clean;
+            p = decode_escape(hit, last, out);
+            if(!p){
+                error = hit;
+                return SizeType(0);
+            }
+            hit = simd::find_char(p, last, '\\');
+        }
+        std::memcpy(out, p, static_cast<SizeType>(last - p));
+        out += last - p;
+        return static_cast<SizeType>(out - begin);
+    });
+    if(error)
+        return { FStringView(), error, std::errc::invalid_argument };
+    return { buffer.view(), last, std::errc() };
+}
+
+#endif // ESCAPE_HPP
@@ -14,13 +14,22 @@
 #define FVECTOR_H
 
 #include "Config.hpp"
+#include <cstring>
 #include <utility>
 #include <type_traits>
 #include <initializer_list>
 #include <iterator>
+#include <algorithm>
+#include <functional>
+#include <memory>
 using SizeType = uint32_t;
 
-template<typename T>
+template<typename T, SizeType N>
+class SmallFVector;
+
+//! \a Allocator supplies raw storage through static allocate(n),
+//! reallocate(p, n) and deallocate(p), so it adds nothing to the object.
+template<typename T, typename Allocator = SFAllocator<T>>
 class FVector{
 
     struct detail {
@@ -64,7 +73,8 @@ class FVector{
             friend bool operator <=  (const iterator& lhs, const iterator& rhs){ return (rhs.ptr - lhs.ptr) >= 0; }
             friend bool operator >=  (const iterator& lhs, const iterator& rhs){ return (lhs.ptr - rhs.ptr) >= 0; }
         private:
-            friend class FVector<T>;
+            friend class FVector;
+            template<typename, SizeType> friend class SmallFVector;
             pointer ptr = nullptr;
         };
 
@@ -139,15 +149,18 @@ public:
     FVector& operator = (FVector&& other) noexcept {
         if(this == &other) return *this;
         move_from(std::move(other));
+        return *this;
     }
 
-    FVector& operator = (const FVector& other) noexcept {
+    FVector& operator = (const FVector& other){
         if(this == &other) return *this;
         copy_from(other);
+        return *this;
     }
 
     ~FVector() noexcept {
-        SFAllocator<T>::deallocate(m_data);
+        clear();
+        Allocator::deallocate(m_data);
     }
 
     inline bool FORCE_INLINE empty() const {
@@ -199,6 +212,9 @@ public:
     T& front(){ return m_data[0]; }
     const T& front() const { return m_data[0]; }
 
+    T* data() noexcept { return m_data; }
+    const T* data() const noexcept { return m_data; }
+
     void clear() noexcept {
         for(SizeType i=0; i<m_size; i++)
             call_destructor(m_data[i]);
@@ -209,23 +225,18 @@ public:
         return erase(pos, pos + 1);
     }
 
+    //! Returns an iterator to the element that followed the erased ones
     iterator erase(const_iterator first, const_iterator last){
-        int S = first - cbegin();
-        int L = last - cbegin();
-        int diff = L - S;
-        if(diff <= 0 || int(m_size) - diff <= 0)
-            return end();
+        const SizeType S = static_cast<SizeType>(first - cbegin());
+        const SizeType L = static_cast<SizeType>(last - cbegin());
+        if(S >= L)
+            return iterator(m_data + S);
 
-        for(int i = S; i < L; i++){
+        for(SizeType i = S; i < L; i++)
             call_destructor(m_data[i]);
-        }
-        for(int i = S; unsigned(i + diff) < m_size; i++){
-            new (m_data+i) T(std::move(m_data[i + diff]));
-            call_destructor(m_data[i + diff]);
-        }
-        m_size -= diff;
-        auto kpx = m_data + (L - 1);
-        return iterator(kpx);
+        relocate(m_data + S, m_data + L, m_size - L);
+        m_size -= L - S;
+        return iterator(m_data + S);
     }
 
     template<typename... Args>
@@ -261,43 +272,80 @@ public:
     }
 
 
-    template<typename... Arg>
-    void resize(SizeType sz, Arg&&... arg){
+    void resize(SizeType sz){
         reserve(sz);
         if(sz > m_size)
             for(SizeType i=m_size; i<sz; i++)
-                new(m_data+i) T(std::forward(arg)...);
+                new(m_data+i) T();
         else
             for(SizeType i=sz; i<m_size; i++)
                 call_destructor(m_data[i]);
         m_size = sz;
     }
 
-    void reserve(SizeType sz){
+    void resize(SizeType sz, const T& value){
         if(sz > m_capacity){
-            T* data = static_cast<T*>(SFAllocator<T>::allocate(sz));
-            for(SizeType i=0; i < m_size; i++){
-                new(data+i) T(std::move(m_data[i]));       //! TODO: move if only noexcept;
-                call_destructor(m_data[i]);
-            }
-            SFAllocator<T>::deallocate(m_data);
-            m_capacity = sz;
-            m_data = data;
+            const T copy(value);    // \a value may be an element
+            reserve(sz);
+            std::uninitialized_fill(m_data + m_size, m_data + sz, copy);
         }
+        else if(sz > m_size)
+            std::uninitialized_fill(m_data + m_size, m_data + sz, value);
+        for(SizeType i=sz; i<m_size; i++)
+            call_destructor(m_data[i]);
+        m_size = sz;
+    }
+
+    //! Like resize, but new elements are left uninitialized for the caller
+    //! to fill, from a read() or a SIMD kernel, without zeroing them first
+    void resize_uninitialized(SizeType sz){
+        static_assert(std::is_trivial<T>::value, "only trivial elements may be left uninitialized");
+        reserve(sz);
+        m_size = sz;
+    }
+
+    //! Appends \a count elements from \a first with a single capacity check;
+    //! a memcpy for trivially copyable elements. \a first may point into
+    //! this vector.
+    void append(const T* first, SizeType count){
+        if(m_size + count > m_capacity){
+            const std::ptrdiff_t own = std::less<const T*>()(first, m_data) ||
+                                       !std::less<const T*>()(first, m_data + m_size) ? -1 : first - m_data;
+            grow_for(m_size + count);
+            if(own >= 0)
+                first = m_data + own;
+        }
+        construct_at_end(first, count, std::is_trivially_copyable<T>{});
+        m_size += count;
+    }
+
+    //! Appends [first, last) with at most one reallocation when the
+    //! iterators can be walked twice
+    template<typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+    void append(InputIt first, InputIt last){
+        append_range(first, last, typename std::iterator_traits<InputIt>::iterator_category{});
+    }
+
+    //! Inserts [first, last) before \a pos and returns an iterator to the
+    //! first inserted element. As with std::vector, the range must not be
+    //! part of this vector.
+    template<typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last){
+        using Forward = std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>;
+        const SizeType idx = static_cast<SizeType>(pos - cbegin());
+        insert_range(idx, first, last, std::integral_constant<bool, std::is_trivially_copyable<T>::value && Forward::value>{});
+        return iterator(m_data + idx);
+    }
+
+    void reserve(SizeType sz){
+        if(sz > m_capacity)
+            reallocate(sz);
     }
 
     // Unlike C++'s STL, this is a binding request
     void shrink_to_fit(){
-        if(m_size < m_capacity){
-            T* data = static_cast<T*>(SFAllocator<T>::allocate(m_size));
-            for(SizeType i=0; i < m_size; i++){
-                new(data+i) T(std::move(m_data[i]));       //! TODO: move if only noexcept;
-                call_destructor(m_data[i]);
-            }
-            SFAllocator<T>::deallocate(m_data);
-            m_capacity = m_size;
-            m_data = data;
-        }
+        if(m_size < m_capacity)
+            reallocate(m_size);
     }
 
     void assign(size_type count, const T& value){
@@ -339,8 +387,9 @@ public:
     inline void FORCE_INLINE copy_from(const FVector& other){
         clear();
         reserve(other.m_size);
-        for(SizeType i=0; i < m_capacity; i++)
-            new(m_data+i) T(*(other.m_data[i]));
+        for(SizeType i=0; i < other.m_size; i++)
+            new(m_data+i) T(other.m_data[i]);
+        m_size = other.m_size;
     }
 
 private:
@@ -358,11 +407,131 @@ private:
     std::enable_if_t<!std::is_class<U>::value, void>
     FORCE_INLINE call_destructor(U&){}
 
+    //! Moves \a count elements from \a src to \a dest, which may overlap
+    //! if \a dest comes first, and ends their lifetime at \a src
+    inline void FORCE_INLINE relocate(T* dest, T* src, SizeType count){
+        relocate(dest, src, count, IsTriviallyRelocatable<T>{});
+    }
+
+    static void relocate(T* dest, T* src, SizeType count, std::true_type){
+        if(count)
+            std::memmove(static_cast<void*>(dest), static_cast<const void*>(src), sizeof(T) * count);
+    }
+
+    void relocate(T* dest, T* src, SizeType count, std::false_type){
+        for(SizeType i = 0; i < count; i++){
+            new(dest+i) T(std::move(src[i]));       //! TODO: move if only noexcept;
+            call_destructor(src[i]);
+        }
+    }
+
+    //! Moves the elements to a buffer of \a cap; in place when the
+    //! allocator can extend the one they are in
+    inline void FORCE_INLINE reallocate(SizeType cap){
+        reallocate(cap, IsTriviallyRelocatable<T>{});
+    }
+
+    void reallocate(SizeType cap, std::true_type){
+        if(cap == 0){
+            Allocator::deallocate(m_data);
+            m_data = nullptr;
+        }
+        else
+            m_data = static_cast<T*>(Allocator::reallocate(m_data, cap));
+        m_capacity = cap;
+    }
+
+    void reallocate(SizeType cap, std::false_type){
+        T* data = static_cast<T*>(Allocator::allocate(cap));
+        relocate(data, m_data, m_size);
+        Allocator::deallocate(m_data);
+        m_capacity = cap;
+        m_data = data;
+    }
+
     void inline FORCE_INLINE grow_capacity() { reserve((m_capacity+1) * 2); }
+
+    //! Room for \a needed elements, doubling to keep appends amortized
+    void inline FORCE_INLINE grow_for(SizeType needed) { reserve(std::max(needed, (m_capacity+1) * 2)); }
+
+    void construct_at_end(const T* first, SizeType count, std::true_type){
+        if(count)
+            std::memcpy(static_cast<void*>(m_data + m_size), static_cast<const void*>(first), sizeof(T) * count);
+    }
+
+    void construct_at_end(const T* first, SizeType count, std::false_type){
+        for(SizeType i = 0; i < count; i++)
+            new(m_data + m_size + i) T(first[i]);
+    }
+
+    template<typename It>
+    void append_range(It first, It last, std::input_iterator_tag){
+        for(; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    template<typename It>
+    void append_range(It first, It last, std::forward_iterator_tag){
+        const SizeType count = static_cast<SizeType>(std::distance(first, last));
+        if(m_size + count > m_capacity)
+            grow_for(m_size + count);
+        for(SizeType i = 0; i < count; ++i, ++first)
+            new(m_data + m_size + i) T(*first);
+        m_size += count;
+    }
+
+    void append_range(const T* first, const T* last, std::random_access_iterator_tag){
+        append(first, static_cast<SizeType>(last - first));
+    }
+
+    void append_range(T* first, T* last, std::random_access_iterator_tag){
+        append(first, static_cast<SizeType>(last - first));
+    }
+
+    void append_range(const_iterator first, const_iterator last, std::random_access_iterator_tag){
+        append(first.ptr, static_cast<SizeType>(last - first));
+    }
+
+    void append_range(iterator first, iterator last, std::random_access_iterator_tag){
+        append(first.ptr, static_cast<SizeType>(last - first));
+    }
+
+    template<typename It>
+    void append_range(It first, It last, std::random_access_iterator_tag){
+        append_range(first, last, std::forward_iterator_tag{});
+    }
+
+    //! Bytes move up to open a gap, and the range is copied into it
+    template<typename It>
+    void insert_range(SizeType idx, It first, It last, std::true_type){
+        const SizeType count = static_cast<SizeType>(std::distance(first, last));
+        if(m_size + count > m_capacity)
+            grow_for(m_size + count);
+        relocate_up(m_data + idx, m_size - idx, count);
+        std::copy(first, last, m_data + idx);
+        m_size += count;
+    }
+
+    //! Elements are appended and rotated into place, so an exception
+    //! leaves the vector whole
+    template<typename It>
+    void insert_range(SizeType idx, It first, It last, std::false_type){
+        const SizeType old_size = m_size;
+        append(first, last);
+        std::rotate(m_data + idx, m_data + old_size, m_data + m_size);
+    }
+
+    void relocate_up(T* from, SizeType count, SizeType by){
+        if(count)
+            std::memmove(static_cast<void*>(from + by), static_cast<const void*>(from), sizeof(T) * count);
+    }
 };
 
-template<typename T>
-typename FVector<T>::reserve_tag_t FVector<T>::reserve_tag = typename FVector<T>::reserve_tag_t{};
+template<typename T, typename Allocator>
+struct IsTriviallyRelocatable<FVector<T, Allocator>> : std::true_type {};
+
+template<typename T, typename Allocator>
+typename FVector<T, Allocator>::reserve_tag_t FVector<T, Allocator>::reserve_tag = typename FVector<T, Allocator>::reserve_tag_t{};
 
 
 #endif // FVECTOR_H
@@ -63,17 +63,78 @@ inline SizeType FORCE_INLINE hash_it(const T& t){
 }
 
 //Courtesy of http://programmers.stackexchange.com/a/49566/220592
+//! djb2 over all t.size() characters, see hash_chars
 template<>
 inline SizeType FORCE_INLINE hash_it<FString>(const FString& t){
-        unsigned long hash = 5381;
-        int c;
-        const unsigned char *str = reinterpret_cast<const unsigned char*>(t.c_str());
-        while ((c = *str++))
-            hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-        return hash;
+        return hash_chars(t.c_str(), t.size());
 }
 
-template<typename Key, typename Value>
+//! Same function as for FString, so a view and the string it refers to hash alike
+template<>
+inline SizeType FORCE_INLINE hash_it<FStringView>(const FStringView& t){
+        return hash_chars(t.data(), t.size());
+}
+
+//! Computed by the compiler, same value as the FString it spells
+template<>
+inline SizeType FORCE_INLINE hash_it<FStringLiteral>(const FStringLiteral& t){
+        return t.hash();
+}
+
+//! The default HashMap hasher, forwards to hash_it
+template<typename T>
+struct HashIt{
+    inline SizeType FORCE_INLINE operator () (const T& t) const {
+        return hash_it(t);
+    }
+};
+
+//! Transparent hasher for maps keyed by FString or FStringView: views and
+//! plain literals are hashed in place, FS() literals not at all
+struct StringHash{
+    using is_transparent = void;
+    inline SizeType FORCE_INLINE operator () (FStringView t) const {
+        return hash_it(t);
+    }
+    constexpr SizeType operator () (FStringLiteral t) const {
+        return t.hash();
+    }
+};
+
+template<>
+struct HashIt<FString> : StringHash {};
+
+template<>
+struct HashIt<FStringView> : StringHash {};
+
+namespace hashmap_detail {
+
+template<typename...>
+using Void = void;
+
+//! Heterogeneous lookup by K needs a transparent Hash that takes a K and a
+//! KeyEqual that compares it with a Key, else find() converts to Key
+template<typename K, typename Key, typename Hash, typename KeyEqual, typename = void>
+struct IsTransparentLookup : std::false_type {};
+
+template<typename K, typename Key, typename Hash, typename KeyEqual>
+struct IsTransparentLookup<K, Key, Hash, KeyEqual, Void<
+        typename Hash::is_transparent,
+        decltype(std::declval<const Hash&>()(std::declval<const K&>())),
+        decltype(std::declval<const KeyEqual&>()(std::declval<const Key&>(), std::declval<const K&>()))>>
+    : std::true_type {};
+
+} // namespace hashmap_detail
+
+//! \a Hash and \a KeyEqual may be stateful; they are copied along with
+//! the map. A Hash with a member type is_transparent lets find() and
+//! count() take any key type the two function objects accept, so a
+//! map keyed by FString can be searched with an FStringView, or with
+//! an FS() literal whose hash was computed at compile time.
+//! \a Allocator is a stateless policy like SFAllocator; it is rebound to
+//! allocate the nodes and the bucket array.
+template<typename Key, typename Value, typename Hash = HashIt<Key>, typename KeyEqual = std::equal_to<>,
+         typename Allocator = SFAllocator<std::pair<const Key, Value>>>
 class HashMap
 {
 
@@ -83,6 +144,28 @@ class HashMap
         HashNode* next;
     };
 
+    using NodeAllocator = typename Allocator::template rebind<HashNode>;
+    using BucketAllocator = typename Allocator::template rebind<HashNode*>;
+
+    template<typename K, typename V>
+    static HashNode* make_node(K&& ky, V&& val){
+        void* addr = NodeAllocator::allocate(1);
+        try{
+            return new (addr) HashNode{ {std::forward<K>(ky), std::forward<V>(val)}, nullptr };
+        }
+        catch(...){
+            NodeAllocator::deallocate(addr);
+            throw;
+        }
+    }
+
+    static void free_node(HashNode* node) noexcept {
+        if(node){
+            node->~HashNode();
+            NodeAllocator::deallocate(node);
+        }
+    }
+
 
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -156,7 +239,7 @@ class HashMap
         }
 
     private:
-        friend class HashMap<Key, Value>;
+        friend class HashMap;
         HMap hashMap = nullptr;
         Node currentNode = nullptr;
         SizeType idx = 0;
@@ -199,8 +282,8 @@ public:
         using value_type = std::pair<const Key&, Value>;
         using size_type = SizeType;
         using difference_type = std::ptrdiff_t;
-        using hasher = void;
-        using key_equal = void;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
         using pointer = value_type*;
         using reference = value_type&;
         using const_pointer = const value_type*;
@@ -210,15 +293,15 @@ public:
             node_type() : m_data(nullptr) {}
             node_type(node_type&& other) : m_data(other.m_data) { other.m_data = nullptr; }
             node_type& operator = (node_type&& other) {
-                delete m_data;
+                free_node(m_data);
                 m_data = other.m_data;
                 other.m_data = nullptr;
                 return *this;
             }
             bool is_empty() const { return m_data == nullptr; }
-            ~node_type() { delete m_data; }
+            ~node_type() { free_node(m_data); }
         private:
-            friend class HashMap<Key, Value>;
+            friend class HashMap;
   
 			node_type(HashNode* ptr) : m_data(ptr) {}
             HashNode* data() { return m_data; }
@@ -234,27 +317,35 @@ public:
 		using insert_return_type = InsertReturnType<iterator, node_type>;
 
         HashMap() {  /*******/  }
+        explicit HashMap(const Hash& hash, const KeyEqual& equal = KeyEqual())
+            : m_hasher(hash), m_equal(equal) {}
         ~HashMap(){  destroy(); }
 
-        HashMap(HashMap&& other) noexcept {
+        HashMap(HashMap&& other) noexcept
+            : m_hasher(std::move(other.m_hasher)), m_equal(std::move(other.m_equal)) {
             move_from(std::move(other));
         }
 
-        HashMap(const HashMap& other) {
+        HashMap(const HashMap& other) : m_hasher(other.m_hasher), m_equal(other.m_equal) {
             copy_from(other);
         }
 
         HashMap& operator=(HashMap&& other) noexcept{
             if(this == &other) return *this;
             destroy();
+            m_hasher = std::move(other.m_hasher);
+            m_equal = std::move(other.m_equal);
             move_from(std::move(other));
             return *this;
         }
 
         HashMap& operator=(const HashMap& other){
             if(this == &other) return *this;
-            destroy();
+            clear();
+            m_hasher = other.m_hasher;
+            m_equal = other.m_equal;
             copy_from(other);
+            return *this;
         }
 
         inline bool FORCE_INLINE empty() const {
@@ -303,14 +394,29 @@ public:
             return const_cast<HashMap*>(this)->getNode(ky);
         }
 
+        template<typename K, typename = std::enable_if_t<hashmap_detail::IsTransparentLookup<K, Key, Hash, KeyEqual>::value>>
+        iterator find(const K& ky) {
+            return getNode(ky);
+        }
+
+        template<typename K, typename = std::enable_if_t<hashmap_detail::IsTransparentLookup<K, Key, Hash, KeyEqual>::value>>
+        const_iterator find(const K& ky) const {
+            return const_cast<HashMap*>(this)->getNode(ky);
+        }
+
         size_type count(const Key& ky) const {
             return find(ky) != cend() ? 1 : 0;
         }
 
+        template<typename K, typename = std::enable_if_t<hashmap_detail::IsTransparentLookup<K, Key, Hash, KeyEqual>::value>>
+        size_type count(const K& ky) const {
+            return find(ky) != cend() ? 1 : 0;
+        }
+
         iterator erase(const_iterator iter){
             if(iter == cend())
                 return end();
-            delete disconnect_node((iter++)->first);
+            free_node(disconnect_node((iter++)->first));
             return iter.toNonConstIterator(iter);
         }
 
@@ -327,7 +433,7 @@ public:
         SizeType erase(const Key& ky){
             auto node = disconnect_node(ky);
             if(node){
-                delete node;
+                free_node(node);
                 return 1;
             }
             return 0;
@@ -342,32 +448,38 @@ public:
 
         inline void reserve(SizeType sz){
             if(sz > m_bucketSize){
-                void* addr = SFAllocator<HashNode**>::allocate(sz);
+                void* addr = BucketAllocator::allocate(sz);
                 HashNode** data = static_cast<HashNode**>(addr);
 
                 for(SizeType i = 0; i < sz; i++)
                     data[i] = nullptr;
-                SizeType counter = 0;
+                //relink the existing nodes, no key or value is copied or moved
                 for(SizeType i = 0; i < m_bucketSize; i++){
-                    if(m_buckets[i]){
-                        imbue_data(m_buckets[i]->data.first, std::move(m_buckets[i]->data.second), data, sz, counter);
-                        for(auto link = m_buckets[i]->next; link; link = link->next)
-                            imbue_data(m_buckets[i]->data.first, std::move(m_buckets[i]->data.second), data, counter);
-                        delete m_buckets[i];
+                    for(HashNode* node = m_buckets[i]; node;){
+                        HashNode* next = node->next;
+                        HashNode*& slot = data[hash(node->data.first, sz)];
+                        node->next = slot;
+                        slot = node;
+                        node = next;
                     }
                 }
-                SFAllocator<HashNode*>::deallocate(m_buckets);
-                m_nodeSize = counter;
+                BucketAllocator::deallocate(m_buckets);
                 m_bucketSize = sz;
                 m_buckets = data;
             }
         }
 
-        inline SizeType FORCE_INLINE hash(const Key& ky, SizeType sz) const {
-            return hash_it(ky) % sz;
+        template<typename K>
+        inline SizeType FORCE_INLINE hash(const K& ky, SizeType sz) const {
+            return m_hasher(ky) % sz;
         }
 
+        hasher hash_function() const { return m_hasher; }
+        key_equal key_eq() const { return m_equal; }
+
         void swap(HashMap& other){
+            std::swap(m_hasher, other.m_hasher);
+            std::swap(m_equal, other.m_equal);
             std::swap(m_buckets, other.m_buckets);
             std::swap(m_bucketSize, other.m_bucketSize);
             std::swap(m_nodeSize, other.m_nodeSize);
@@ -382,6 +494,8 @@ public:
         HashNode** m_buckets = nullptr;
         SizeType m_bucketSize = 0;
         SizeType m_nodeSize = 0;
+        Hash m_hasher;
+        KeyEqual m_equal;
 
         inline void FORCE_INLINE move_from(HashMap&& other){
             m_buckets = other.m_buckets;
@@ -408,14 +522,14 @@ public:
             auto index = hash(key, m_bucketSize);
             auto& node = m_buckets[index];
             HashNode* rtn = nullptr;
-            if(node && node->data.first == key){
+            if(node && m_equal(node->data.first, key)){
                 rtn = node;
                 node = node->next;
 				m_nodeSize--;
             }
             else if(node){
                 for(auto n = node; n->next; n = n->next){
-                    if(n->next->data.first == key){
+                    if(m_equal(n->next->data.first, key)){
                         rtn = n->next;
                         n->next = n->next->next;
 						m_nodeSize--;
@@ -435,14 +549,14 @@ public:
                     for(auto node = m_buckets[i]->next; node != nullptr;){
                         auto currentNode = node;
                         node = node->next;
-                        delete currentNode;
+                        free_node(currentNode);
                         --m_nodeSize;
                     }
-                    delete m_buckets[i];
+                    free_node(m_buckets[i]);
                     --m_nodeSize;
                 }
             }
-            SFAllocator<HashNode**>::deallocate(m_buckets);
+            BucketAllocator::deallocate(m_buckets);
         }
 
         inline std::pair<iterator, bool> imbue_data(const Key& ky, Value&& val, HashNode** mem, SizeType memSize){
@@ -455,19 +569,18 @@ public:
             HashNode*& node = mem[index];
             if(node){
                 HashNode* link = node;
-                if(node->data.first == ky){
-                    return {{this, node, index}, false };
-                }
-                else{
-                    for(link = node; link->next; link = link->next)
-                        if(link->data.first == ky)
-                            return {{this, link, index}, false};
+                while(true){
+                    if(m_equal(link->data.first, ky))
+                        return {{this, link, index}, false};
+                    if(!link->next)
+                        break;
+                    link = link->next;
                 }
-                link->next = new HashNode{ {ky, std::move(val)}, nullptr };
+                link->next = make_node(ky, std::move(val));
                 ++counter;
                 return {{this, link->next, index}, true};
             }
-            node = new HashNode{ {ky, std::move(val)}, nullptr };
+            node = make_node(ky, std::move(val));
             ++counter;
             return {{this, node, index}, true};
         }
@@ -481,7 +594,7 @@ public:
 
                 //check that node does not already exist
 				while(true){
-					if(n->data.first == handle.data()->data.first)
+					if(m_equal(n->data.first, handle.data()->data.first))
 						return { {this, n, index}, false, std::move(handle)};
 					if(!n->next)
 						break;
@@ -501,19 +614,20 @@ public:
             return {{this, node, index}, true, {}};
 		}
 
-        inline iterator FORCE_INLINE getNode(const Key& ky) {
+        template<typename K>
+        inline iterator FORCE_INLINE getNode(const K& ky) {
             if(m_bucketSize == 0)
                 return end();
             SizeType idx = hash(ky, m_bucketSize);
             HashNode* node = m_buckets[idx];
             if(node){
                 HashNode* link = node;
-                if(node->data.first == ky){
+                if(m_equal(node->data.first, ky)){
                     return iterator(this, node, idx);
                 }
                 else{
                     for(link = node->next; link; link = link->next)
-                        if(link->data.first == ky)
+                        if(m_equal(link->data.first, ky))
                             return iterator(this, link, idx);
                 }
             }
@@ -522,4 +636,9 @@ public:
 
 };
 
+//! The buckets and nodes are on the heap, so only the function objects matter
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+struct IsTriviallyRelocatable<HashMap<Key, Value, Hash, KeyEqual, Allocator>>
+    : std::integral_constant<bool, IsTriviallyRelocatable<Hash>::value && IsTriviallyRelocatable<KeyEqual>::value> {};
+
 #endif // HASHMAP_H
@@ -15,6 +15,8 @@
 
 #include <new>
 #include <deque>
+#include <cstddef>
+#include <cstdlib>
 #include <vector>
 #include <cstring>
 #include <cassert>
@@ -24,6 +26,11 @@
 #include <type_traits>
 #include <forward_list>
 
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // __linux__
+
 /*!
  *
  * \note BlockSize must be multiples of 8
@@ -322,6 +329,112 @@ private:
 };
 
 
+/*!
+ * An allocator policy for FVector<T, MappedAllocator<T>> holding very
+ * large buffers of relocatable elements: token streams, offset tables.
+ * Buffers of at least \a Threshold bytes are mapped straight from the
+ * kernel and grow with mremap, which moves page table entries instead of
+ * copying bytes, so growing never needs the old and the new buffer at
+ * once. Smaller buffers come from malloc as with SFAllocator.
+ *
+ * \note A small header precedes every buffer with its length and whether
+ * it is mapped. Elsewhere than on Linux, everything comes from malloc.
+ */
+template<typename T, std::size_t Threshold = (std::size_t(1) << 20)>
+class MappedAllocator {
+    struct Header{
+        std::size_t length;     //!< bytes of the block, header included
+        bool mapped;
+    };
+
+    static constexpr std::size_t kHeader = (sizeof(Header) + alignof(std::max_align_t) - 1)
+                                           / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    static Header& header(void* m){
+        return *reinterpret_cast<Header*>(static_cast<char*>(m) - kHeader);
+    }
+
+    static void* start(void* block, std::size_t length, bool mapped){
+        new (block) Header{ length, mapped };
+        return static_cast<char*>(block) + kHeader;
+    }
+
+    static void* from_malloc(void* block, std::size_t bytes){
+        if(!block)
+            throw std::bad_alloc();
+        return start(block, bytes, false);
+    }
+
+#ifdef __linux__
+    static std::size_t page_rounded(std::size_t bytes){
+        static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return (bytes + page - 1) / page * page;
+    }
+
+    static void* from_mapping(void* block, std::size_t length){
+        if(block == MAP_FAILED)
+            throw std::bad_alloc();
+        return start(block, length, true);
+    }
+#endif // __linux__
+
+public:
+    template<typename U>
+    using rebind = MappedAllocator<U, Threshold>;
+
+    //! Buffers of at least this many bytes are mapped
+    static constexpr std::size_t kThreshold = Threshold;
+
+    static void* allocate(SizeType sz){
+        const std::size_t bytes = kHeader + std::size_t(sz) * sizeof(T);
+#ifdef __linux__
+        if(bytes >= Threshold){
+            const std::size_t length = page_rounded(bytes);
+            return from_mapping(mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0), length);
+        }
+#endif // __linux__
+        return from_malloc(std::malloc(bytes), bytes);
+    }
+
+    //! Keeps the contents up to the smaller of the two sizes, as realloc does
+    static void* reallocate(void* m, SizeType sz){
+        if(!m)
+            return allocate(sz);
+        const std::size_t bytes = kHeader + std::size_t(sz) * sizeof(T);
+        const Header old = header(m);
+        char* const block = static_cast<char*>(m) - kHeader;
+#ifdef __linux__
+        if(old.mapped && bytes >= Threshold){
+            const std::size_t length = page_rounded(bytes);
+            return from_mapping(mremap(block, old.length, length, MREMAP_MAYMOVE), length);
+        }
+        if(old.mapped || bytes >= Threshold){
+            // Crossing the threshold: one copy into the other kind of buffer
+            void* const data = allocate(sz);
+            std::memcpy(data, m, std::min(bytes, old.length) - kHeader);
+            deallocate(m);
+            return data;
+        }
+#endif // __linux__
+        return from_malloc(std::realloc(block, bytes), bytes);
+    }
+
+    static void deallocate(void* m){
+        if(!m)
+            return;
+        char* const block = static_cast<char*>(m) - kHeader;
+#ifdef __linux__
+        if(header(m).mapped){
+            munmap(block, header(m).length);
+            return;
+        }
+#endif // __linux__
+        std::free(block);
+    }
+};
+
+template<typename T, std::size_t Threshold>
+constexpr std::size_t MappedAllocator<T, Threshold>::kThreshold;
 
 #endif // MEMORYALLOCATOR_HPP
 
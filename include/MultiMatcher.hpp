@@ -0,0 +1,384 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef MULTIMATCHER_HPP
+#define MULTIMATCHER_HPP
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+#include "Config.hpp"
+#include "Simd.hpp"
+#include "String.hpp"
+#include "FVector.hpp"
+
+//! One occurrence of a pattern: its index in the pattern list and the
+//! offset in the text where it starts
+struct PatternMatch{
+    SizeType pattern;
+    SizeType position;
+};
+
+inline bool operator == (PatternMatch x, PatternMatch y){
+    return x.pattern == y.pattern && x.position == y.position;
+}
+
+inline bool operator < (PatternMatch x, PatternMatch y){
+    return x.position < y.position || (x.position == y.position && x.pattern < y.pattern);
+}
+
+//! How a MultiMatcher searches. Automatic picks Teddy for small pattern
+//! sets on CPUs with SSSE3 and the Aho-Corasick automaton otherwise.
+enum class MatchEngine { Automatic, Teddy, AhoCorasick };
+
+namespace multi_match_detail {
+
+constexpr SizeType kNone = std::numeric_limits<SizeType>::max();
+constexpr SizeType kBuckets = 8;
+constexpr SizeType kMaxFingerprint = 3;
+
+//! Bit b of low[j][x] is set if a pattern in bucket b has a byte j whose
+//! low nibble is x; high[j] does the same for the high nibble.
+struct TeddyMasks{
+    uint8_t low[kMaxFingerprint][16];
+    uint8_t high[kMaxFingerprint][16];
+};
+
+//! The buckets that may hold a pattern starting at \a p
+inline unsigned FORCE_INLINE teddy_candidates(const TeddyMasks& masks, const unsigned char* p, SizeType width){
+    unsigned buckets = 0xFF;
+    for(SizeType j = 0; j < width; j++)
+        buckets &= masks.low[j][p[j] & 0x0F] & masks.high[j][p[j] >> 4];
+    return buckets;
+}
+
+#ifdef SIMD_SSSE3
+//! Teddy, from Hyperscan: the first Width bytes of each of 16 start positions
+//! are looked up in the nibble masks with pshufb, and the results ANDed,
+//! leaving per position the buckets worth verifying. Calls
+//! verify(position, buckets) for those, returns the first position not examined.
+template<SizeType Width, typename Verify>
+TARGET_SSSE3 inline SizeType teddy_ssse3(const TeddyMasks& masks, const unsigned char* text, SizeType n, Verify& verify){
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i low[Width], high[Width];
+    for(SizeType j = 0; j < Width; j++){
+        low[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.low[j]));
+        high[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.high[j]));
+    }
+    SizeType i = 0;
+    for(; i + 15 + Width <= n; i += 16){
+        __m128i candidates = _mm_set1_epi8(-1);
+        for(SizeType j = 0; j < Width; j++){
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + j));
+            const __m128i lo = _mm_shuffle_epi8(low[j], _mm_and_si128(block, nibble));
+            const __m128i hi = _mm_shuffle_epi8(high[j], _mm_and_si128(_mm_srli_epi16(block, 4), nibble));
+            candidates = _mm_and_si128(candidates, _mm_and_si128(lo, hi));
+        }
+        unsigned lanes = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(candidates, _mm_setzero_si128()))) & 0xFFFF;
+        if(lanes){
+            uint8_t buckets[16];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(buckets), candidates);
+            for(; lanes; lanes &= lanes - 1){
+                const unsigned lane = simd::lowest_bit(lanes);
+                verify(i + lane, buckets[lane]);
+            }
+        }
+    }
+    return i;
+}
+#endif // SIMD_SSSE3
+
+} // namespace multi_match_detail
+
+
+//! Finds every occurrence of any of a list of fixed patterns in one pass
+//! over the text, however many patterns there are:
+//!     MultiMatcher keywords{"ERROR", "WARN", "timeout"};
+//!     keywords.for_each_match(line, [](PatternMatch m){ ... });
+//! Up to kTeddyMaxPatterns patterns are searched with Teddy: a SIMD filter
+//! on the first bytes of the patterns, sorted into 8 buckets, followed by a
+//! memcmp against the patterns of the candidate buckets. Larger sets use an
+//! Aho-Corasick automaton whose transitions are a dense table over byte
+//! classes (the bytes that occur in no pattern share one class), so a step
+//! is one load. Overlapping matches are all reported; empty patterns never match.
+class MultiMatcher
+{
+    public:
+        static constexpr SizeType kTeddyMaxPatterns = 32;
+
+        MultiMatcher() : MultiMatcher(std::initializer_list<FStringView>{}) {}
+
+        MultiMatcher(std::initializer_list<FStringView> patterns, MatchEngine engine = MatchEngine::Automatic)
+            : MultiMatcher(patterns.begin(), patterns.end(), engine) {}
+
+        //! Compiles the patterns in [first, last), anything an FStringView can be made from
+        template<typename Iter>
+        MultiMatcher(Iter first, Iter last, MatchEngine engine = MatchEngine::Automatic){
+            m_offsets.push_back(0);
+            for(; first != last; ++first){
+                m_bytes.append(FStringView(*first));
+                m_offsets.push_back(m_bytes.size());
+            }
+            build(engine);
+        }
+
+        //! Number of patterns, empty ones included
+        SizeType size() const { return m_offsets.size() - 1; }
+
+        FStringView pattern(SizeType id) const {
+            return FStringView(m_bytes.data() + m_offsets[id], pattern_size(id));
+        }
+
+        //! Teddy or AhoCorasick, never Automatic
+        MatchEngine engine() const { return m_engine; }
+
+        //! Calls callback(PatternMatch) for every occurrence of every pattern.
+        //! The matches of each pattern come in increasing position; the order
+        //! between different patterns depends on the engine.
+        template<typename Callback>
+        void for_each_match(FStringView text, Callback&& callback) const {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+            if(m_engine == MatchEngine::Teddy)
+                scan_teddy(p, text.size(), callback);
+            else
+                scan_automaton(p, text.size(), callback);
+        }
+
+        //! All the matches, ordered by position and then by pattern
+        FVector<PatternMatch> find_all(FStringView text) const {
+            FVector<PatternMatch> matches;
+            for_each_match(text, [&](PatternMatch m){ matches.push_back(m); });
+            std::sort(matches.begin(), matches.end());
+            return matches;
+        }
+
+    private:
+        using Masks = multi_match_detail::TeddyMasks;
+
+        //! The patterns back to back, pattern i is [m_offsets[i], m_offsets[i+1])
+        FString m_bytes;
+        FVector<SizeType> m_offsets;
+        MatchEngine m_engine = MatchEngine::AhoCorasick;
+
+        // Teddy: the patterns of bucket b are m_bucket_patterns[m_bucket_start[b] .. m_bucket_start[b+1])
+        Masks m_masks = {};
+        SizeType m_width = 0;
+        FVector<SizeType> m_bucket_start;
+        FVector<SizeType> m_bucket_patterns;
+
+        // Aho-Corasick: the row of state s starts at s * m_class_count, and
+        // m_next[row + m_classes[byte]] holds the row of the next state times
+        // two, plus one if that state reports matches, so a step needs no
+        // multiplication and no second lookup when nothing matches.
+        // m_report[s] is the first state on the suffix chain of s that ends
+        // patterns, m_output_link continues that chain; the patterns ending
+        // at state r are m_outputs[m_output_start[r] .. m_output_start[r+1]).
+        uint16_t m_classes[256] = {};
+        SizeType m_class_count = 1;
+        FVector<SizeType> m_next;
+        FVector<SizeType> m_report;
+        FVector<SizeType> m_output_link;
+        FVector<SizeType> m_output_start;
+        FVector<SizeType> m_outputs;
+        //! Bytes that start a pattern, the root skips ahead to them
+        simd::CharSet m_first_bytes;
+
+        SizeType pattern_size(SizeType id) const { return m_offsets[id + 1] - m_offsets[id]; }
+        const char* pattern_data(SizeType id) const { return m_bytes.data() + m_offsets[id]; }
+
+        void build(MatchEngine engine){
+            SizeType live = 0, shortest = multi_match_detail::kNone;
+            for(SizeType id = 0; id < size(); id++)
+                if(pattern_size(id)){
+                    live++;
+                    shortest = std::min(shortest, pattern_size(id));
+                }
+            const bool teddy_fits = live > 0 && live <= kTeddyMaxPatterns;
+            bool teddy = engine == MatchEngine::Teddy && teddy_fits;
+#ifdef SIMD_SSSE3
+            if(engine == MatchEngine::Automatic)
+                teddy = teddy_fits && simd::cpu_has_ssse3();
+#endif
+            if(teddy)
+                build_teddy(std::min(shortest, multi_match_detail::kMaxFingerprint));
+            else
+                build_automaton();
+        }
+
+        //! Patterns sorted by their first bytes fill the buckets in turn, so
+        //! similar patterns share a bucket and the masks stay selective
+        void build_teddy(SizeType width){
+            using multi_match_detail::kBuckets;
+            m_engine = MatchEngine::Teddy;
+            m_width = width;
+
+            std::vector<SizeType> ids;
+            for(SizeType id = 0; id < size(); id++)
+                if(pattern_size(id))
+                    ids.push_back(id);
+            std::sort(ids.begin(), ids.end(), [&](SizeType x, SizeType y){
+                return std::memcmp(pattern_data(x), pattern_data(y), width) < 0;
+            });
+
+            const SizeType n = static_cast<SizeType>(ids.size());
+            m_bucket_start = FVector<SizeType>(kBuckets + 1);
+            for(SizeType b = 0; b <= kBuckets; b++)
+                m_bucket_start[b] = (b * n + kBuckets - 1) / kBuckets;
+            for(SizeType rank = 0; rank < n; rank++){
+                const SizeType bucket = rank * kBuckets / n;
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(pattern_data(ids[rank]));
+                for(SizeType j = 0; j < width; j++){
+                    m_masks.low[j][p[j] & 0x0F] |= static_cast<uint8_t>(1u << bucket);
+                    m_masks.high[j][p[j] >> 4] |= static_cast<uint8_t>(1u << bucket);
+                }
+                m_bucket_patterns.push_back(ids[rank]);
+            }
+        }
+
+        void build_automaton(){
+            using multi_match_detail::kNone;
+            m_engine = MatchEngine::AhoCorasick;
+
+            for(SizeType i = 0; i < m_bytes.size(); i++){
+                const unsigned char ch = static_cast<unsigned char>(m_bytes[i]);
+                if(m_classes[ch] == 0)
+                    m_classes[ch] = static_cast<uint16_t>(m_class_count++);
+            }
+            const SizeType classes = m_class_count;
+
+            // The trie, missing edges are kNone for now
+            m_next = FVector<SizeType>(classes, kNone);
+            std::vector<std::vector<SizeType>> ends(1);
+            for(SizeType id = 0; id < size(); id++){
+                if(pattern_size(id) == 0)
+                    continue;
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(pattern_data(id));
+                m_first_bytes.add(p[0]);
+                SizeType state = 0;
+                for(SizeType j = 0; j < pattern_size(id); j++){
+                    SizeType& edge = m_next[state * classes + m_classes[p[j]]];
+                    if(edge == kNone){
+                        edge = static_cast<SizeType>(ends.size());
+                        ends.emplace_back();
+                        for(SizeType c = 0; c < classes; c++)
+                            m_next.push_back(kNone);
+                    }
+                    state = m_next[state * classes + m_classes[p[j]]];
+                }
+                ends[state].push_back(id);
+            }
+            const SizeType states = static_cast<SizeType>(ends.size());
+
+            // Breadth first, every missing edge becomes the edge of the
+            // longest proper suffix, so the scan never follows failure links
+            FVector<SizeType> fail(states, 0);
+            m_output_link = FVector<SizeType>(states, kNone);
+            std::vector<SizeType> queue;
+            for(SizeType c = 0; c < classes; c++){
+                SizeType& edge = m_next[c];
+                if(edge == kNone)
+                    edge = 0;
+                else
+                    queue.push_back(edge);
+            }
+            for(std::size_t head = 0; head < queue.size(); head++){
+                const SizeType state = queue[head];
+                const SizeType suffix = fail[state];
+                m_output_link[state] = !ends[suffix].empty() ? suffix : m_output_link[suffix];
+                for(SizeType c = 0; c < classes; c++){
+                    SizeType& edge = m_next[state * classes + c];
+                    const SizeType fallback = m_next[suffix * classes + c];
+                    if(edge == kNone)
+                        edge = fallback;
+                    else{
+                        fail[edge] = fallback;
+                        queue.push_back(edge);
+                    }
+                }
+            }
+
+            m_report = FVector<SizeType>(states, kNone);
+            m_output_start = FVector<SizeType>(states + 1, 0);
+            for(SizeType state = 0; state < states; state++){
+                m_report[state] = !ends[state].empty() ? state : m_output_link[state];
+                m_output_start[state] = m_outputs.size();
+                for(SizeType id : ends[state])
+                    m_outputs.push_back(id);
+            }
+            m_output_start[states] = m_outputs.size();
+
+            for(SizeType k = 0; k < m_next.size(); k++){
+                const SizeType target = m_next[k];
+                m_next[k] = (target * classes) << 1 | (m_report[target] != kNone);
+            }
+        }
+
+        template<typename Callback>
+        void scan_teddy(const unsigned char* text, SizeType n, Callback& callback) const {
+            auto verify = [&](SizeType position, unsigned buckets){
+                for(; buckets; buckets &= buckets - 1){
+                    const unsigned b = simd::lowest_bit(buckets);
+                    for(SizeType k = m_bucket_start[b]; k < m_bucket_start[b + 1]; k++){
+                        const SizeType id = m_bucket_patterns[k];
+                        const SizeType len = pattern_size(id);
+                        if(len <= n - position && std::memcmp(text + position, pattern_data(id), len) == 0)
+                            callback(PatternMatch{id, position});
+                    }
+                }
+            };
+            SizeType i = 0;
+#ifdef SIMD_SSSE3
+            if(simd::cpu_has_ssse3()){
+                if(m_width == 1)
+                    i = multi_match_detail::teddy_ssse3<1>(m_masks, text, n, verify);
+                else if(m_width == 2)
+                    i = multi_match_detail::teddy_ssse3<2>(m_masks, text, n, verify);
+                else
+                    i = multi_match_detail::teddy_ssse3<3>(m_masks, text, n, verify);
+            }
+#endif
+            for(; i + m_width <= n; i++){
+                const unsigned buckets = multi_match_detail::teddy_candidates(m_masks, text + i, m_width);
+                if(buckets)
+                    verify(i, buckets);
+            }
+        }
+
+        template<typename Callback>
+        void scan_automaton(const unsigned char* text, SizeType n, Callback& callback) const {
+            using multi_match_detail::kNone;
+            const SizeType* next = &m_next[0];
+            SizeType row = 0;
+            for(SizeType i = 0; i < n; i++){
+                if(row == 0 && !m_first_bytes.contains(text[i])){
+                    const char* found = simd::find_any(reinterpret_cast<const char*>(text + i), reinterpret_cast<const char*>(text + n), m_first_bytes);
+                    if(!found)
+                        return;
+                    i = static_cast<SizeType>(reinterpret_cast<const unsigned char*>(found) - text);
+                }
+                const SizeType edge = next[row + m_classes[text[i]]];
+                row = edge >> 1;
+                if(!(edge & 1))
+                    continue;
+                for(SizeType r = m_report[row / m_class_count]; r != kNone; r = m_output_link[r])
+                    for(SizeType k = m_output_start[r]; k < m_output_start[r + 1]; k++){
+                        const SizeType id = m_outputs[k];
+                        callback(PatternMatch{id, i + 1 - pattern_size(id)});
+                    }
+            }
+        }
+};
+
+#endif // MULTIMATCHER_HPP
@@ -0,0 +1,274 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef NUMBERFORMAT_HPP
+#define NUMBERFORMAT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "Config.hpp"
+#include "PowersOfFive.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//! Room format_number needs at most, for any integer or double
+constexpr int kMaxNumberChars = 24;
+
+namespace charconv_detail {
+
+struct UInt128{
+    uint64_t high;
+    uint64_t low;
+};
+
+inline UInt128 FORCE_INLINE full_multiplication(uint64_t a, uint64_t b){
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return { static_cast<uint64_t>(r >> 64), static_cast<uint64_t>(r) };
+#elif defined(_MSC_VER) && defined(_M_X64)
+    UInt128 r;
+    r.low = _umul128(a, b, &r.high);
+    return r;
+#else
+    const uint64_t a_lo = static_cast<uint32_t>(a), a_hi = a >> 32;
+    const uint64_t b_lo = static_cast<uint32_t>(b), b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+    const uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + static_cast<uint32_t>(hi_lo) + lo_hi;
+    return { (hi_lo >> 32) + (cross >> 32) + hi_hi, (cross << 32) | static_cast<uint32_t>(lo_lo) };
+#endif
+}
+
+//! "00" "01" ... "99", so integers are emitted two digits per division
+inline const char* FORCE_INLINE digit_pairs(){
+    return "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+           "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+           "8081828384858687888990919293949596979899";
+}
+
+inline int FORCE_INLINE count_digits(uint64_t v){
+    int n = 1;
+    for(;;){
+        if(v < 10) return n;
+        if(v < 100) return n + 1;
+        if(v < 1000) return n + 2;
+        if(v < 10000) return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
+
+//! Writes the digits of \a v backwards, ending just before \a end
+inline void write_digits(char* end, uint64_t v){
+    const char* pairs = digit_pairs();
+    while(v >= 100){
+        const std::size_t i = static_cast<std::size_t>(v % 100) * 2;
+        v /= 100;
+        *--end = pairs[i + 1];
+        *--end = pairs[i];
+    }
+    if(v >= 10){
+        *--end = pairs[v * 2 + 1];
+        *--end = pairs[v * 2];
+    }
+    else
+        *--end = static_cast<char>('0' + v);
+}
+
+//! A double as digits * 10^exponent
+struct Decimal{
+    uint64_t digits;
+    int exponent;
+};
+
+inline int FORCE_INLINE floor_log2_pow10(int e){ return (e * 1741647) >> 19; }
+
+//! 2^127 <= g < 2^128 with g = floor(10^e * 2^-r) + 1 for some r
+inline UInt128 FORCE_INLINE pow10_rounded_up(int e){
+    using Powers = PowersOfFive<>;
+    const std::size_t index = 2 * static_cast<std::size_t>(e - Powers::kSmallest);
+    UInt128 g = { Powers::table[index], Powers::table[index + 1] };
+    // The table already holds floor + 1 for the small negative powers
+    if(e >= 0 || e < -27){
+        g.low++;
+        g.high += g.low == 0;
+    }
+    return g;
+}
+
+//! The top 64 bits of g * cp, with the lowest bit set if anything was dropped
+inline uint64_t FORCE_INLINE round_to_odd(UInt128 g, uint64_t cp){
+    const UInt128 x = full_multiplication(g.low, cp);
+    UInt128 y = full_multiplication(g.high, cp);
+    y.low += x.high;
+    y.high += y.low < x.high;
+    return y.high | (y.low > 1);
+}
+
+//! Schubfach (R. Giulietti, "The Schubfach way to render doubles"): the
+//! shortest decimal that rounds back to the double, the closest one when
+//! there are several. \a bits must encode a finite, positive double.
+inline Decimal to_decimal(uint64_t bits){
+    const uint64_t fraction = bits & ((uint64_t(1) << 52) - 1);
+    const int biased_exponent = static_cast<int>((bits >> 52) & 0x7FF);
+
+    uint64_t c;
+    int q;
+    if(biased_exponent != 0){
+        c = fraction | (uint64_t(1) << 52);
+        q = biased_exponent - 1075;
+        // Small integers need no scaling at all
+        if(q <= 0 && q > -53 && (c & ((uint64_t(1) << -q) - 1)) == 0)
+            return { c >> -q, 0 };
+    }
+    else{
+        c = fraction;
+        q = -1074;
+    }
+
+    const bool accept_bounds = (c % 2) == 0;
+    const bool lower_is_closer = fraction == 0 && biased_exponent > 1;
+
+    // Boundaries of the rounding interval, scaled by 4
+    const uint64_t cbl = 4 * c - 2 + lower_is_closer;
+    const uint64_t cb = 4 * c;
+    const uint64_t cbr = 4 * c + 2;
+
+    // floor(log10(2^q)), or floor(log10(3/4 * 2^q)) for the closer boundary
+    const int k = (q * 1262611 - (lower_is_closer ? 524031 : 0)) >> 22;
+    const int h = q + floor_log2_pow10(-k) + 1;
+
+    const UInt128 g = pow10_rounded_up(-k);
+    const uint64_t vbl = round_to_odd(g, cbl << h);
+    const uint64_t vb = round_to_odd(g, cb << h);
+    const uint64_t vbr = round_to_odd(g, cbr << h);
+
+    const uint64_t lower = vbl + !accept_bounds;
+    const uint64_t upper = vbr - !accept_bounds;
+
+    const uint64_t s = vb / 4;
+    if(s >= 10){
+        // One digit less, if exactly one of its neighbours is in the interval
+        const uint64_t sp = s / 10;
+        const bool up_inside = lower <= 40 * sp;
+        const bool wp_inside = 40 * sp + 40 <= upper;
+        if(up_inside != wp_inside)
+            return { sp + wp_inside, k + 1 };
+    }
+
+    const bool u_inside = lower <= 4 * s;
+    const bool w_inside = 4 * s + 4 <= upper;
+    if(u_inside != w_inside)
+        return { s + w_inside, k };
+
+    const uint64_t mid = 4 * s + 2;
+    const bool round_up = vb > mid || (vb == mid && (s & 1) != 0);
+    return { s + round_up, k };
+}
+
+inline char* write_exponent(char* out, int e){
+    *out++ = 'e';
+    *out++ = e < 0 ? '-' : '+';
+    const unsigned magnitude = static_cast<unsigned>(e < 0 ? -e : e);
+    const int n = magnitude >= 100 ? 3 : 2;
+    write_digits(out + n, magnitude);
+    if(magnitude < 10)
+        out[0] = '0';
+    return out + n;
+}
+
+} // namespace charconv_detail
+
+
+//! Writes \a value in decimal to \a out, which must have room for
+//! kMaxNumberChars characters, and returns the end of the output.
+//! No NULL terminator is written.
+template<typename T>
+inline std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value, char*>
+format_number(char* out, T value){
+    using namespace charconv_detail;
+    uint64_t magnitude = static_cast<uint64_t>(value);
+    if(std::is_signed<T>::value && value < 0){
+        *out++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    const int n = count_digits(magnitude);
+    write_digits(out + n, magnitude);
+    return out + n;
+}
+
+//! Writes the shortest decimal that parses back to \a value, laid out like
+//! C++17 std::to_chars: fixed notation unless scientific is shorter, "inf"
+//! and "nan" for the special values. Unlike to_chars, large integers end in
+//! zeros rather than their exact binary digits (2^60 is 1152921504606847000).
+//! Never depends on the locale.
+inline char* format_number(char* out, double value){
+    using namespace charconv_detail;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if(bits >> 63)
+        *out++ = '-';
+    bits &= ~(uint64_t(1) << 63);
+
+    if(bits >= (uint64_t(0x7FF) << 52)){
+        std::memcpy(out, bits == (uint64_t(0x7FF) << 52) ? "inf" : "nan", 3);
+        return out + 3;
+    }
+    if(bits == 0){
+        *out = '0';
+        return out + 1;
+    }
+
+    Decimal decimal = to_decimal(bits);
+    while(decimal.digits % 10 == 0){
+        decimal.digits /= 10;
+        decimal.exponent++;
+    }
+
+    const int n = count_digits(decimal.digits);
+    const int e = decimal.exponent;
+    const int scientific_exponent = e + n - 1;
+    const int scientific_length = n + (n > 1) + 2 + (scientific_exponent >= 100 || scientific_exponent <= -100 ? 3 : 2);
+    const int fixed_length = e >= 0 ? n + e : (n + e > 0 ? n + 1 : 2 - e);
+
+    if(fixed_length <= scientific_length){
+        if(e >= 0){
+            write_digits(out + n, decimal.digits);
+            std::memset(out + n, '0', static_cast<std::size_t>(e));
+        }
+        else if(n + e > 0){
+            // Digits first, then open a gap for the point
+            write_digits(out + n, decimal.digits);
+            std::memmove(out + n + e + 1, out + n + e, static_cast<std::size_t>(-e));
+            out[n + e] = '.';
+        }
+        else{
+            out[0] = '0';
+            out[1] = '.';
+            std::memset(out + 2, '0', static_cast<std::size_t>(-e - n));
+            write_digits(out + fixed_length, decimal.digits);
+        }
+        return out + fixed_length;
+    }
+
+    // d.ddde+XX: write the digits one place to the right, then pull the first back
+    write_digits(out + n + 1, decimal.digits);
+    out[0] = out[1];
+    if(n > 1)
+        out[1] = '.';
+    return write_exponent(out + n + (n > 1), scientific_exponent);
+}
+
+#endif // NUMBERFORMAT_HPP
@@ -0,0 +1,388 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef ROPE_HPP
+#define ROPE_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+#include "Config.hpp"
+#include "String.hpp"
+#include "FVector.hpp"
+
+template<typename Char>
+class Basic_frope_slice;
+
+//! A string kept in fixed size chunks instead of one buffer, for payloads
+//! of many megabytes such as base64 blobs and heredocs. Appending never
+//! moves what is already stored, so growing costs no realloc-and-copy
+//! and the largest allocation is a single chunk. Indexing and slicing
+//! find their chunk by binary search, O(log n) in the number of chunks.
+//! flatten() makes one contiguous FString when a consumer needs it.
+template<typename Char>
+class Basic_frope
+{
+    public:
+
+    using value_type = Char;
+    using size_type = SizeType;
+
+        //! Characters per chunk: 16KiB, small enough to be served from the
+        //! allocator's free lists rather than fresh pages, large enough that
+        //! the per chunk bookkeeping is noise
+        static constexpr SizeType kChunkSize = 16 * 1024 / sizeof(Char);
+
+        class iterator;
+
+        Basic_frope() = default;
+
+        explicit Basic_frope(Basic_fstring_view<Char> str){ append(str); }
+
+        Basic_frope(const Basic_frope& other){ append(other); }
+
+        Basic_frope(Basic_frope&& other) noexcept
+            : m_chunks(std::move(other.m_chunks)), m_size(other.m_size) {
+            other.m_size = 0;
+        }
+
+        ~Basic_frope(){ release(); }
+
+        Basic_frope& operator = (const Basic_frope& other){
+            if(this != &other){
+                clear();
+                append(other);
+            }
+            return *this;
+        }
+
+        Basic_frope& operator = (Basic_frope&& other) noexcept {
+            if(this != &other){
+                release();
+                m_chunks = std::move(other.m_chunks);
+                m_size = other.m_size;
+                other.m_size = 0;
+            }
+            return *this;
+        }
+
+        inline FORCE_INLINE SizeType size() const { return m_size; }
+        inline FORCE_INLINE SizeType length() const { return m_size; }
+        inline FORCE_INLINE bool empty() const { return m_size == 0; }
+
+        //! Number of chunks the characters are spread over
+        inline FORCE_INLINE SizeType chunk_count() const { return m_chunks.size(); }
+
+        //! The characters of chunk \a idx
+        inline FORCE_INLINE Basic_fstring_view<Char> chunk(SizeType idx) const {
+            return Basic_fstring_view<Char>(m_chunks[idx].data, m_chunks[idx].size);
+        }
+
+        //! O(log n), prefer iterating or for_each_piece() for sequential access
+        Char operator [] (SizeType idx) const {
+            assert(idx < m_size && "index out of range");
+            const Chunk& c = m_chunks[locate(idx)];
+            return c.data[idx - c.offset];
+        }
+
+        //! Fills the last chunk, then adds as many new chunks as needed
+        Basic_frope& append(const Char* str, SizeType len){
+            while(len){
+                if(m_chunks.empty() || m_chunks.back().size == m_chunks.back().capacity)
+                    add_chunk(kChunkSize);
+                Chunk& last = m_chunks.back();
+                const SizeType n = std::min(len, last.capacity - last.size);
+                std::memcpy(last.data + last.size, str, sizeof(Char) * n);
+                last.size += n;
+                m_size += n;
+                str += n;
+                len -= n;
+            }
+            return *this;
+        }
+
+        Basic_frope& append(Basic_fstring_view<Char> str){
+            return append(str.data(), str.size());
+        }
+
+        Basic_frope& append(const Basic_frope& other){
+            if(&other == this){
+                const Basic_frope copy(other);
+                return append(copy);
+            }
+            for(SizeType i = 0; i < other.chunk_count(); i++)
+                append(other.chunk(i));
+            return *this;
+        }
+
+        //! Splices the chunks of \a other on without copying any character
+        Basic_frope& append(Basic_frope&& other){
+            if(&other == this)
+                return append(static_cast<const Basic_frope&>(other));
+            m_chunks.reserve(m_chunks.size() + other.m_chunks.size());
+            for(SizeType i = 0; i < other.m_chunks.size(); i++){
+                Chunk c = other.m_chunks[i];
+                c.offset = m_size;
+                m_size += c.size;
+                m_chunks.push_back(c);
+            }
+            other.m_chunks.clear();
+            other.m_size = 0;
+            return *this;
+        }
+
+        void push_back(Char ch){ append(&ch, 1); }
+
+        Basic_frope& operator += (Basic_fstring_view<Char> str){ return append(str); }
+        template<typename Allocator>
+        Basic_frope& operator += (const Basic_fstring<Char, Allocator>& str){ return append(str.view()); }
+        Basic_frope& operator += (Char ch){ push_back(ch); return *this; }
+
+        template<SizeType N>
+        Basic_frope& operator += (const Char (&str)[N]){ return append(str, N - 1); }
+
+        void clear() noexcept {
+            release();
+            m_chunks.clear();
+            m_size = 0;
+        }
+
+        //! Calls f(Basic_fstring_view<Char>) for the pieces of the characters
+        //! [pos, pos + count), in order; at most one piece per chunk
+        template<typename Function>
+        void for_each_piece(SizeType pos, SizeType count, Function f) const {
+            assert(pos <= m_size && "starting index must be less than the size of this rope!");
+            count = std::min(count, m_size - pos);
+            if(count == 0)
+                return;
+            for(SizeType i = locate(pos); count; i++){
+                const Chunk& c = m_chunks[i];
+                const SizeType first = pos - c.offset;
+                const SizeType n = std::min(count, c.size - first);
+                f(Basic_fstring_view<Char>(c.data + first, n));
+                pos += n;
+                count -= n;
+            }
+        }
+
+        template<typename Function>
+        void for_each_piece(Function f) const { for_each_piece(0, m_size, f); }
+
+        //! Copies at most \a count characters starting at \a pos to \a dest,
+        //! which is not NULL terminated; returns the number copied
+        SizeType copy(Char* dest, SizeType count, SizeType pos = 0) const {
+            Char* out = dest;
+            for_each_piece(pos, count, [&out](Basic_fstring_view<Char> piece){
+                std::memcpy(out, piece.data(), sizeof(Char) * piece.size());
+                out += piece.size();
+            });
+            return static_cast<SizeType>(out - dest);
+        }
+
+        //! The characters [pos, pos + count) without copying them
+        Basic_frope_slice<Char> slice(SizeType pos, SizeType count = Basic_fstring<Char>::npos) const;
+
+        //! One contiguous string, a single allocation
+        Basic_fstring<Char> flatten() const { return flatten(0, m_size); }
+
+        Basic_fstring<Char> flatten(SizeType pos, SizeType count) const {
+            assert(pos <= m_size && "starting index must be less than the size of this rope!");
+            count = std::min(count, m_size - pos);
+            Basic_fstring<Char> str;
+            str.resize_and_overwrite(count, [&](Char* p, SizeType n){ return copy(p, n, pos); });
+            return str;
+        }
+
+        iterator begin() const { return iterator(this, 0, 0); }
+        iterator end() const { return iterator(this, m_chunks.size(), 0); }
+
+        void swap(Basic_frope& other) noexcept {
+            m_chunks.swap(other.m_chunks);
+            std::swap(m_size, other.m_size);
+        }
+
+        //! Walks the characters chunk by chunk
+        class iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Char;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const Char*;
+                using reference = const Char&;
+
+                iterator() = default;
+
+                reference operator * () const { return m_rope->m_chunks[m_chunk].data[m_pos]; }
+                pointer operator -> () const { return &**this; }
+
+                iterator& operator ++ () {
+                    if(++m_pos == m_rope->m_chunks[m_chunk].size){
+                        m_pos = 0;
+                        m_chunk++;
+                    }
+                    return *this;
+                }
+                iterator operator ++ (int) { iterator t(*this); ++*this; return t; }
+
+                friend bool operator == (const iterator& x, const iterator& y){
+                    return x.m_chunk == y.m_chunk && x.m_pos == y.m_pos;
+                }
+                friend bool operator != (const iterator& x, const iterator& y){ return !(x == y); }
+
+            private:
+                friend class Basic_frope;
+
+                const Basic_frope* m_rope = nullptr;
+                SizeType m_chunk = 0;
+                SizeType m_pos = 0;
+
+                iterator(const Basic_frope* rope, SizeType chunk, SizeType pos)
+                    : m_rope(rope), m_chunk(chunk), m_pos(pos) {}
+        };
+
+    private:
+
+        //! \a offset is the index of the chunk's first character in the rope.
+        //! Chunks are never empty, only the last one and those spliced in
+        //! by append(Basic_frope&&) may be partly filled.
+        struct Chunk{
+            Char* data;
+            SizeType offset;
+            SizeType size;
+            SizeType capacity;
+        };
+
+        FVector<Chunk> m_chunks;
+        SizeType m_size = 0;
+
+        //! Index of the chunk holding character \a idx, idx < size()
+        SizeType locate(SizeType idx) const {
+            const Chunk* first = m_chunks.data();
+            const Chunk* last = first + m_chunks.size();
+            const Chunk* found = std::upper_bound(first, last, idx,
+                                    [](SizeType i, const Chunk& c){ return i < c.offset; });
+            return static_cast<SizeType>(found - first) - 1;
+        }
+
+        void add_chunk(SizeType capacity){
+            Chunk c;
+            c.data = static_cast<Char*>(SFAllocator<Char>::allocate(capacity));
+            c.offset = m_size;
+            c.size = 0;
+            c.capacity = capacity;
+            try{
+                m_chunks.push_back(c);
+            }
+            catch(...){
+                SFAllocator<Char>::deallocate(c.data);
+                throw;
+            }
+        }
+
+        void release() noexcept {
+            for(SizeType i = 0; i < m_chunks.size(); i++)
+                SFAllocator<Char>::deallocate(m_chunks[i].data);
+        }
+};
+
+template<typename Char>
+constexpr SizeType Basic_frope<Char>::kChunkSize;
+
+//! A window into a rope, like a view into a string. The rope must outlive it
+//! and not be modified meanwhile.
+template<typename Char>
+class Basic_frope_slice
+{
+    public:
+        Basic_frope_slice(const Basic_frope<Char>* rope, SizeType pos, SizeType count)
+            : m_rope(rope), m_pos(pos), m_size(count) {}
+
+        SizeType size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        Char operator [] (SizeType idx) const { return (*m_rope)[m_pos + idx]; }
+
+        Basic_frope_slice slice(SizeType pos, SizeType count = Basic_fstring<Char>::npos) const {
+            assert(pos <= m_size && "starting index must be less than the size of this slice!");
+            return Basic_frope_slice(m_rope, m_pos + pos, std::min(count, m_size - pos));
+        }
+
+        template<typename Function>
+        void for_each_piece(Function f) const { m_rope->for_each_piece(m_pos, m_size, f); }
+
+        SizeType copy(Char* dest, SizeType count, SizeType pos = 0) const {
+            return m_rope->copy(dest, std::min(count, m_size - pos), m_pos + pos);
+        }
+
+        Basic_fstring<Char> flatten() const { return m_rope->flatten(m_pos, m_size); }
+
+    private:
+        const Basic_frope<Char>* m_rope;
+        SizeType m_pos;
+        SizeType m_size;
+};
+
+template<typename Char>
+inline Basic_frope_slice<Char> Basic_frope<Char>::slice(SizeType pos, SizeType count) const {
+    assert(pos <= m_size && "starting index must be less than the size of this rope!");
+    return Basic_frope_slice<Char>(this, pos, std::min(count, m_size - pos));
+}
+
+//! Compares piece by piece, nothing is flattened
+template<typename Char>
+inline bool operator == (const Basic_frope<Char>& lhs, Basic_fstring_view<Char> rhs){
+    if(lhs.size() != rhs.size())
+        return false;
+    bool equal = true;
+    SizeType pos = 0;
+    lhs.for_each_piece([&](Basic_fstring_view<Char> piece){
+        equal = equal && Basic_fstring_view<Char>::equals(piece, rhs.substr(pos, piece.size()));
+        pos += piece.size();
+    });
+    return equal;
+}
+
+template<typename Char, typename Allocator>
+inline bool operator == (const Basic_frope<Char>& lhs, const Basic_fstring<Char, Allocator>& rhs){
+    return lhs == rhs.view();
+}
+
+template<typename Char, SizeType N>
+inline bool operator == (const Basic_frope<Char>& lhs, const Char (&rhs)[N]){
+    return lhs == Basic_fstring_view<Char>(rhs);
+}
+
+template<typename Char>
+inline bool operator != (const Basic_frope<Char>& lhs, Basic_fstring_view<Char> rhs){
+    return !(lhs == rhs);
+}
+
+template<typename Char>
+inline std::basic_ostream<Char>& operator << (std::basic_ostream<Char>& o, const Basic_frope<Char>& rope){
+    rope.for_each_piece([&o](Basic_fstring_view<Char> piece){ o << piece; });
+    return o;
+}
+
+template<typename Char>
+inline void swap(Basic_frope<Char>& lhs, Basic_frope<Char>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+using FRope = Basic_frope<char>;
+using FWRope = Basic_frope<wchar_t>;
+using F16Rope = Basic_frope<char16_t>;
+using F32Rope = Basic_frope<char32_t>;
+
+using FRopeSlice = Basic_frope_slice<char>;
+
+#endif // ROPE_HPP
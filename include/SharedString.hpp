@@ -0,0 +1,257 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef SHAREDSTRING_HPP
+#define SHAREDSTRING_HPP
+
+#include <atomic>
+#include <new>
+#include "Config.hpp"
+#include "String.hpp"
+#include "HashMap.hpp"
+
+//! An immutable string whose heap characters are shared between copies.
+//! Copying is a reference count increment whatever the length, so large
+//! literals and doc comments can be passed around an AST freely. Short
+//! strings live in the object itself, as in Basic_fstring, and the
+//! footprint is the same. Copies may be handed to other threads; the
+//! count is atomic and the characters are never written after construction.
+template<typename Char>
+class Basic_shared_fstring
+{
+    public:
+
+    using value_type = Char;
+    using size_type = SizeType;
+    using const_pointer = const value_type*;
+    using const_reference = const value_type&;
+    using iterator = const value_type*;
+    using const_iterator = const value_type*;
+
+        //! Strings shorter than this are stored inline, never shared
+        static constexpr int kSS = Basic_fstring<Char>::kSS;
+
+        Basic_shared_fstring() noexcept { m_data.local[0] = '\0'; }
+
+        template<SizeType N>
+        Basic_shared_fstring(const Char (&data)[N]){
+            construct_from(data, N - 1);
+        }
+
+        explicit Basic_shared_fstring(Basic_fstring_view<Char> view){
+            construct_from(view.data(), view.size());
+        }
+
+        //! Copies the characters once; copies of the result share them
+        template<typename Allocator>
+        Basic_shared_fstring(const Basic_fstring<Char, Allocator>& str){
+            construct_from(str.data(), str.size());
+        }
+
+        Basic_shared_fstring(const Basic_shared_fstring& other) noexcept
+            : m_data(other.m_data), m_size(other.m_size) {
+            if(is_shared())
+                m_data.heap->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Basic_shared_fstring(Basic_shared_fstring&& other) noexcept
+            : m_data(other.m_data), m_size(other.m_size) {
+            other.m_size = 0;
+            other.m_data.local[0] = '\0';
+        }
+
+        FORCE_INLINE ~Basic_shared_fstring() { release(); }
+
+        Basic_shared_fstring& operator = (const Basic_shared_fstring& other) noexcept {
+            Basic_shared_fstring(other).swap(*this);
+            return *this;
+        }
+
+        Basic_shared_fstring& operator = (Basic_shared_fstring&& other) noexcept {
+            Basic_shared_fstring(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        inline FORCE_INLINE const Char* data() const noexcept {
+            return is_shared() ? m_data.heap->chars() : static_cast<const Char*>(m_data.local);
+        }
+
+        inline FORCE_INLINE const Char* c_str() const noexcept { return data(); }
+        inline FORCE_INLINE SizeType size() const noexcept { return m_size; }
+        inline FORCE_INLINE SizeType length() const noexcept { return m_size; }
+        inline FORCE_INLINE bool empty() const noexcept { return m_size == 0; }
+
+        inline FORCE_INLINE const Char& operator [] (SizeType idx) const { return data()[idx]; }
+
+        const_iterator begin() const noexcept { return data(); }
+        const_iterator cbegin() const noexcept { return data(); }
+        const_iterator end() const noexcept { return data() + m_size; }
+        const_iterator cend() const noexcept { return data() + m_size; }
+
+        inline FORCE_INLINE Basic_fstring_view<Char> view() const noexcept {
+            return Basic_fstring_view<Char>(data(), m_size);
+        }
+
+        inline FORCE_INLINE operator Basic_fstring_view<Char> () const noexcept { return view(); }
+
+        //! A mutable copy of the characters
+        Basic_fstring<Char> str() const { return Basic_fstring<Char>(view()); }
+
+        std::basic_string<Char> to_string() const { return std::basic_string<Char>(data(), m_size); }
+
+        //! Number of strings sharing these characters, 1 for inline strings
+        SizeType use_count() const noexcept {
+            return is_shared() ? m_data.heap->refs.load(std::memory_order_relaxed) : 1;
+        }
+
+        void swap(Basic_shared_fstring& other) noexcept {
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+        }
+
+    private:
+
+        //! Heap block: the count, then size() + 1 characters
+        struct Payload{
+            std::atomic<SizeType> refs;
+
+            Char* chars() noexcept { return reinterpret_cast<Char*>(this + 1); }
+        };
+
+        static_assert(alignof(Payload) >= alignof(Char), "characters must be aligned after the count");
+
+        union Data {
+            Char local[kSS];
+            Payload* heap;
+        };
+
+        Data m_data;
+        SizeType m_size = 0;
+
+        inline FORCE_INLINE bool is_shared() const noexcept { return m_size >= SizeType(kSS); }
+
+        void construct_from(const Char* str, SizeType len){
+            m_size = len;
+            Char* dest = m_data.local;
+            if(is_shared()){
+                void* block = operator new (sizeof(Payload) + sizeof(Char) * (len + 1));
+                m_data.heap = new (block) Payload{ {1} };
+                dest = m_data.heap->chars();
+            }
+            if(len)
+                std::memcpy(dest, str, sizeof(Char) * len);
+            dest[len] = '\0';
+        }
+
+        void FORCE_INLINE release() noexcept {
+            if(is_shared() && m_data.heap->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+                m_data.heap->~Payload();
+                operator delete (m_data.heap);
+            }
+        }
+};
+
+template<typename Char> inline FORCE_INLINE
+bool operator == (const Basic_shared_fstring<Char>& lhs, const Basic_shared_fstring<Char>& rhs){
+    return lhs.data() == rhs.data() ? lhs.size() == rhs.size() : Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator != (const Basic_shared_fstring<Char>& lhs, const Basic_shared_fstring<Char>& rhs){
+    return !(lhs == rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator == (const Basic_shared_fstring<Char>& lhs, Basic_fstring_view<Char> rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator == (Basic_fstring_view<Char> lhs, const Basic_shared_fstring<Char>& rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator != (const Basic_shared_fstring<Char>& lhs, Basic_fstring_view<Char> rhs){
+    return !Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator != (Basic_fstring_view<Char> lhs, const Basic_shared_fstring<Char>& rhs){
+    return !Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator == (const Basic_shared_fstring<Char>& lhs, const Basic_fstring<Char, Allocator>& rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator == (const Basic_fstring<Char, Allocator>& lhs, const Basic_shared_fstring<Char>& rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator != (const Basic_shared_fstring<Char>& lhs, const Basic_fstring<Char, Allocator>& rhs){
+    return !Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator != (const Basic_fstring<Char, Allocator>& lhs, const Basic_shared_fstring<Char>& rhs){
+    return !Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, SizeType N> inline FORCE_INLINE
+bool operator == (const Basic_shared_fstring<Char>& lhs, const Char (&rhs)[N]){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, SizeType N> inline FORCE_INLINE
+bool operator != (const Basic_shared_fstring<Char>& lhs, const Char (&rhs)[N]){
+    return !Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> inline
+bool operator < (const Basic_shared_fstring<Char>& lhs, const Basic_shared_fstring<Char>& rhs){
+    return Basic_fstring_view<Char>::compare(lhs, rhs) < 0;
+}
+
+template<typename Char>
+inline std::basic_ostream<Char>& operator << (std::basic_ostream<Char>& o, const Basic_shared_fstring<Char>& str){
+    return o << str.view();
+}
+
+template<typename Char>
+inline void swap(Basic_shared_fstring<Char>& lhs, Basic_shared_fstring<Char>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template<typename Char>
+struct IsTriviallyRelocatable<Basic_shared_fstring<Char>> : std::true_type {};
+
+using SharedFString = Basic_shared_fstring<char>;
+using SharedFWString = Basic_shared_fstring<wchar_t>;
+using SharedF16String = Basic_shared_fstring<char16_t>;
+using SharedF32String = Basic_shared_fstring<char32_t>;
+
+static_assert(sizeof(SharedFString) == sizeof(FString), "sharing must not grow the string");
+
+//! Hashes alike with the FString or view of the same characters
+template<>
+inline SizeType FORCE_INLINE hash_it<SharedFString>(const SharedFString& t){
+    return hash_chars(t.data(), t.size());
+}
+
+template<>
+struct HashIt<SharedFString> : StringHash {};
+
+#endif // SHAREDSTRING_HPP
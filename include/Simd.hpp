@@ -0,0 +1,760 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include "Config.hpp"
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+
+//! SSE2 is part of the x86-64 baseline, so it is used unconditionally there.
+//! AVX2 kernels are compiled with a target attribute and selected at runtime,
+//! hence the library still runs on CPUs without AVX2.
+//! Define PARSER_DS_NO_SIMD to force the portable scalar kernels.
+#if !defined(PARSER_DS_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(SIMD_SSE2) && defined(__GNUC__)
+#define SIMD_AVX2 1
+#define SIMD_SSSE3 1
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace simd {
+
+inline bool cpu_has_avx2(){
+#if defined(__AVX2__)
+    return true;
+#elif defined(SIMD_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool cpu_has_ssse3(){
+#if defined(__SSSE3__)
+    return true;
+#elif defined(SIMD_SSSE3)
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+//! index of the lowest set bit; \a mask must not be zero
+inline unsigned FORCE_INLINE lowest_bit(unsigned mask){
+#ifdef __GNUC__
+    return __builtin_ctz(mask);
+#elif _MSC_VER
+    unsigned long idx; _BitScanForward(&idx, mask); return idx;
+#else
+    unsigned idx = 0;
+    for(; !(mask & 1u); mask >>= 1) idx++;
+    return idx;
+#endif
+}
+
+//! index of the highest set bit; \a mask must not be zero
+inline unsigned FORCE_INLINE highest_bit(unsigned mask){
+#ifdef __GNUC__
+    return 31 - __builtin_clz(mask);
+#elif _MSC_VER
+    unsigned long idx; _BitScanReverse(&idx, mask); return idx;
+#else
+    unsigned idx = 0;
+    for(; mask >>= 1;) idx++;
+    return idx;
+#endif
+}
+
+//! Needles longer than this are searched with Two-Way, which is linear in
+//! the worst case, instead of the first/last byte filter.
+constexpr SizeType kTwoWayThreshold = 64;
+
+
+//! A set of byte values, usable in constant expressions:
+//!     constexpr simd::CharSet separators(",;| \t");
+//! Besides a 256 bit map for the scalar kernels it keeps two 16 entry tables
+//! indexed by the low nibble, one for bytes below 0x80 and one for the rest.
+//! Bit h of entry l is set if the byte (h << 4 | l) is a member, so pshufb can
+//! classify a whole block of bytes with three table lookups.
+class CharSet{
+public:
+    constexpr CharSet() {}
+
+    template<std::size_t N>
+    constexpr CharSet(const char (&chars)[N]){
+        for(std::size_t i = 0; i + 1 < N; i++)
+            add(chars[i]);
+    }
+
+    constexpr CharSet(const char* chars, std::size_t len){
+        for(std::size_t i = 0; i < len; i++)
+            add(chars[i]);
+    }
+
+    constexpr CharSet& add(unsigned char ch){
+        m_bits[ch >> 6] |= uint64_t(1) << (ch & 63);
+        if(ch < 0x80)
+            m_rows_low[ch & 15] |= static_cast<uint8_t>(1u << (ch >> 4));
+        else
+            m_rows_high[ch & 15] |= static_cast<uint8_t>(1u << ((ch >> 4) - 8));
+        return *this;
+    }
+
+    constexpr CharSet& add(char ch){
+        return add(static_cast<unsigned char>(ch));
+    }
+
+    //! Adds the bytes of the closed range [first, last]
+    constexpr CharSet& add_range(unsigned char first, unsigned char last){
+        for(unsigned ch = first; ch <= last; ch++)
+            add(static_cast<unsigned char>(ch));
+        return *this;
+    }
+
+    constexpr bool contains(unsigned char ch) const {
+        return (m_bits[ch >> 6] >> (ch & 63)) & 1;
+    }
+
+    constexpr bool contains(char ch) const {
+        return contains(static_cast<unsigned char>(ch));
+    }
+
+    constexpr CharSet operator ~ () const {
+        CharSet result;
+        for(unsigned ch = 0; ch < 256; ch++)
+            if(!contains(static_cast<unsigned char>(ch)))
+                result.add(static_cast<unsigned char>(ch));
+        return result;
+    }
+
+    friend constexpr CharSet operator | (const CharSet& x, const CharSet& y){
+        CharSet result = x;
+        for(unsigned ch = 0; ch < 256; ch++)
+            if(y.contains(static_cast<unsigned char>(ch)))
+                result.add(static_cast<unsigned char>(ch));
+        return result;
+    }
+
+    const uint8_t* rows_low() const { return m_rows_low; }
+    const uint8_t* rows_high() const { return m_rows_high; }
+
+private:
+    uint64_t m_bits[4] = {};
+    uint8_t m_rows_low[16] = {};
+    uint8_t m_rows_high[16] = {};
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+////                        Scalar (portable) kernels                     //////
+////  All kernels return nullptr when nothing is found                    //////
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename Char>
+inline const Char* find_char_scalar(const Char* first, const Char* last, Char ch){
+    for(; first != last; ++first)
+        if(*first == ch)
+            return first;
+    return nullptr;
+}
+
+template<typename Char>
+inline const Char* rfind_char_scalar(const Char* first, const Char* last, Char ch){
+    while(last != first)
+        if(*--last == ch)
+            return last;
+    return nullptr;
+}
+
+template<typename Char>
+inline const Char* find_substring_scalar(const Char* hay, SizeType hlen, const Char* needle, SizeType nlen){
+    if(nlen == 0)
+        return hay;
+    if(nlen > hlen)
+        return nullptr;
+    const Char* stop = hay + (hlen - nlen) + 1;
+    for(const Char* p = hay; (p = find_char_scalar(p, stop, needle[0])) != nullptr; ++p)
+        if(std::equal(needle + 1, needle + nlen, p + 1))
+            return p;
+    return nullptr;
+}
+
+//! Characters beyond the byte range are never members of a CharSet
+template<typename Char>
+inline bool FORCE_INLINE in_set(Char ch, const CharSet& set){
+    using Unsigned = std::make_unsigned_t<Char>;
+    const Unsigned u = static_cast<Unsigned>(ch);
+    return u < 256 && set.contains(static_cast<unsigned char>(u));
+}
+
+//! The first character whose membership in \a set is \a Member
+template<bool Member, typename Char>
+inline const Char* find_set_scalar(const Char* first, const Char* last, const CharSet& set){
+    for(; first != last; ++first)
+        if(in_set(*first, set) == Member)
+            return first;
+    return nullptr;
+}
+
+//! The last character whose membership in \a set is \a Member
+template<bool Member, typename Char>
+inline const Char* rfind_set_scalar(const Char* first, const Char* last, const CharSet& set){
+    while(last != first)
+        if(in_set(*--last, set) == Member)
+            return last;
+    return nullptr;
+}
+
+//! ASCII case folding, bytes outside 'A'..'Z' are left alone
+inline unsigned char FORCE_INLINE fold_case(unsigned char c){
+    return static_cast<unsigned>(c - 'A') < 26u ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+//! fold_case on the eight bytes of a word at once. The top bit of every byte
+//! is masked off before adding, so no carry crosses into the next byte.
+inline uint64_t FORCE_INLINE fold_case_word(uint64_t w){
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t heptets = w & (0x7F * ones);
+    const uint64_t from_a = heptets + (0x80 - 'A') * ones;       // top bit set from 'A' on
+    const uint64_t past_z = heptets + (0x80 - 'Z' - 1) * ones;   // top bit set past 'Z'
+    const uint64_t upper = from_a & ~past_z & ~w & (0x80 * ones);
+    return w | (upper >> 2);
+}
+
+//! Index of the first byte where \a a and \a b differ ignoring ASCII case, \a n if none
+inline SizeType mismatch_icase_scalar(const char* a, const char* b, SizeType n){
+    SizeType i = 0;
+    for(; i + 8 <= n; i += 8){
+        uint64_t x, y;
+        std::memcpy(&x, a + i, sizeof(x));
+        std::memcpy(&y, b + i, sizeof(y));
+        if(fold_case_word(x) != fold_case_word(y))
+            break;
+    }
+    for(; i < n; i++)
+        if(fold_case(a[i]) != fold_case(b[i]))
+            return i;
+    return n;
+}
+
+inline uint64_t FORCE_INLINE hash_word(uint64_t h, uint64_t word){
+    h = (h ^ word) * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 32);
+}
+
+//! Hashes the last \a n < 16 bytes as zero padded words. Every kernel
+//! folds the same words, so the hash does not depend on the kernel used.
+inline uint64_t hash_icase_tail(uint64_t h, const char* p, SizeType n){
+    unsigned char buffer[16] = {};
+    if(n)
+        std::memcpy(buffer, p, n);
+    uint64_t low, high;
+    std::memcpy(&low, buffer, sizeof(low));
+    std::memcpy(&high, buffer + 8, sizeof(high));
+    h = hash_word(h, fold_case_word(low));
+    return n > 8 ? hash_word(h, fold_case_word(high)) : h;
+}
+
+//! The length is the seed, else padding would make "a" and "a\0" collide
+inline uint64_t hash_icase_scalar(const char* p, SizeType n){
+    uint64_t h = n;
+    SizeType i = 0;
+    for(; i + 16 <= n; i += 16){
+        uint64_t low, high;
+        std::memcpy(&low, p + i, sizeof(low));
+        std::memcpy(&high, p + i + 8, sizeof(high));
+        h = hash_word(hash_word(h, fold_case_word(low)), fold_case_word(high));
+    }
+    return hash_icase_tail(h, p + i, n - i);
+}
+
+//! Crochemore-Perrin Two-Way string matching: O(hlen + nlen) time, O(1) space
+//! apart from the 256 entry shift table. Requires 0 < nlen <= hlen.
+inline const char* find_substring_two_way(const char* hay_, SizeType hlen, const char* needle_, SizeType nlen){
+    const unsigned char* h = reinterpret_cast<const unsigned char*>(hay_);
+    const unsigned char* const z = h + hlen;
+    const unsigned char* n = reinterpret_cast<const unsigned char*>(needle_);
+    const std::size_t l = nlen;
+
+    // shift[c] is one past the last position of c in the needle, 0 if absent
+    std::size_t shift[256] = {};
+    for(std::size_t i = 0; i < l; i++)
+        shift[n[i]] = i + 1;
+
+    // Critical factorization: maximal suffix for both orderings of the alphabet
+    std::size_t ip = std::size_t(-1), jp = 0, k = 1, p = 1;
+    while(jp + k < l){
+        if(n[ip+k] == n[jp+k]){
+            if(k == p){ jp += p; k = 1; }
+            else k++;
+        }
+        else if(n[ip+k] > n[jp+k]){ jp += k; k = 1; p = jp - ip; }
+        else { ip = jp++; k = p = 1; }
+    }
+    std::size_t ms = ip;
+    const std::size_t p0 = p;
+
+    ip = std::size_t(-1); jp = 0; k = p = 1;
+    while(jp + k < l){
+        if(n[ip+k] == n[jp+k]){
+            if(k == p){ jp += p; k = 1; }
+            else k++;
+        }
+        else if(n[ip+k] < n[jp+k]){ jp += k; k = 1; p = jp - ip; }
+        else { ip = jp++; k = p = 1; }
+    }
+    if(ip + 1 > ms + 1) ms = ip;
+    else p = p0;
+
+    // For a periodic needle we remember how much of it already matched
+    std::size_t mem0, mem = 0;
+    if(std::memcmp(n, n + p, ms + 1)){
+        mem0 = 0;
+        p = std::max(ms, l - ms - 1) + 1;
+    }
+    else
+        mem0 = l - p;
+
+    while(std::size_t(z - h) >= l){
+        // Check the last byte first; skip by the shift table on mismatch
+        k = shift[h[l-1]];
+        if(k == 0){
+            h += l;
+            mem = 0;
+            continue;
+        }
+        k = l - k;
+        if(k){
+            h += std::max(k, mem);
+            mem = 0;
+            continue;
+        }
+
+        // Compare the right half
+        for(k = std::max(ms + 1, mem); k < l && n[k] == h[k]; k++);
+        if(k < l){
+            h += k - ms;
+            mem = 0;
+            continue;
+        }
+        // Compare the left half
+        for(k = ms + 1; k > mem && n[k-1] == h[k-1]; k--);
+        if(k <= mem)
+            return reinterpret_cast<const char*>(h);
+        h += p;
+        mem = mem0;
+    }
+    return nullptr;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+////                               SSE2 kernels                           //////
+////////////////////////////////////////////////////////////////////////////////
+#ifdef SIMD_SSE2
+
+inline const char* find_char_sse2(const char* first, const char* last, char ch){
+    const __m128i needle = _mm_set1_epi8(ch);
+    for(; last - first >= 16; first += 16){
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if(mask)
+            return first + lowest_bit(mask);
+    }
+    return find_char_scalar(first, last, ch);
+}
+
+inline const char* rfind_char_sse2(const char* first, const char* last, char ch){
+    const __m128i needle = _mm_set1_epi8(ch);
+    while(last - first >= 16){
+        last -= 16;
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(last));
+        const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if(mask)
+            return last + highest_bit(mask);
+    }
+    return rfind_char_scalar(first, last, ch);
+}
+
+//! First/last byte filter: a block of 16 candidate positions is compared
+//! against the first and the last byte of the needle at once, only the
+//! positions matching both are verified. Requires 2 <= nlen <= hlen.
+inline const char* find_substring_sse2(const char* hay, SizeType hlen, const char* needle, SizeType nlen){
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[nlen-1]);
+    const SizeType candidates = hlen - nlen + 1;
+    SizeType i = 0;
+    for(; i + 16 <= candidates; i += 16){
+        const __m128i bf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        const __m128i bl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + nlen - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last)));
+        for(; mask; mask &= mask - 1){
+            const SizeType pos = i + lowest_bit(mask);
+            if(std::memcmp(hay + pos + 1, needle + 1, nlen - 2) == 0)
+                return hay + pos;
+        }
+    }
+    return find_substring_scalar(hay + i, hlen - i, needle, nlen);
+}
+
+//! Adds 0x20 to the bytes in 'A'..'Z'. Bytes from 0x80 on are negative
+//! as signed chars, so they are never in range.
+inline __m128i FORCE_INLINE fold_case_sse2(__m128i block){
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)),
+                                        _mm_cmplt_epi8(block, _mm_set1_epi8('Z' + 1)));
+    return _mm_add_epi8(block, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+inline SizeType mismatch_icase_sse2(const char* a, const char* b, SizeType n){
+    SizeType i = 0;
+    for(; i + 16 <= n; i += 16){
+        const __m128i x = fold_case_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        const __m128i y = fold_case_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        const unsigned equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+        if(equal != 0xFFFF)
+            return i + lowest_bit(~equal);
+    }
+    return i + mismatch_icase_scalar(a + i, b + i, n - i);
+}
+
+inline uint64_t hash_icase_sse2(const char* p, SizeType n){
+    uint64_t h = n;
+    SizeType i = 0;
+    for(; i + 16 <= n; i += 16){
+        uint64_t words[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(words), fold_case_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))));
+        h = hash_word(hash_word(h, words[0]), words[1]);
+    }
+    return hash_icase_tail(h, p + i, n - i);
+}
+
+#endif // SIMD_SSE2
+
+
+////////////////////////////////////////////////////////////////////////////////
+////                              SSSE3 kernels                           //////
+////  Only called after cpu_has_ssse3() returned true                     //////
+////////////////////////////////////////////////////////////////////////////////
+#ifdef SIMD_SSSE3
+
+//! Nonzero bytes mark the members of \a set in \a block. pshufb yields zero for
+//! indices with the top bit set, so each row table only answers for its half.
+TARGET_SSSE3 inline __m128i FORCE_INLINE classify_ssse3(__m128i block, __m128i rows_low, __m128i rows_high){
+    const __m128i column_bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i rows = _mm_or_si128(_mm_shuffle_epi8(rows_low, block),
+                                      _mm_shuffle_epi8(rows_high, _mm_xor_si128(block, _mm_set1_epi8(-128))));
+    const __m128i high_nibbles = _mm_and_si128(_mm_srli_epi16(block, 4), _mm_set1_epi8(0x0F));
+    return _mm_and_si128(rows, _mm_shuffle_epi8(column_bits, high_nibbles));
+}
+
+//! One bit per byte of the 16 at \a p, set where membership equals \a Member
+template<bool Member>
+TARGET_SSSE3 inline unsigned FORCE_INLINE set_mask_ssse3(const char* p, __m128i rows_low, __m128i rows_high){
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i members = classify_ssse3(block, rows_low, rows_high);
+    const unsigned outsiders = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(members, _mm_setzero_si128())));
+    return Member ? ~outsiders & 0xFFFFu : outsiders;
+}
+
+template<bool Member>
+TARGET_SSSE3 inline const char* find_set_ssse3(const char* first, const char* last, const CharSet& set){
+    const __m128i rows_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows_low()));
+    const __m128i rows_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows_high()));
+    for(; last - first >= 16; first += 16){
+        const unsigned mask = set_mask_ssse3<Member>(first, rows_low, rows_high);
+        if(mask)
+            return first + lowest_bit(mask);
+    }
+    return find_set_scalar<Member>(first, last, set);
+}
+
+template<bool Member>
+TARGET_SSSE3 inline const char* rfind_set_ssse3(const char* first, const char* last, const CharSet& set){
+    const __m128i rows_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows_low()));
+    const __m128i rows_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows_high()));
+    while(last - first >= 16){
+        last -= 16;
+        const unsigned mask = set_mask_ssse3<Member>(last, rows_low, rows_high);
+        if(mask)
+            return last + highest_bit(mask);
+    }
+    return rfind_set_scalar<Member>(first, last, set);
+}
+
+#endif // SIMD_SSSE3
+
+
+////////////////////////////////////////////////////////////////////////////////
+////                               AVX2 kernels                           //////
+////  Only called after cpu_has_avx2() returned true                      //////
+////////////////////////////////////////////////////////////////////////////////
+#ifdef SIMD_AVX2
+
+TARGET_AVX2 inline const char* find_char_avx2(const char* first, const char* last, char ch){
+    const __m256i needle = _mm256_set1_epi8(ch);
+    for(; last - first >= 32; first += 32){
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        const unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if(mask)
+            return first + lowest_bit(mask);
+    }
+    return find_char_sse2(first, last, ch);
+}
+
+TARGET_AVX2 inline const char* rfind_char_avx2(const char* first, const char* last, char ch){
+    const __m256i needle = _mm256_set1_epi8(ch);
+    while(last - first >= 32){
+        last -= 32;
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(last));
+        const unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if(mask)
+            return last + highest_bit(mask);
+    }
+    return rfind_char_sse2(first, last, ch);
+}
+
+TARGET_AVX2 inline const char* find_substring_avx2(const char* hay, SizeType hlen, const char* needle, SizeType nlen){
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[nlen-1]);
+    const SizeType candidates = hlen - nlen + 1;
+    SizeType i = 0;
+    for(; i + 32 <= candidates; i += 32){
+        const __m256i bf = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+        const __m256i bl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + nlen - 1));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(bf, first),
+                                                              _mm256_cmpeq_epi8(bl, last)));
+        for(; mask; mask &= mask - 1){
+            const SizeType pos = i + lowest_bit(mask);
+            if(std::memcmp(hay + pos + 1, needle + 1, nlen - 2) == 0)
+                return hay + pos;
+        }
+    }
+    return find_substring_sse2(hay + i, hlen - i, needle, nlen);
+}
+
+//! The 32 byte counterpart of set_mask_ssse3; vpshufb looks up within each
+//! 128 bit lane, hence the row tables are broadcast to both lanes
+template<bool Member>
+TARGET_AVX2 inline unsigned FORCE_INLINE set_mask_avx2(const char* p, const CharSet& set){
+    const __m256i rows_low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows_low())));
+    const __m256i rows_high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows_high())));
+    const __m256i column_bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                                 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i rows = _mm256_or_si256(_mm256_shuffle_epi8(rows_low, block),
+                                         _mm256_shuffle_epi8(rows_high, _mm256_xor_si256(block, _mm256_set1_epi8(-128))));
+    const __m256i high_nibbles = _mm256_and_si256(_mm256_srli_epi16(block, 4), _mm256_set1_epi8(0x0F));
+    const __m256i members = _mm256_and_si256(rows, _mm256_shuffle_epi8(column_bits, high_nibbles));
+    const unsigned outsiders = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(members, _mm256_setzero_si256())));
+    return Member ? ~outsiders : outsiders;
+}
+
+template<bool Member>
+TARGET_AVX2 inline const char* find_set_avx2(const char* first, const char* last, const CharSet& set){
+    for(; last - first >= 32; first += 32){
+        const unsigned mask = set_mask_avx2<Member>(first, set);
+        if(mask)
+            return first + lowest_bit(mask);
+    }
+    return find_set_ssse3<Member>(first, last, set);
+}
+
+template<bool Member>
+TARGET_AVX2 inline const char* rfind_set_avx2(const char* first, const char* last, const CharSet& set){
+    while(last - first >= 32){
+        last -= 32;
+        const unsigned mask = set_mask_avx2<Member>(last, set);
+        if(mask)
+            return last + highest_bit(mask);
+    }
+    return rfind_set_ssse3<Member>(first, last, set);
+}
+
+#endif // SIMD_AVX2
+
+
+////////////////////////////////////////////////////////////////////////////////
+////                          Dispatching entry points                    //////
+////  Wide character types always take the scalar path                    //////
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename Char>
+inline const Char* find_char(const Char* first, const Char* last, Char ch){
+    return find_char_scalar(first, last, ch);
+}
+
+inline const char* find_char(const char* first, const char* last, char ch){
+#ifdef SIMD_AVX2
+    if(last - first >= 32 && cpu_has_avx2())
+        return find_char_avx2(first, last, ch);
+#endif
+#ifdef SIMD_SSE2
+    return find_char_sse2(first, last, ch);
+#else
+    return find_char_scalar(first, last, ch);
+#endif
+}
+
+template<typename Char>
+inline const Char* rfind_char(const Char* first, const Char* last, Char ch){
+    return rfind_char_scalar(first, last, ch);
+}
+
+inline const char* rfind_char(const char* first, const char* last, char ch){
+#ifdef SIMD_AVX2
+    if(last - first >= 32 && cpu_has_avx2())
+        return rfind_char_avx2(first, last, ch);
+#endif
+#ifdef SIMD_SSE2
+    return rfind_char_sse2(first, last, ch);
+#else
+    return rfind_char_scalar(first, last, ch);
+#endif
+}
+
+template<typename Char>
+inline const Char* find_substring(const Char* hay, SizeType hlen, const Char* needle, SizeType nlen){
+    return find_substring_scalar(hay, hlen, needle, nlen);
+}
+
+inline const char* find_substring(const char* hay, SizeType hlen, const char* needle, SizeType nlen){
+    if(nlen == 0)
+        return hay;
+    if(nlen > hlen)
+        return nullptr;
+    if(nlen == 1)
+        return find_char(hay, hay + hlen, needle[0]);
+    if(nlen > kTwoWayThreshold)
+        return find_substring_two_way(hay, hlen, needle, nlen);
+#ifdef SIMD_AVX2
+    if(hlen - nlen >= 32 && cpu_has_avx2())
+        return find_substring_avx2(hay, hlen, needle, nlen);
+#endif
+#ifdef SIMD_SSE2
+    return find_substring_sse2(hay, hlen, needle, nlen);
+#else
+    return find_substring_scalar(hay, hlen, needle, nlen);
+#endif
+}
+
+template<bool Member, typename Char>
+inline const Char* find_set(const Char* first, const Char* last, const CharSet& set){
+    return find_set_scalar<Member>(first, last, set);
+}
+
+template<bool Member>
+inline const char* find_set(const char* first, const char* last, const CharSet& set){
+#ifdef SIMD_AVX2
+    if(last - first >= 32 && cpu_has_avx2())
+        return find_set_avx2<Member>(first, last, set);
+#endif
+#ifdef SIMD_SSSE3
+    if(last - first >= 16 && cpu_has_ssse3())
+        return find_set_ssse3<Member>(first, last, set);
+#endif
+    return find_set_scalar<Member>(first, last, set);
+}
+
+template<bool Member, typename Char>
+inline const Char* rfind_set(const Char* first, const Char* last, const CharSet& set){
+    return rfind_set_scalar<Member>(first, last, set);
+}
+
+template<bool Member>
+inline const char* rfind_set(const char* first, const char* last, const CharSet& set){
+#ifdef SIMD_AVX2
+    if(last - first >= 32 && cpu_has_avx2())
+        return rfind_set_avx2<Member>(first, last, set);
+#endif
+#ifdef SIMD_SSSE3
+    if(last - first >= 16 && cpu_has_ssse3())
+        return rfind_set_ssse3<Member>(first, last, set);
+#endif
+    return rfind_set_scalar<Member>(first, last, set);
+}
+
+//! Returns the first character that is a member of \a set
+template<typename Char>
+inline const Char* find_any(const Char* first, const Char* last, const CharSet& set){
+    return find_set<true>(first, last, set);
+}
+
+//! Returns the first character that is not a member of \a set
+template<typename Char>
+inline const Char* find_not_any(const Char* first, const Char* last, const CharSet& set){
+    return find_set<false>(first, last, set);
+}
+
+//! Returns the last character that is a member of \a set
+template<typename Char>
+inline const Char* rfind_any(const Char* first, const Char* last, const CharSet& set){
+    return rfind_set<true>(first, last, set);
+}
+
+//! Returns the last character that is not a member of \a set
+template<typename Char>
+inline const Char* rfind_not_any(const Char* first, const Char* last, const CharSet& set){
+    return rfind_set<false>(first, last, set);
+}
+
+//! Index of the first byte where \a a and \a b differ ignoring ASCII case, \a n if none
+inline SizeType mismatch_icase(const char* a, const char* b, SizeType n){
+#ifdef SIMD_SSE2
+    return mismatch_icase_sse2(a, b, n);
+#else
+    return mismatch_icase_scalar(a, b, n);
+#endif
+}
+
+//! A hash of the ASCII lowercase form of the \a n bytes at \a p
+inline uint64_t hash_icase(const char* p, SizeType n){
+#ifdef SIMD_SSE2
+    return hash_icase_sse2(p, n);
+#else
+    return hash_icase_scalar(p, n);
+#endif
+}
+
+//! Returns the last occurrence of the needle that lies entirely in the haystack.
+//! Candidates are located with the vectorized rfind_char on the first byte.
+template<typename Char>
+inline const Char* rfind_substring(const Char* hay, SizeType hlen, const Char* needle, SizeType nlen){
+    if(nlen == 0)
+        return hay + hlen;
+    if(nlen > hlen)
+        return nullptr;
+    const Char* stop = hay + (hlen - nlen) + 1;
+    for(const Char* p; (p = rfind_char(hay, stop, needle[0])) != nullptr; stop = p)
+        if(std::equal(needle + 1, needle + nlen, p + 1))
+            return p;
+    return nullptr;
+}
+
+} // namespace simd
+
+#endif // SIMD_HPP
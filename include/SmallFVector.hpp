@@ -0,0 +1,295 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef SMALLFVECTOR_HPP
+#define SMALLFVECTOR_HPP
+
+#include <new>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include "Config.hpp"
+#include "FVector.hpp"
+
+//! An FVector that keeps its first \a N elements inside the object and
+//! goes to the heap only when it outgrows them, for the many short lists
+//! of a parser: AST children, call arguments, template parameters.
+//! The API and the iterators are FVector's.
+//! NOTE: the inline elements make sizeof depend on T, so unlike FVector,
+//! T must be complete wherever a SmallFVector<T, N> is a member.
+template<typename T, SizeType N>
+class SmallFVector{
+    static_assert(N > 0, "use FVector when nothing should be stored inline");
+
+public:
+    using iterator = typename FVector<T>::iterator;
+    using const_iterator = typename FVector<T>::const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    using value_type = T;
+    using size_type = SizeType;
+    using pointer = value_type*;
+    using reference = value_type&;
+    using const_pointer = const value_type*;
+    using const_reference = const value_type&;
+    using difference_type = std::ptrdiff_t;
+
+    //! Number of elements stored without allocating
+    static constexpr SizeType kInline = N;
+
+    iterator begin() { return iterator(m_data); }
+    const_iterator begin() const { return const_iterator(m_data); }
+    const_iterator cbegin() const { return const_iterator(m_data); }
+
+    iterator end() { return iterator(m_data + m_size); }
+    const_iterator end() const { return const_iterator(m_data + m_size); }
+    const_iterator cend() const { return const_iterator(m_data + m_size); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const { return const_reverse_iterator(end()); }
+
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const { return const_reverse_iterator(begin()); }
+
+    SmallFVector() noexcept {}
+
+    explicit SmallFVector(SizeType sz){
+        resize(sz);
+    }
+
+    SmallFVector(SizeType sz, const T& t){
+        resize(sz, t);
+    }
+
+    SmallFVector(std::initializer_list<T> ls){
+        assign(ls.begin(), ls.end());
+    }
+
+    SmallFVector(const SmallFVector& other){
+        assign(other.begin(), other.end());
+    }
+
+    SmallFVector(SmallFVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        move_from(std::move(other));
+    }
+
+    SmallFVector& operator = (const SmallFVector& other){
+        if(this != &other)
+            assign(other.begin(), other.end());
+        return *this;
+    }
+
+    SmallFVector& operator = (SmallFVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if(this != &other){
+            release();
+            move_from(std::move(other));
+        }
+        return *this;
+    }
+
+    ~SmallFVector() noexcept { release(); }
+
+    inline bool FORCE_INLINE empty() const { return m_size == 0; }
+    inline SizeType FORCE_INLINE size() const { return m_size; }
+    inline SizeType FORCE_INLINE capacity() const { return m_capacity; }
+
+    //! True while the elements live inside the object
+    inline bool FORCE_INLINE is_inline() const { return m_data == local(); }
+
+    inline FORCE_INLINE T& operator [] (SizeType idx){ return m_data[idx]; }
+    inline FORCE_INLINE T const& operator [] (SizeType idx) const { return m_data[idx]; }
+
+    inline FORCE_INLINE T& at(SizeType idx){
+        if(!(idx < m_size))
+            throw std::out_of_range("Invalid Range given");
+        return m_data[idx];
+    }
+
+    inline FORCE_INLINE T const& at(SizeType idx) const {
+        return const_cast<SmallFVector*>(this)->at(idx);
+    }
+
+    T& back(){ return m_data[m_size-1]; }
+    const T& back() const { return m_data[m_size-1]; }
+
+    T& front(){ return m_data[0]; }
+    const T& front() const { return m_data[0]; }
+
+    T* data() noexcept { return m_data; }
+    const T* data() const noexcept { return m_data; }
+
+    void push_back(const T& val){ emplace_back(val); }
+    void push_back(T&& val){ emplace_back(std::move(val)); }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... arg){
+        if(m_size == m_capacity){
+            // \a arg may refer to an element, construct it before moving them
+            T value(std::forward<Args>(arg)...);
+            reserve(m_capacity * 2);
+            new(m_data + m_size) T(std::move(value));
+        }
+        else
+            new(m_data + m_size) T(std::forward<Args>(arg)...);
+        return m_data[m_size++];
+    }
+
+    void pop_back(){
+        m_data[--m_size].~T();
+    }
+
+    void clear() noexcept {
+        destroy(m_data, m_data + m_size);
+        m_size = 0;
+    }
+
+    iterator erase(const_iterator pos){
+        return erase(pos, pos + 1);
+    }
+
+    //! Returns an iterator to the element that followed the erased ones
+    iterator erase(const_iterator first, const_iterator last){
+        T* const from = m_data + (first - cbegin());
+        T* const to = m_data + (last - cbegin());
+        T* const stop = std::move(to, m_data + m_size, from);
+        destroy(stop, m_data + m_size);
+        m_size = static_cast<SizeType>(stop - m_data);
+        return iterator(from);
+    }
+
+    void resize(SizeType sz){
+        reserve(sz);
+        for(SizeType i = m_size; i < sz; i++)
+            new(m_data + i) T();
+        destroy(m_data + std::min(sz, m_size), m_data + m_size);
+        m_size = sz;
+    }
+
+    void resize(SizeType sz, const T& value){
+        if(sz > m_capacity){
+            const T copy(value);
+            reserve(sz);
+            std::uninitialized_fill(m_data + m_size, m_data + sz, copy);
+        }
+        else if(sz > m_size)
+            std::uninitialized_fill(m_data + m_size, m_data + sz, value);
+        destroy(m_data + std::min(sz, m_size), m_data + m_size);
+        m_size = sz;
+    }
+
+    void reserve(SizeType sz){
+        if(sz > m_capacity)
+            relocate(static_cast<T*>(SFAllocator<T>::allocate(sz)), sz);
+    }
+
+    //! Releases the heap buffer, moving back inside when the elements fit
+    void shrink_to_fit(){
+        if(is_inline() || m_size == m_capacity)
+            return;
+        if(m_size <= N)
+            relocate(local(), N);
+        else
+            relocate(static_cast<T*>(SFAllocator<T>::allocate(m_size)), m_size);
+    }
+
+    void assign(size_type count, const T& value){
+        clear();
+        resize(count, value);
+    }
+
+    void assign(std::initializer_list<T> ilist){
+        assign(ilist.begin(), ilist.end());
+    }
+
+    template<class InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+    void assign(InputIt first, InputIt last){
+        clear();
+        for(; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    void swap(SmallFVector& other){
+        if(!is_inline() && !other.is_inline()){
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            std::swap(m_capacity, other.m_capacity);
+            return;
+        }
+        SmallFVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend void swap(SmallFVector& lhs, SmallFVector& rhs){   //for ADL
+        lhs.swap(rhs);
+    }
+
+private:
+    T* m_data = local();
+    SizeType m_capacity = N;
+    SizeType m_size = 0;
+    alignas(T) unsigned char m_inline[sizeof(T) * N];
+
+    inline T* FORCE_INLINE local() const {
+        return reinterpret_cast<T*>(const_cast<unsigned char*>(m_inline));
+    }
+
+    static void destroy(T* first, T* last){
+        for(; first != last; ++first)
+            first->~T();
+    }
+
+    //! Moves the elements to \a data, which holds \a cap, and frees the old heap buffer
+    void relocate(T* data, SizeType cap){
+        for(SizeType i = 0; i < m_size; i++){
+            new(data + i) T(std::move(m_data[i]));
+            m_data[i].~T();
+        }
+        if(!is_inline())
+            SFAllocator<T>::deallocate(m_data);
+        m_data = data;
+        m_capacity = cap;
+    }
+
+    void release() noexcept {
+        clear();
+        if(!is_inline())
+            SFAllocator<T>::deallocate(m_data);
+        m_data = local();
+        m_capacity = N;
+    }
+
+    //! Steals a heap buffer, moves inline elements one by one; \a this is empty and inline
+    void move_from(SmallFVector&& other){
+        if(other.is_inline()){
+            for(SizeType i = 0; i < other.m_size; i++)
+                new(m_data + i) T(std::move(other.m_data[i]));
+            m_size = other.m_size;
+            other.clear();
+            return;
+        }
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        other.m_data = other.local();
+        other.m_size = 0;
+        other.m_capacity = N;
+    }
+};
+
+template<typename T, SizeType N>
+constexpr SizeType SmallFVector<T, N>::kInline;
+
+#endif // SMALLFVECTOR_HPP
@@ -0,0 +1,409 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef SOAVECTOR_HPP
+#define SOAVECTOR_HPP
+
+#include <new>
+#include <tuple>
+#include <limits>
+#include <cstring>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "Config.hpp"
+
+//! A contiguous run of one column of an FSoAVector. Plain pointer and
+//! size, so a loop over it vectorizes as one over an array would.
+template<typename T>
+class FSpan{
+public:
+    using value_type = std::remove_const_t<T>;
+    using size_type = SizeType;
+    using iterator = T*;
+
+    FSpan() = default;
+    FSpan(T* data, SizeType size) : m_data(data), m_size(size) {}
+
+    T* data() const noexcept { return m_data; }
+    SizeType size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+
+    T* begin() const noexcept { return m_data; }
+    T* end() const noexcept { return m_data + m_size; }
+
+    inline T& FORCE_INLINE operator [] (SizeType idx) const { return m_data[idx]; }
+
+private:
+    T* m_data = nullptr;
+    SizeType m_size = 0;
+};
+
+namespace soa_detail {
+
+//! Every column starts on this boundary, so each one can be loaded with
+//! aligned 16 byte SIMD loads
+constexpr std::size_t kColumnAlign = 16;
+
+//! Blocks are allocated in units of one alignment boundary, so the
+//! allocator's 32 bit count reaches far past 4 GiB
+struct alignas(kColumnAlign) ColumnUnit{
+    char bytes[kColumnAlign];
+};
+
+constexpr std::size_t round_up(std::size_t bytes){
+    return (bytes + kColumnAlign - 1) / kColumnAlign * kColumnAlign;
+}
+
+template<typename... Ts>
+struct MaxAlign : std::integral_constant<std::size_t, 1> {};
+
+template<typename T, typename... Ts>
+struct MaxAlign<T, Ts...>
+    : std::integral_constant<std::size_t, (alignof(T) > MaxAlign<Ts...>::value ? alignof(T) : MaxAlign<Ts...>::value)> {};
+
+template<typename... Ts>
+struct Layout;
+
+template<>
+struct Layout<>{
+    static constexpr std::size_t offset(std::size_t, std::size_t){ return 0; }
+    static constexpr std::size_t bytes(std::size_t){ return 0; }
+};
+
+template<typename T, typename... Ts>
+struct Layout<T, Ts...>{
+    //! Byte offset of column \a column in a block holding \a capacity rows
+    static constexpr std::size_t offset(std::size_t column, std::size_t capacity){
+        return column == 0 ? 0 : round_up(sizeof(T) * capacity) + Layout<Ts...>::offset(column - 1, capacity);
+    }
+
+    static constexpr std::size_t bytes(std::size_t capacity){
+        return round_up(sizeof(T) * capacity) + Layout<Ts...>::bytes(capacity);
+    }
+};
+
+template<typename T>
+inline void FORCE_INLINE relocate(T* dest, T* src, SizeType count, std::true_type){
+    if(count)
+        std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), sizeof(T) * count);
+}
+
+template<typename T>
+inline void relocate(T* dest, T* src, SizeType count, std::false_type){
+    for(SizeType i = 0; i < count; i++){
+        new(dest + i) T(std::move(src[i]));
+        src[i].~T();
+    }
+}
+
+template<typename T>
+inline void destroy(T* first, T* last){
+    for(; first != last; ++first)
+        first->~T();
+}
+
+} // namespace soa_detail
+
+/*!
+ * A vector of rows {Ts...} stored as one contiguous column per field, all
+ * in a single allocation. A pass that reads one field streams through that
+ * column alone instead of dragging the whole row through the cache.
+ *
+ * Rows are accessed through tuples of references, v[i] or v.get<I>(i); a
+ * whole column through column<I>(), an FSpan. Like FVector, size and
+ * capacity are 32 bits and the object is a pointer and two counts.
+ *
+ * \note The row proxies are not swappable, so std::sort and friends
+ * cannot permute rows; sort an index column instead.
+ */
+template<typename... Ts>
+class FSoAVector{
+    static_assert(sizeof...(Ts) > 0, "an FSoAVector needs at least one column");
+    static_assert(soa_detail::MaxAlign<Ts...>::value <= soa_detail::kColumnAlign, "columns are aligned to kColumnAlign bytes");
+
+    using Layout = soa_detail::Layout<Ts...>;
+    using Indices = std::index_sequence_for<Ts...>;
+
+    template<std::size_t I>
+    using Column = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    template<bool IsConst>
+    class Iterator{
+    public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::tuple<Ts...>;
+        using reference = std::conditional_t<IsConst, std::tuple<const Ts&...>, std::tuple<Ts&...>>;
+        using pointer = void;
+        using iterator_category = std::random_access_iterator_tag;
+
+        using Owner = std::conditional_t<IsConst, const FSoAVector*, FSoAVector*>;
+
+        Iterator() = default;
+
+        operator Iterator<true> () const { return Iterator<true>(m_owner, m_idx); }
+
+        reference operator * () const { return (*m_owner)[m_idx]; }
+        reference operator [] (std::ptrdiff_t n) const { return (*m_owner)[static_cast<SizeType>(m_idx + n)]; }
+        Iterator& operator ++ () { ++m_idx; return *this; }
+        Iterator operator ++ (int) { Iterator t(*this); ++m_idx; return t; }
+        Iterator& operator -- () { --m_idx; return *this; }
+        Iterator operator -- (int) { Iterator t(*this); --m_idx; return t; }
+        Iterator& operator += (std::ptrdiff_t n) { m_idx = static_cast<SizeType>(m_idx + n); return *this; }
+        Iterator& operator -= (std::ptrdiff_t n) { m_idx = static_cast<SizeType>(m_idx - n); return *this; }
+        Iterator operator + (std::ptrdiff_t n) const { return Iterator(m_owner, static_cast<SizeType>(m_idx + n)); }
+        Iterator operator - (std::ptrdiff_t n) const { return Iterator(m_owner, static_cast<SizeType>(m_idx - n)); }
+        std::ptrdiff_t operator - (const Iterator& other) const { return std::ptrdiff_t(m_idx) - std::ptrdiff_t(other.m_idx); }
+
+        friend bool operator == (const Iterator& lhs, const Iterator& rhs){ return lhs.m_idx == rhs.m_idx; }
+        friend bool operator != (const Iterator& lhs, const Iterator& rhs){ return lhs.m_idx != rhs.m_idx; }
+        friend bool operator <  (const Iterator& lhs, const Iterator& rhs){ return lhs.m_idx < rhs.m_idx; }
+        friend bool operator >  (const Iterator& lhs, const Iterator& rhs){ return lhs.m_idx > rhs.m_idx; }
+        friend bool operator <= (const Iterator& lhs, const Iterator& rhs){ return lhs.m_idx <= rhs.m_idx; }
+        friend bool operator >= (const Iterator& lhs, const Iterator& rhs){ return lhs.m_idx >= rhs.m_idx; }
+
+    private:
+        friend class FSoAVector;
+        Iterator(Owner owner, SizeType idx) : m_owner(owner), m_idx(idx) {}
+
+        Owner m_owner = nullptr;
+        SizeType m_idx = 0;
+    };
+
+public:
+    using value_type = std::tuple<Ts...>;
+    using reference = std::tuple<Ts&...>;
+    using const_reference = std::tuple<const Ts&...>;
+    using size_type = SizeType;
+    using difference_type = std::ptrdiff_t;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    //! Number of columns
+    static constexpr std::size_t kColumns = sizeof...(Ts);
+
+    iterator begin() { return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return const_iterator(this, 0); }
+
+    iterator end() { return iterator(this, m_size); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+    const_iterator cend() const { return const_iterator(this, m_size); }
+
+    FSoAVector() noexcept {}
+
+    explicit FSoAVector(SizeType sz){
+        resize(sz);
+    }
+
+    FSoAVector(const FSoAVector& other){
+        copy_from(other, Indices{});
+    }
+
+    FSoAVector(FSoAVector&& other) noexcept
+        : m_block(other.m_block), m_capacity(other.m_capacity), m_size(other.m_size) {
+        other.m_block = nullptr;
+        other.m_capacity = other.m_size = 0;
+    }
+
+    FSoAVector& operator = (const FSoAVector& other){
+        if(this != &other)
+            FSoAVector(other).swap(*this);
+        return *this;
+    }
+
+    FSoAVector& operator = (FSoAVector&& other) noexcept {
+        FSoAVector(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~FSoAVector() noexcept {
+        clear();
+        SFAllocator<soa_detail::ColumnUnit>::deallocate(m_block);
+    }
+
+    inline bool FORCE_INLINE empty() const { return m_size == 0; }
+    inline SizeType FORCE_INLINE size() const { return m_size; }
+    inline SizeType FORCE_INLINE capacity() const { return m_capacity; }
+
+    //! Column \a I, valid until the next reallocation
+    template<std::size_t I>
+    inline FSpan<Column<I>> FORCE_INLINE column() {
+        return FSpan<Column<I>>(column_data<I>(), m_size);
+    }
+
+    template<std::size_t I>
+    inline FSpan<const Column<I>> FORCE_INLINE column() const {
+        return FSpan<const Column<I>>(const_cast<FSoAVector*>(this)->template column_data<I>(), m_size);
+    }
+
+    template<std::size_t I>
+    inline Column<I>& FORCE_INLINE get(SizeType idx) { return column_data<I>()[idx]; }
+
+    template<std::size_t I>
+    inline const Column<I>& FORCE_INLINE get(SizeType idx) const {
+        return const_cast<FSoAVector*>(this)->template column_data<I>()[idx];
+    }
+
+    inline reference FORCE_INLINE operator [] (SizeType idx) { return row(idx, Indices{}); }
+    inline const_reference FORCE_INLINE operator [] (SizeType idx) const { return const_cast<FSoAVector*>(this)->row(idx, Indices{}); }
+
+    reference at(SizeType idx){
+        if(!(idx < m_size))
+            throw std::out_of_range("Invalid Range given");
+        return (*this)[idx];
+    }
+
+    const_reference at(SizeType idx) const {
+        return const_cast<FSoAVector*>(this)->at(idx);
+    }
+
+    reference front() { return (*this)[0]; }
+    const_reference front() const { return (*this)[0]; }
+    reference back() { return (*this)[m_size - 1]; }
+    const_reference back() const { return (*this)[m_size - 1]; }
+
+    //! Appends a row; the fields are taken by value so they may come from
+    //! this vector
+    void push_back(Ts... fields){
+        if(m_size == m_capacity)
+            reallocate((m_capacity + 1) * 2, Indices{});
+        construct_row(m_size, Indices{}, std::move(fields)...);
+        ++m_size;
+    }
+
+    void push_back(const value_type& row){
+        push_back_tuple(row, Indices{});
+    }
+
+    void pop_back(){
+        --m_size;
+        destroy_rows(m_size, m_size + 1, Indices{});
+    }
+
+    void clear() noexcept {
+        destroy_rows(0, m_size, Indices{});
+        m_size = 0;
+    }
+
+    void reserve(SizeType sz){
+        if(sz > m_capacity)
+            reallocate(sz, Indices{});
+    }
+
+    //! New rows are value-initialized
+    void resize(SizeType sz){
+        reserve(sz);
+        if(sz > m_size)
+            value_initialize(m_size, sz, Indices{});
+        else
+            destroy_rows(sz, m_size, Indices{});
+        m_size = sz;
+    }
+
+    // As FVector, a binding request
+    void shrink_to_fit(){
+        if(m_size < m_capacity)
+            reallocate(m_size, Indices{});
+    }
+
+    void swap(FSoAVector& other) noexcept {
+        std::swap(m_block, other.m_block);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+    }
+
+    friend void swap(FSoAVector& lhs, FSoAVector& rhs) noexcept {   //for ADL
+        lhs.swap(rhs);
+    }
+
+private:
+    char* m_block = nullptr;
+    SizeType m_capacity = 0;
+    SizeType m_size = 0;
+
+    template<std::size_t I>
+    inline Column<I>* FORCE_INLINE column_data() {
+        return column_in<I>(m_block, m_capacity);
+    }
+
+    template<std::size_t I>
+    static inline Column<I>* FORCE_INLINE column_in(char* block, SizeType capacity) {
+        return reinterpret_cast<Column<I>*>(block + Layout::offset(I, capacity));
+    }
+
+    template<std::size_t... I>
+    inline reference FORCE_INLINE row(SizeType idx, std::index_sequence<I...>) {
+        return reference(column_data<I>()[idx]...);
+    }
+
+    template<typename... Args, std::size_t... I>
+    void construct_row(SizeType idx, std::index_sequence<I...>, Args&&... fields){
+        using expand = int[];
+        (void)expand{ 0, (new(column_data<I>() + idx) Column<I>(std::forward<Args>(fields)), 0)... };
+    }
+
+    template<std::size_t... I>
+    void push_back_tuple(const value_type& row, std::index_sequence<I...>){
+        push_back(std::get<I>(row)...);
+    }
+
+    template<std::size_t... I>
+    void value_initialize(SizeType first, SizeType last, std::index_sequence<I...>){
+        for(SizeType i = first; i < last; i++)
+            construct_row(i, std::index_sequence<I...>{}, Ts()...);
+    }
+
+    template<std::size_t... I>
+    void destroy_rows(SizeType first, SizeType last, std::index_sequence<I...>){
+        using expand = int[];
+        (void)expand{ 0, (soa_detail::destroy(column_data<I>() + first, column_data<I>() + last), 0)... };
+    }
+
+    //! Every column size is rounded to kColumnAlign, so the block is a whole
+    //! number of ColumnUnits; it throws rather than truncate the count
+    static void* allocate_block(SizeType cap){
+        const std::size_t units = Layout::bytes(cap) / soa_detail::kColumnAlign;
+        if(units > std::numeric_limits<SizeType>::max())
+            throw std::length_error("FSoAVector: block too large");
+        return SFAllocator<soa_detail::ColumnUnit>::allocate(static_cast<SizeType>(units));
+    }
+
+    //! Moves every column into one new block holding \a cap rows
+    template<std::size_t... I>
+    void reallocate(SizeType cap, std::index_sequence<I...>){
+        char* block = cap ? static_cast<char*>(allocate_block(cap)) : nullptr;
+        using expand = int[];
+        (void)expand{ 0, (soa_detail::relocate(column_in<I>(block, cap), column_data<I>(), m_size,
+                                               IsTriviallyRelocatable<Column<I>>{}), 0)... };
+        SFAllocator<soa_detail::ColumnUnit>::deallocate(m_block);
+        m_block = block;
+        m_capacity = cap;
+    }
+
+    template<std::size_t... I>
+    void copy_from(const FSoAVector& other, std::index_sequence<I...>){
+        reserve(other.m_size);
+        for(SizeType i = 0; i < other.m_size; i++)
+            construct_row(i, Indices{}, other.template get<I>(i)...);
+        m_size = other.m_size;
+    }
+};
+
+template<typename... Ts>
+constexpr std::size_t FSoAVector<Ts...>::kColumns;
+
+template<typename... Ts>
+struct IsTriviallyRelocatable<FSoAVector<Ts...>> : std::true_type {};
+
+#endif // SOAVECTOR_HPP
@@ -13,14 +13,198 @@
 #ifndef STRING_H
 #define STRING_H
 #include "Config.hpp"
+#include "Simd.hpp"
+#include "NumberFormat.hpp"
 #include <cstring>
+#include <string>
 #include <utility>
 #include <ostream>
 #include <istream>
+#include <locale>
+#include <limits>
+#include <streambuf>
 #include <cassert>
 #include <type_traits>
+#include <functional>
 
+//! A non owning, read-only window into a sequence of characters.
+//! Views are what the lookup and scanning APIs hand out, hence they never allocate.
+//! NOTE: a view is not necessarily NULL terminated
 template<typename Char>
+class Basic_fstring_view
+{
+    public:
+
+    using value_type = Char;
+    using size_type = SizeType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+    using const_pointer = const value_type*;
+    using const_reference = const value_type&;
+
+    using iterator = const value_type*;
+    using const_iterator = const value_type*;
+    using reverse_iterator = std::reverse_iterator<const_iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        //Defined as  static_cast<size_type>(-1);
+        static const size_type npos;
+
+        constexpr Basic_fstring_view() noexcept = default;
+
+        constexpr Basic_fstring_view(const Char* data, size_type size) noexcept
+            : m_data(data), m_size(size) {}
+
+        //! Views a string literal, the terminating NULL is not part of the view
+        template<SizeType N>
+        constexpr Basic_fstring_view(const Char (&data)[N]) noexcept
+            : m_data(data), m_size(N - 1) {}
+
+        //! NOTE: the string must be NULL terminated, else, the behavior is Undefined
+        template<typename T, std::enable_if_t<std::is_same<T, const Char*>::value>* = nullptr>
+        explicit Basic_fstring_view(const T ch)
+            : m_data(ch), m_size(static_cast<size_type>(std::char_traits<Char>::length(ch))) {}
+
+        Basic_fstring_view(const std::basic_string<Char>& str) noexcept
+            : m_data(str.data()), m_size(static_cast<size_type>(str.size())) {}
+
+        constexpr const Char* data() const noexcept { return m_data; }
+        constexpr size_type size() const noexcept { return m_size; }
+        constexpr size_type length() const noexcept { return m_size; }
+        constexpr bool empty() const noexcept { return m_size == 0; }
+
+        constexpr const Char& operator [] (size_type idx) const { return m_data[idx]; }
+        constexpr const Char& front() const { return m_data[0]; }
+        constexpr const Char& back() const { return m_data[m_size - 1]; }
+
+        constexpr const_iterator begin() const noexcept { return m_data; }
+        constexpr const_iterator cbegin() const noexcept { return m_data; }
+        constexpr const_iterator end() const noexcept { return m_data + m_size; }
+        constexpr const_iterator cend() const noexcept { return m_data + m_size; }
+
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+        inline std::basic_string<Char> to_string() const {
+            return std::basic_string<Char>(m_data, m_size);
+        }
+
+        void remove_prefix(size_type n){
+            assert(n <= m_size && "cannot remove more than the size of this view!");
+            m_data += n;
+            m_size -= n;
+        }
+
+        void remove_suffix(size_type n){
+            assert(n <= m_size && "cannot remove more than the size of this view!");
+            m_size -= n;
+        }
+
+        Basic_fstring_view substr(size_type pos, size_type count = npos) const {
+            assert(pos <= m_size && "starting index must be less than the size of this view!");
+            count = (count > m_size - pos) ? m_size - pos : count;
+            return Basic_fstring_view(m_data + pos, count);
+        }
+
+        size_type find(Basic_fstring_view str, size_type pos = 0) const {
+            if(pos > m_size)
+                return npos;
+            const Char* found = simd::find_substring(m_data + pos, m_size - pos, str.m_data, str.m_size);
+            return found ? static_cast<size_type>(found - m_data) : npos;
+        }
+
+        size_type find(Char ch, size_type pos = 0) const {
+            if(pos >= m_size)
+                return npos;
+            const Char* found = simd::find_char(m_data + pos, m_data + m_size, ch);
+            return found ? static_cast<size_type>(found - m_data) : npos;
+        }
+
+        size_type rfind(Basic_fstring_view str, size_type pos = npos) const {
+            if(str.m_size > m_size)
+                return npos;
+            const size_type last_start = std::min(pos, m_size - str.m_size);
+            const Char* found = simd::rfind_substring(m_data, last_start + str.m_size, str.m_data, str.m_size);
+            return found ? static_cast<size_type>(found - m_data) : npos;
+        }
+
+        size_type rfind(Char ch, size_type pos = npos) const {
+            const size_type stop = pos >= m_size ? m_size : (pos + 1);
+            const Char* found = simd::rfind_char(m_data, m_data + stop, ch);
+            return found ? static_cast<size_type>(found - m_data) : npos;
+        }
+
+        bool starts_with(Basic_fstring_view str) const {
+            return str.m_size <= m_size && std::char_traits<Char>::compare(m_data, str.m_data, str.m_size) == 0;
+        }
+
+        bool ends_with(Basic_fstring_view str) const {
+            return str.m_size <= m_size &&
+                    std::char_traits<Char>::compare(m_data + m_size - str.m_size, str.m_data, str.m_size) == 0;
+        }
+
+        inline static int compare(Basic_fstring_view lhs, Basic_fstring_view rhs) noexcept {
+            const size_type len = lhs.m_size < rhs.m_size ? lhs.m_size : rhs.m_size;
+            const int rtn = len ? std::char_traits<Char>::compare(lhs.m_data, rhs.m_data, len) : 0;
+            if(rtn != 0)
+                return rtn;
+            return lhs.m_size == rhs.m_size ? 0 : (lhs.m_size < rhs.m_size ? -1 : 1);
+        }
+
+        inline static bool equals(Basic_fstring_view lhs, Basic_fstring_view rhs) noexcept {
+            return lhs.m_size == rhs.m_size &&
+                    (lhs.m_size == 0 || std::memcmp(lhs.m_data, rhs.m_data, lhs.m_size * sizeof(Char)) == 0);
+        }
+
+    private:
+        const Char* m_data = nullptr;
+        size_type m_size = 0;
+};
+
+template<typename Char>
+const typename Basic_fstring_view<Char>::size_type Basic_fstring_view<Char>::npos = static_cast<size_type>(-1);
+
+template<typename Char, typename Lhs, typename Rhs>
+class Basic_fstring_concat;
+
+namespace concat_detail {
+
+template<typename T, typename Char>
+struct Piece;
+
+template<typename Char>
+inline SizeType FORCE_INLINE piece_size(Basic_fstring_view<Char> str){ return str.size(); }
+
+template<typename Char>
+inline SizeType FORCE_INLINE piece_size(Char){ return 1; }
+
+template<typename Char, typename Lhs, typename Rhs>
+inline SizeType FORCE_INLINE piece_size(const Basic_fstring_concat<Char, Lhs, Rhs>& expr){ return expr.size(); }
+
+template<typename Char>
+inline Char* FORCE_INLINE write_piece(Char* out, Basic_fstring_view<Char> str){
+    if(str.size())
+        std::memcpy(out, str.data(), sizeof(Char) * str.size());
+    return out + str.size();
+}
+
+template<typename Char>
+inline Char* FORCE_INLINE write_piece(Char* out, Char ch){
+    *out = ch;
+    return out + 1;
+}
+
+template<typename Char, typename Lhs, typename Rhs>
+inline Char* FORCE_INLINE write_piece(Char* out, const Basic_fstring_concat<Char, Lhs, Rhs>& expr){
+    return expr.write(out);
+}
+
+} // namespace concat_detail
+
+template<typename Char, typename Allocator = SFAllocator<Char>>
 class Basic_fstring
 {
     public:
@@ -65,6 +249,27 @@ class Basic_fstring
             copy_construct_from(str.c_str(), str.size()+1);
         }
 
+        //! Constructs a String from a view, which need not be NULL terminated
+        explicit Basic_fstring(Basic_fstring_view<Char> view){
+            construct_from_view(view.data(), view.size());
+        }
+
+        //! Materializes a concatenation expression with one allocation, none
+        //! if the result fits the SSO buffer
+        template<typename Lhs, typename Rhs>
+        Basic_fstring(const Basic_fstring_concat<Char, Lhs, Rhs>& expr){
+            const SizeType len = expr.size();
+            m_size = len;
+            Char* dest = m_data.local;
+            if(len >= kSS){
+                m_capacity = len;
+                m_data.heap = static_cast<Char*>(Allocator::allocate(len+1));
+                dest = m_data.heap;
+            }
+            expr.write(dest);
+            dest[len] = '\0';
+        }
+
         FORCE_INLINE ~Basic_fstring() { destroy(); }
 
         Basic_fstring(const Basic_fstring& other){
@@ -104,6 +309,14 @@ class Basic_fstring
             return data();
         }
 
+        inline FORCE_INLINE operator Basic_fstring_view<Char> () const {
+            return Basic_fstring_view<Char>(get_pointer(), m_size);
+        }
+
+        inline FORCE_INLINE Basic_fstring_view<Char> view() const {
+            return Basic_fstring_view<Char>(get_pointer(), m_size);
+        }
+
         inline FORCE_INLINE std::basic_string<Char> to_string() const {
             return empty() ? std::basic_string<Char>() : std::basic_string<Char>(data());
         }
@@ -124,13 +337,238 @@ class Basic_fstring
             return m_size == 0;
         }
 
+        //! Number of characters that fit without reallocating
+        inline FORCE_INLINE SizeType capacity() const {
+            return m_capacity ? m_capacity : kSS - 1;
+        }
+
+        //! Empties the string but keeps its buffer for reuse
         void FORCE_INLINE clear() noexcept {
-            destroy();
+            m_size = 0;
+            get_pointer()[0] = '\0';
+        }
+
+        void reserve(SizeType sz){
+            if(sz > capacity())
+                reallocate(sz);
+        }
+
+        //! Lets \a op write straight into the buffer, like C++23's
+        //! resize_and_overwrite: op(Char* data, SizeType count) may fill the
+        //! first \a count characters and returns the new size. The current
+        //! characters are kept, so appending writers start at data + size().
+        template<typename Operation>
+        void resize_and_overwrite(SizeType count, Operation op){
+            if(count > capacity())
+                reallocate(count);
+            Char* p = get_pointer();
+            m_size = op(p, count);
+            p[m_size] = '\0';
+        }
+
+        void push_back(Char ch){
+            if(m_size == capacity())
+                reallocate(grown_capacity(m_size + 1));
+            Char* p = get_pointer();
+            p[m_size++] = ch;
+            p[m_size] = '\0';
+        }
+
+        Basic_fstring& append(const Char* ch, SizeType len){
+            if(m_size + len > capacity())
+                reallocate(grown_capacity(m_size + len));
+            Char* p = get_pointer();
+            if(len)
+                std::memcpy(p + m_size, ch, sizeof(Char)*len);
+            m_size += len;
+            p[m_size] = '\0';
+            return *this;
+        }
+
+        Basic_fstring& append(Basic_fstring_view<Char> str){
+            return append(str.data(), str.size());
+        }
+
+        //! Replaces the \a count characters at \a pos, fewer if the string ends
+        //! first, with \a str. Within the capacity the tail is moved in place,
+        //! otherwise the result is assembled in one new buffer. \a str may
+        //! refer to this very string.
+        Basic_fstring& replace(SizeType pos, SizeType count, Basic_fstring_view<Char> str){
+            assert(pos <= m_size && "starting index must be less than the size of this string!");
+            count = std::min(count, m_size - pos);
+            const SizeType len = m_size - count + str.size();
+            const SizeType tail = m_size - pos - count + 1;
+            Char* p = get_pointer();
+            if(len > capacity()){
+                const SizeType cap = grown_capacity(len);
+                Char* data = static_cast<Char*>(Allocator::allocate(cap+1));
+                std::memcpy(data, p, sizeof(Char)*pos);
+                std::memcpy(data + pos, str.data(), sizeof(Char)*str.size());
+                std::memcpy(data + pos + str.size(), p + pos + count, sizeof(Char)*tail);
+                if(m_capacity)
+                    Allocator::deallocate(m_data.heap);
+                m_data.heap = data;
+                m_capacity = cap;
+            }
+            else{
+                if(overlaps(str))
+                    return replace(pos, count, Basic_fstring(str));
+                std::memmove(p + pos + str.size(), p + pos + count, sizeof(Char)*tail);
+                if(str.size())
+                    std::memcpy(p + pos, str.data(), sizeof(Char)*str.size());
+            }
+            m_size = len;
+            return *this;
+        }
+
+        Basic_fstring& insert(SizeType pos, Basic_fstring_view<Char> str){
+            return replace(pos, 0, str);
+        }
+
+        Basic_fstring& insert(SizeType pos, Char ch){
+            return replace(pos, 0, Basic_fstring_view<Char>(&ch, 1));
+        }
+
+        //! Removes \a count characters at \a pos, never reallocates
+        Basic_fstring& erase(SizeType pos = 0, SizeType count = npos){
+            return replace(pos, count, Basic_fstring_view<Char>());
+        }
+
+        //! Replaces every occurrence of \a from, scanning left to right without
+        //! overlaps, with \a to; returns the number replaced. When \a to is not
+        //! longer the rewrite happens in place. Otherwise a first search pass
+        //! counts the occurrences, and the result is rewritten in place if it
+        //! fits the capacity, else written into exactly one new buffer.
+        SizeType replace_all(Basic_fstring_view<Char> from, Basic_fstring_view<Char> to){
+            if(from.empty() || from.size() > m_size)
+                return 0;
+            if(overlaps(from) || overlaps(to)){
+                const Basic_fstring from_copy(from), to_copy(to);
+                return replace_all(from_copy.view(), to_copy.view());
+            }
+            Char* const p = get_pointer();
+            const Char* const end = p + m_size;
+            const Char* in = p;
+            SizeType n = 0;
+            if(to.size() <= from.size()){
+                // The write position never passes the read position
+                Char* out = p;
+                while(const Char* hit = simd::find_substring(in, static_cast<SizeType>(end - in), from.data(), from.size())){
+                    std::memmove(out, in, sizeof(Char)*(hit - in));
+                    out += hit - in;
+                    if(to.size())
+                        std::memcpy(out, to.data(), sizeof(Char)*to.size());
+                    out += to.size();
+                    in = hit + from.size();
+                    n++;
+                }
+                if(n == 0)
+                    return 0;
+                std::memmove(out, in, sizeof(Char)*(end - in + 1));
+                m_size = static_cast<SizeType>(out + (end - in) - p);
+                return n;
+            }
+
+            while((in = simd::find_substring(in, static_cast<SizeType>(end - in), from.data(), from.size()))){
+                in += from.size();
+                n++;
+            }
+            if(n == 0)
+                return 0;
+            const SizeType len = m_size + n * (to.size() - from.size());
+            if(len <= capacity()){
+                // Slide the characters to the end of the buffer, then rewrite
+                // them from the front: the output only catches up with the
+                // input once the last occurrence is replaced
+                Char* const src = p + (len - m_size);
+                std::memmove(src, p, sizeof(Char)*(m_size + 1));
+                const Char* const src_end = src + m_size;
+                Char* out = p;
+                in = src;
+                while(const Char* hit = simd::find_substring(in, static_cast<SizeType>(src_end - in), from.data(), from.size())){
+                    std::memmove(out, in, sizeof(Char)*(hit - in));
+                    out += hit - in;
+                    std::memcpy(out, to.data(), sizeof(Char)*to.size());
+                    out += to.size();
+                    in = hit + from.size();
+                }
+                m_size = len;
+                return n;
+            }
+            const SizeType cap = grown_capacity(len);
+            Char* const data = static_cast<Char*>(Allocator::allocate(cap+1));
+            Char* out = data;
+            in = p;
+            while(const Char* hit = simd::find_substring(in, static_cast<SizeType>(end - in), from.data(), from.size())){
+                std::memcpy(out, in, sizeof(Char)*(hit - in));
+                out += hit - in;
+                std::memcpy(out, to.data(), sizeof(Char)*to.size());
+                out += to.size();
+                in = hit + from.size();
+            }
+            std::memcpy(out, in, sizeof(Char)*(end - in + 1));
+            if(m_capacity)
+                Allocator::deallocate(m_data.heap);
+            m_data.heap = data;
+            m_capacity = cap;
+            m_size = len;
+            return n;
+        }
+
+        //! Appends a string, view, literal, character or a whole concatenation
+        //! expression, growing the buffer at most once. The pieces may refer
+        //! to this very string.
+        template<typename T, typename Piece = concat_detail::Piece<T, Char>, typename = typename Piece::type>
+        Basic_fstring& operator += (const T& piece){
+            const auto value = Piece::make(piece);
+            const SizeType len = concat_detail::piece_size(value);
+            if(m_size + len > capacity()){
+                // Write before releasing the old buffer, the pieces may live in it
+                const SizeType cap = grown_capacity(m_size + len);
+                Char* data = static_cast<Char*>(Allocator::allocate(cap+1));
+                std::memcpy(data, get_pointer(), sizeof(Char)*m_size);
+                concat_detail::write_piece(data + m_size, value);
+                if(m_capacity)
+                    Allocator::deallocate(m_data.heap);
+                m_data.heap = data;
+                m_capacity = cap;
+            }
+            else
+                concat_detail::write_piece(get_pointer() + m_size, value);
+            m_size += len;
+            get_pointer()[m_size] = '\0';
+            return *this;
+        }
+
+        //! Appends the decimal form of an integer, see format_number
+        template<typename T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>* = nullptr>
+        Basic_fstring& append_number(T value){
+            return append_formatted(value);
+        }
+
+        //! Appends the shortest decimal that parses back to \a value;
+        //! a float is written as the double it promotes to
+        Basic_fstring& append_number(double value){
+            return append_formatted(value);
+        }
+
+        template<typename T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>* = nullptr>
+        static Basic_fstring from_integer(T value){
+            Basic_fstring str;
+            str.append_formatted(value);
+            return str;
+        }
+
+        static Basic_fstring from_double(double value){
+            Basic_fstring str;
+            str.append_formatted(value);
+            return str;
         }
 
         void swap(Basic_fstring& other){
             std::swap(m_data, other.m_data);
             std::swap(m_size, other.m_size);
+            std::swap(m_capacity, other.m_capacity);
         }
 
         Basic_fstring substr(size_type pos, size_type count = npos) const {
@@ -163,77 +601,54 @@ class Basic_fstring
             return temp;
         }
 
+        //! Substring search, vectorized for char strings (see Simd.hpp)
         size_type find(const Basic_fstring& str, size_type pos = 0) const {
-            for(unsigned i = pos; i < size(); i++){
-                unsigned j = 0;
-                for(; j < str.size() && (i+j) < size(); j++)
-                    if(operator [](i+j) != str[j])
-                        break;
-                if(j == str.size())
-                    return i;
-            }
-            return npos;
+            const auto string_size = size();
+            if(pos >= string_size)
+                return npos;
+            const Char* base = get_pointer();
+            const Char* found = simd::find_substring(base + pos, string_size - pos, str.data(), str.size());
+            return found ? static_cast<size_type>(found - base) : npos;
         }
 
         FORCE_INLINE size_type find(Char ch, size_type pos = 0) const {
-            for(unsigned i = pos; i < size(); i++)
-                if(operator [](i) == ch)
-                    return i;
-            return npos;
+            const auto string_size = size();
+            if(pos >= string_size)
+                return npos;
+            const Char* base = get_pointer();
+            const Char* found = simd::find_char(base + pos, base + string_size, ch);
+            return found ? static_cast<size_type>(found - base) : npos;
         }
 
+        //! Finds the last occurrence of \a str starting at or before \a pos
         size_type rfind(const Basic_fstring& str, size_type pos = npos) const {
-            if(size() == 0 || str.size() == 0) return npos;
-            pos = pos == npos ? size() : (pos + 1);
-            for(unsigned i = pos - 1; ; i--){
-                unsigned j = str.size() - 1;
-                for(unsigned q = 0; i >= j; j--, q++){
-                    if(operator [](i-q) != str[j])
-                        break;
-                    if(j == 0)
-                        return (i - q);
-                }
-                 if(i == 0)
-                     break;
-            }
-            return npos;
+            const auto string_size = size();
+            if(string_size == 0 || str.size() == 0 || str.size() > string_size) return npos;
+            const size_type last_start = std::min(pos, string_size - str.size());
+            const Char* base = get_pointer();
+            const Char* found = simd::rfind_substring(base, last_start + str.size(), str.data(), str.size());
+            return found ? static_cast<size_type>(found - base) : npos;
         }
 
         FORCE_INLINE size_type rfind(Char ch, size_type pos = npos) const {
-            if(size() == 0) return npos;
-            pos = pos == npos ? size() : (pos + 1);
-            for(unsigned i = pos - 1; ; i--){
-                if(operator [](i) == ch)
-                    return i;
-                if(i == 0)
-                    break;
-            }
-            return npos;
+            const auto string_size = size();
+            if(string_size == 0) return npos;
+            const size_type stop = pos >= string_size ? string_size : (pos + 1);
+            const Char* base = get_pointer();
+            const Char* found = simd::rfind_char(base, base + stop, ch);
+            return found ? static_cast<size_type>(found - base) : npos;
         }
 
+        //! Lexicographic, a proper prefix orders first
         inline static int FORCE_INLINE compare(Basic_fstring const& lhs, Basic_fstring const& rhs) noexcept {
-            if(lhs.m_size < kSS){
-                if(rhs.m_size < kSS)
-                    return std::strncmp(static_cast<const Char*>(lhs.m_data.local),
-                                        static_cast<const Char*>(rhs.m_data.local),
-                                        lhs.m_size < rhs.m_size ? lhs.m_size : rhs.m_size);
-                else
-                    return std::strncmp(static_cast<const Char*>(lhs.m_data.local),
-                                        rhs.m_data.heap, rhs.m_size);
-            }
-            else
-                if(rhs.m_size < kSS)
-                    return std::strncmp(lhs.m_data.heap, static_cast<const Char*>(rhs.m_data.local),
-                                        lhs.m_size);
-            return std::strncmp(lhs.m_data.heap, rhs.m_data.heap,
-                                lhs.m_size < rhs.m_size ? lhs.m_size : rhs.m_size);
+            return Basic_fstring_view<Char>::compare(lhs.view(), rhs.view());
         }
 
         template<Char> friend
-        std::basic_istream<Char>& operator >> (std::basic_istream<Char>&, Basic_fstring<Char>&);
+        std::basic_istream<Char>& operator >> (std::basic_istream<Char>&, Basic_fstring&);
 
         template<Char> friend
-        std::basic_ostream<Char>& operator << (std::basic_ostream<Char>&, Basic_fstring<Char> const&);
+        std::basic_ostream<Char>& operator << (std::basic_ostream<Char>&, Basic_fstring const&);
 
         template<Char> friend void swap(Basic_fstring&, Basic_fstring&);
 
@@ -246,41 +661,102 @@ class Basic_fstring
         Data m_data;
         SizeType m_size = 0;
 
+        //! Characters the heap buffer can hold, excluding the NULL terminator.
+        //! Zero while the characters live in m_data.local; it occupies what would
+        //! otherwise be padding, so the footprint is unchanged.
+        SizeType m_capacity = 0;
+
         inline FORCE_INLINE Char* get_pointer() const {
-            return m_size < kSS ? const_cast<Char*>(static_cast<const Char*>(m_data.local)) : m_data.heap;
+            return m_capacity == 0 ? const_cast<Char*>(static_cast<const Char*>(m_data.local)) : m_data.heap;
+        }
+
+        //! True if \a str views characters of this string, its terminator included
+        inline FORCE_INLINE bool overlaps(Basic_fstring_view<Char> str) const {
+            const Char* p = get_pointer();
+            return str.size() && !std::less<const Char*>()(str.data(), p) && std::less<const Char*>()(str.data(), p + m_size + 1);
         }
 
         inline FORCE_INLINE void move_from(Basic_fstring&& other){
             m_data = other.m_data;
             m_size = other.m_size;
+            m_capacity = other.m_capacity;
             other.m_size = 0;
+            other.m_capacity = 0;
+            other.m_data.local[0] = '\0';
         }
         inline FORCE_INLINE void copy_from(const Basic_fstring& other){
-            if(other.m_size >= kSS){
-                m_size = other.m_size; //Something here
-                m_data.heap = static_cast<Char*>(operator new (sizeof(Char) * (other.m_size+1)));// new Char[other.m_size+1];
-                std::memcpy(m_data.heap, other.m_data.heap, other.m_size+1);
-            }
-            else{
-                m_data = other.m_data;
-                m_size = other.m_size;
-            }
+            copy_construct_from(other.get_pointer(), other.m_size+1);
+        }
+
+        //! Grows by at least a factor of 1.5 to keep appends amortized O(1)
+        inline FORCE_INLINE SizeType grown_capacity(SizeType required) const {
+            const SizeType grown = capacity() + capacity() / 2;
+            return required > grown ? required : grown;
+        }
+
+        //! Moves the characters to a heap buffer that can hold \a cap characters
+        void reallocate(SizeType cap){
+            Char* data = static_cast<Char*>(Allocator::allocate(cap+1));
+            std::memcpy(data, get_pointer(), sizeof(Char)*(m_size+1));
+            if(m_capacity)
+                Allocator::deallocate(m_data.heap);
+            m_data.heap = data;
+            m_capacity = cap;
         }
 
         inline FORCE_INLINE void copy_construct_from(const Char* ch, SizeType sz){
             m_size = sz - 1;
-            if(sz < kSS)
+            if(sz <= kSS)
                 std::memcpy(&m_data.local, ch, sizeof(Char)*sz);
             else{
-                m_data.heap = static_cast<Char*>(operator new (sizeof(Char) * sz));
+                m_capacity = sz - 1;
+                m_data.heap = static_cast<Char*>(Allocator::allocate(sz));
                 std::memcpy(m_data.heap, ch, sizeof(Char)*sz);
             }
         }
 
+        //! copies \a len characters and terminates the string
+        inline FORCE_INLINE void construct_from_view(const Char* ch, SizeType len){
+            m_size = len;
+            Char* dest = m_data.local;
+            if(len >= kSS){
+                m_capacity = len;
+                m_data.heap = static_cast<Char*>(Allocator::allocate(len+1));
+                dest = m_data.heap;
+            }
+            if(len)
+                std::memcpy(dest, ch, sizeof(Char)*len);
+            dest[len] = '\0';
+        }
+
+        //! Formats straight into the buffer when it has room for any number,
+        //! otherwise through a small stack buffer so growth stays exact
+        template<typename T>
+        Basic_fstring& append_formatted(T value){
+            char buffer[kMaxNumberChars];
+            const bool in_place = std::is_same<Char, char>::value && capacity() - m_size >= SizeType(kMaxNumberChars);
+            char* const first = in_place ? reinterpret_cast<char*>(get_pointer() + m_size) : buffer;
+            const SizeType len = static_cast<SizeType>(format_number(first, value) - first);
+            if(in_place){
+                m_size += len;
+                get_pointer()[m_size] = '\0';
+                return *this;
+            }
+            if(m_size + len > capacity())
+                reallocate(grown_capacity(m_size + len));
+            Char* p = get_pointer();
+            for(SizeType i = 0; i < len; i++)
+                p[m_size + i] = static_cast<Char>(buffer[i]);
+            m_size += len;
+            p[m_size] = '\0';
+            return *this;
+        }
+
         void FORCE_INLINE destroy() noexcept {
-            if(!(m_size < kSS))
-                delete m_data.heap;
+            if(m_capacity)
+                Allocator::deallocate(m_data.heap);
             m_size = 0;
+            m_capacity = 0;
         }
 
         struct detail {
@@ -325,7 +801,7 @@ class Basic_fstring
                 friend bool operator >=  (const iterator& lhs, const iterator& rhs){ return (lhs.ptr - rhs.ptr) >= 0; }
                 friend bool operator <=  (const iterator& lhs, const iterator& rhs){ return (rhs.ptr - lhs.ptr) >= 0; }
             private:
-                friend class Basic_fstring<Char>;
+                friend class Basic_fstring;
                 pointer ptr = nullptr;
             };
         };
@@ -357,90 +833,492 @@ class Basic_fstring
 
 };
 
-template<typename Char>
-const typename Basic_fstring<Char>::size_type Basic_fstring<Char>::npos = static_cast<size_type>(-1);
+template<typename Char, typename Allocator>
+const typename Basic_fstring<Char, Allocator>::size_type Basic_fstring<Char, Allocator>::npos = static_cast<size_type>(-1);
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator == (const Basic_fstring<Char, Allocator>& lhs, const Basic_fstring<Char, Allocator>& rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator, SizeType N> inline FORCE_INLINE
+bool operator == (const Basic_fstring<Char, Allocator>& lhs, const Char (&rhs)[N]){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator, SizeType N> inline FORCE_INLINE
+bool operator == (const Char (&lhs)[N], const Basic_fstring<Char, Allocator>& rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator != (Basic_fstring<Char, Allocator> const& lhs, Basic_fstring<Char, Allocator> const& rhs){
+    return !(lhs == rhs);
+}
+
+template<typename Char, typename Allocator, SizeType N> inline FORCE_INLINE
+bool operator != (const Basic_fstring<Char, Allocator>& lhs, const Char (&rhs)[N]){
+    return !(lhs == rhs);
+}
+
+template<typename Char, typename Allocator, SizeType N> inline FORCE_INLINE
+bool operator != (const Char (&lhs)[N], const Basic_fstring<Char, Allocator>& rhs){
+    return !(lhs == rhs);
+}
+
+template<typename Char, typename Allocator> inline
+bool operator < (Basic_fstring<Char, Allocator> const& lhs, Basic_fstring<Char, Allocator> const& rhs){
+    return Basic_fstring<Char, Allocator>::compare(lhs, rhs) < 0;
+}
+
+template<typename Char, typename Allocator> inline
+bool operator <= (Basic_fstring<Char, Allocator> const& lhs, Basic_fstring<Char, Allocator> const& rhs){
+    return Basic_fstring<Char, Allocator>::compare(lhs, rhs) <= 0;
+}
+
+template<typename Char, typename Allocator> inline
+bool operator > (Basic_fstring<Char, Allocator> const& lhs, Basic_fstring<Char, Allocator> const& rhs){
+    return Basic_fstring<Char, Allocator>::compare(lhs, rhs) > 0;
+}
+
+template<typename Char, typename Allocator> inline
+bool operator >= (Basic_fstring<Char, Allocator> const& lhs, Basic_fstring<Char, Allocator> const& rhs){
+    return Basic_fstring<Char, Allocator>::compare(lhs, rhs) >= 0;
+}
 
 template<typename Char> inline FORCE_INLINE
-bool operator == (const Basic_fstring<Char>& lhs, const Basic_fstring<Char>& rhs){
-    return Basic_fstring<Char>::compare(lhs, rhs) == 0;
+bool operator == (Basic_fstring_view<Char> lhs, Basic_fstring_view<Char> rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
 }
 
-template<typename Char, SizeType N> inline FORCE_INLINE
-bool operator == (const Basic_fstring<Char>& lhs, const Char (&rhs)[N]){
-    return Basic_fstring<Char>::compare(lhs, rhs) == 0;
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator == (const Basic_fstring<Char, Allocator>& lhs, Basic_fstring_view<Char> rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator == (Basic_fstring_view<Char> lhs, const Basic_fstring<Char, Allocator>& rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
 }
 
 template<typename Char, SizeType N> inline FORCE_INLINE
-bool operator == (const Char (&lhs)[N], const Basic_fstring<Char>& rhs){
-    return Basic_fstring<Char>::compare(lhs, rhs) == 0;
+bool operator == (Basic_fstring_view<Char> lhs, const Char (&rhs)[N]){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
 }
 
 template<typename Char> inline FORCE_INLINE
-bool operator != (Basic_fstring<Char> const& lhs, Basic_fstring<Char> const& rhs){
+bool operator != (Basic_fstring_view<Char> lhs, Basic_fstring_view<Char> rhs){
     return !(lhs == rhs);
 }
 
-template<typename Char, SizeType N> inline FORCE_INLINE
-bool operator != (const Basic_fstring<Char>& lhs, const Char (&rhs)[N]){
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator != (const Basic_fstring<Char, Allocator>& lhs, Basic_fstring_view<Char> rhs){
     return !(lhs == rhs);
 }
 
-template<typename Char, SizeType N> inline FORCE_INLINE
-bool operator != (const Char (&lhs)[N], const Basic_fstring<Char>& rhs){
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator != (Basic_fstring_view<Char> lhs, const Basic_fstring<Char, Allocator>& rhs){
     return !(lhs == rhs);
 }
 
-template<typename Char> inline
-bool operator < (Basic_fstring<Char> const& lhs, Basic_fstring<Char> const& rhs){
-    return Basic_fstring<Char>::compare(lhs, rhs) < 0;
+template<typename Char, SizeType N> inline FORCE_INLINE
+bool operator != (Basic_fstring_view<Char> lhs, const Char (&rhs)[N]){
+    return !(lhs == rhs);
 }
 
 template<typename Char> inline
-bool operator <= (Basic_fstring<Char> const& lhs, Basic_fstring<Char> const& rhs){
-    return Basic_fstring<Char>::compare(lhs, rhs) <= 0;
+bool operator < (Basic_fstring_view<Char> lhs, Basic_fstring_view<Char> rhs){
+    return Basic_fstring_view<Char>::compare(lhs, rhs) < 0;
 }
 
-template<typename Char> inline
-bool operator > (Basic_fstring<Char> const& lhs, Basic_fstring<Char> const& rhs){
-    return Basic_fstring<Char>::compare(lhs, rhs) > 0;
+template<typename Char>
+inline std::basic_ostream<Char>& operator << (std::basic_ostream<Char>& o, Basic_fstring_view<Char> str){
+    return o.write(str.data(), str.size());
 }
 
-template<typename Char> inline
-bool operator >= (Basic_fstring<Char> const& lhs, Basic_fstring<Char> const& rhs){
-    return Basic_fstring<Char>::compare(lhs, rhs) >= 0;
+//! A pending concatenation, produced by operator + on FStrings, views,
+//! literals and characters. Nothing is copied until it is converted to a
+//! Basic_fstring, which sizes the result once and copies every piece once.
+//! Nodes only refer to their operands, so convert within the same full
+//! expression; do not keep one in an auto variable beyond its operands.
+template<typename Char, typename Lhs, typename Rhs>
+class Basic_fstring_concat
+{
+    public:
+        Basic_fstring_concat(const Lhs& lhs, const Rhs& rhs) : m_lhs(lhs), m_rhs(rhs) {}
+
+        inline FORCE_INLINE SizeType size() const {
+            return concat_detail::piece_size(m_lhs) + concat_detail::piece_size(m_rhs);
+        }
+
+        //! Copies the pieces to \a out and returns the end of the output
+        inline FORCE_INLINE Char* write(Char* out) const {
+            return concat_detail::write_piece(concat_detail::write_piece(out, m_lhs), m_rhs);
+        }
+
+        Basic_fstring<Char> str() const {
+            return Basic_fstring<Char>(*this);
+        }
+
+    private:
+        Lhs m_lhs;
+        Rhs m_rhs;
+};
+
+namespace concat_detail {
+
+//! Maps an operand of operator + to what a Basic_fstring_concat stores:
+//! strings become views, characters stay characters, nodes stay nodes.
+//! Types without a specialization are not concatenable.
+template<typename T, typename Char>
+struct Piece {};
+
+template<typename Char, typename Allocator>
+struct Piece<Basic_fstring<Char, Allocator>, Char> {
+    using type = Basic_fstring_view<Char>;
+    static type make(const Basic_fstring<Char, Allocator>& str){ return str.view(); }
+};
+
+template<typename Char>
+struct Piece<Basic_fstring_view<Char>, Char> {
+    using type = Basic_fstring_view<Char>;
+    static type make(Basic_fstring_view<Char> str){ return str; }
+};
+
+template<typename Char>
+struct Piece<std::basic_string<Char>, Char> {
+    using type = Basic_fstring_view<Char>;
+    static type make(const std::basic_string<Char>& str){ return type(str); }
+};
+
+template<typename Char, SizeType N>
+struct Piece<Char[N], Char> {
+    using type = Basic_fstring_view<Char>;
+    static type make(const Char (&str)[N]){ return type(str, N - 1); }
+};
+
+template<typename Char>
+struct Piece<const Char*, Char> {
+    using type = Basic_fstring_view<Char>;
+    static type make(const Char* str){ return type(str); }
+};
+
+template<typename Char>
+struct Piece<Char*, Char> : Piece<const Char*, Char> {};
+
+template<typename Char>
+struct Piece<Char, Char> {
+    using type = Char;
+    static type make(Char ch){ return ch; }
+};
+
+template<typename Char, typename Lhs, typename Rhs>
+struct Piece<Basic_fstring_concat<Char, Lhs, Rhs>, Char> {
+    using type = Basic_fstring_concat<Char, Lhs, Rhs>;
+    static const type& make(const type& expr){ return expr; }
+};
+
+//! The character type of the string classes; at least one operand of
+//! operator + must be one, so plain literals and characters keep their meaning
+template<typename T>
+struct StringChar {};
+
+template<typename Char, typename Allocator>
+struct StringChar<Basic_fstring<Char, Allocator>> { using type = Char; };
+
+template<typename Char>
+struct StringChar<Basic_fstring_view<Char>> { using type = Char; };
+
+template<typename Char, typename Lhs, typename Rhs>
+struct StringChar<Basic_fstring_concat<Char, Lhs, Rhs>> { using type = Char; };
+
+template<typename L, typename R, typename = void>
+struct CommonChar : StringChar<R> {};
+
+template<typename L, typename R>
+struct CommonChar<L, R, decltype(void(std::declval<typename StringChar<L>::type>()))> : StringChar<L> {};
+
+} // namespace concat_detail
+
+//! Builds a Basic_fstring_concat; e.g. FString name = scope + "::" + id + '\'';
+template<typename L, typename R,
+         typename Char = typename concat_detail::CommonChar<L, R>::type,
+         typename LPiece = concat_detail::Piece<L, Char>,
+         typename RPiece = concat_detail::Piece<R, Char>>
+inline FORCE_INLINE Basic_fstring_concat<Char, typename LPiece::type, typename RPiece::type>
+operator + (const L& lhs, const R& rhs){
+    return Basic_fstring_concat<Char, typename LPiece::type, typename RPiece::type>(LPiece::make(lhs), RPiece::make(rhs));
 }
 
+//! Grants access to the get area of any stream buffer, so characters can be
+//! copied straight from it into a Basic_fstring. Naming the protected members
+//! through a derived class and invoking them on the base is well-formed C++.
 template<typename Char>
-inline std::basic_istream<Char>& operator >> (std::basic_istream<Char>& i, Basic_fstring<Char>& str){
-    std::basic_string<Char> sstr; i >> sstr;
-    str = sstr;
+struct Streambuf_access : std::basic_streambuf<Char> {
+    using Base = std::basic_streambuf<Char>;
+
+    static Char* get_begin(Base* buf){ return (buf->*&Streambuf_access::gptr)(); }
+    static Char* get_end(Base* buf){ return (buf->*&Streambuf_access::egptr)(); }
+    static void advance(Base* buf, std::ptrdiff_t n){ (buf->*&Streambuf_access::gbump)(static_cast<int>(n)); }
+
+    //! Makes the get area non-empty, returns false at the end of the stream.
+    //! An unbuffered stream buffer keeps an empty get area; \a ch then holds
+    //! the next character (not yet extracted).
+    static bool fill(Base* buf, typename Base::int_type& ch){
+        ch = buf->sgetc();
+        return !Base::traits_type::eq_int_type(ch, Base::traits_type::eof());
+    }
+};
+
+//! Extracts a whitespace delimited word directly into \a str, reusing its buffer
+template<typename Char, typename Allocator>
+inline std::basic_istream<Char>& operator >> (std::basic_istream<Char>& i, Basic_fstring<Char, Allocator>& str){
+    using traits = std::char_traits<Char>;
+    using access = Streambuf_access<Char>;
+    std::ios_base::iostate state = std::ios_base::goodbit;
+    typename std::basic_istream<Char>::sentry sentry(i);
+    if(sentry){
+        str.clear();
+        const std::ctype<Char>& ctype = std::use_facet<std::ctype<Char>>(i.getloc());
+        std::basic_streambuf<Char>* buf = i.rdbuf();
+        std::streamsize remaining = i.width() > 0 ? i.width() : std::numeric_limits<std::streamsize>::max();
+        typename traits::int_type next;
+        while(remaining > 0){
+            if(!access::fill(buf, next)){
+                state |= std::ios_base::eofbit;
+                break;
+            }
+            const Char* first = access::get_begin(buf);
+            const Char* last = access::get_end(buf);
+            if(first == last){
+                const Char ch = traits::to_char_type(next);
+                if(ctype.is(std::ctype_base::space, ch))
+                    break;
+                str.push_back(ch);
+                buf->sbumpc();
+                --remaining;
+                continue;
+            }
+            if(last - first > remaining)
+                last = first + remaining;
+            const Char* stop = ctype.scan_is(std::ctype_base::space, first, last);
+            str.append(first, static_cast<SizeType>(stop - first));
+            access::advance(buf, stop - first);
+            remaining -= stop - first;
+            if(stop != last)
+                break;
+        }
+        i.width(0);
+        if(str.empty())
+            state |= std::ios_base::failbit;
+    }
+    i.setstate(state);
     return i;
 }
 
-template<typename Char>
-inline std::basic_ostream<Char>& operator << (std::basic_ostream<Char>& o, Basic_fstring<Char> const& str){
+template<typename Char, typename Allocator>
+inline std::basic_ostream<Char>& operator << (std::basic_ostream<Char>& o, Basic_fstring<Char, Allocator> const& str){
     if(str.size() > 0)
         o << &str[0];
     return o;
 }
 
 namespace std {
-    template<typename Char>
-    inline std::basic_istream<Char>& getline(std::basic_istream<Char>& i, Basic_fstring<Char>& str){
-        std::basic_string<Char> sstr; std::getline(i, sstr);
-        return str = sstr, i;
+    //! Reads a line directly into \a str. The buffer of \a str is reused, so
+    //! reading a file line by line into one string stops allocating once
+    //! it has grown to the longest line.
+    template<typename Char, typename Allocator>
+    inline std::basic_istream<Char>& getline(std::basic_istream<Char>& i, Basic_fstring<Char, Allocator>& str, Char delim){
+        using traits = std::char_traits<Char>;
+        using access = Streambuf_access<Char>;
+        std::ios_base::iostate state = std::ios_base::goodbit;
+        typename std::basic_istream<Char>::sentry sentry(i, true);
+        if(sentry){
+            str.clear();
+            std::basic_streambuf<Char>* buf = i.rdbuf();
+            bool extracted = false;
+            typename traits::int_type next;
+            for(;;){
+                if(!access::fill(buf, next)){
+                    state |= std::ios_base::eofbit;
+                    break;
+                }
+                extracted = true;
+                const Char* first = access::get_begin(buf);
+                const Char* last = access::get_end(buf);
+                if(first == last){
+                    buf->sbumpc();
+                    if(traits::eq(traits::to_char_type(next), delim))
+                        break;
+                    str.push_back(traits::to_char_type(next));
+                    continue;
+                }
+                const Char* found = simd::find_char(first, last, delim);
+                const Char* stop = found ? found : last;
+                str.append(first, static_cast<SizeType>(stop - first));
+                if(found){
+                    access::advance(buf, stop - first + 1);
+                    break;
+                }
+                access::advance(buf, stop - first);
+            }
+            if(!extracted)
+                state |= std::ios_base::failbit;
+        }
+        i.setstate(state);
+        return i;
+    }
+
+    template<typename Char, typename Allocator>
+    inline std::basic_istream<Char>& getline(std::basic_istream<Char>& i, Basic_fstring<Char, Allocator>& str){
+        return getline(i, str, i.widen('\n'));
     }
 }
 
-template<typename Char>
-inline void swap(Basic_fstring<Char>& lhs, Basic_fstring<Char>& rhs){
+template<typename Char, typename Allocator>
+inline void swap(Basic_fstring<Char, Allocator>& lhs, Basic_fstring<Char, Allocator>& rhs){
     lhs.swap(rhs);
 }
 
+//! djb2 (hash * 33 + c) over \a len characters, the function hash_it
+//! applies to FStrings and views. constexpr, so literals are hashed
+//! by the compiler.
+template<typename Char>
+constexpr SizeType hash_chars(const Char* str, SizeType len) noexcept {
+    using Unit = std::conditional_t<sizeof(Char) == 1, unsigned char, std::make_unsigned_t<Char>>;
+    SizeType hash = 5381;
+    for(SizeType i = 0; i < len; i++)
+        hash = ((hash << 5) + hash) + static_cast<SizeType>(static_cast<Unit>(str[i]));
+    return hash;
+}
+
+//! A string literal whose length and hash are computed at compile time:
+//!     constexpr auto kWhile = FS("while");
+//!     static_assert(kWhile.size() == 5, "");
+//!     keywords.find(FS("while"));     // no hashing at run time
+//! Two literals compare by length, then hash, before any character is read.
+//! The characters are not copied, only literals with static storage belong here.
+template<typename Char>
+class Basic_fstring_literal
+{
+    public:
+        using value_type = Char;
+        using size_type = SizeType;
+
+        template<SizeType N>
+        constexpr explicit Basic_fstring_literal(const Char (&str)[N]) noexcept
+            : m_data(str), m_size(N - 1), m_hash(hash_chars(str, N - 1)) {}
+
+        constexpr const Char* data() const noexcept { return m_data; }
+        constexpr const Char* c_str() const noexcept { return m_data; }
+        constexpr size_type size() const noexcept { return m_size; }
+        constexpr size_type length() const noexcept { return m_size; }
+        constexpr bool empty() const noexcept { return m_size == 0; }
+        constexpr SizeType hash() const noexcept { return m_hash; }
+
+        constexpr const Char& operator [] (size_type idx) const { return m_data[idx]; }
+        constexpr const Char* begin() const noexcept { return m_data; }
+        constexpr const Char* end() const noexcept { return m_data + m_size; }
+
+        constexpr Basic_fstring_view<Char> view() const noexcept { return { m_data, m_size }; }
+        constexpr operator Basic_fstring_view<Char> () const noexcept { return view(); }
+
+        Basic_fstring<Char> str() const { return Basic_fstring<Char>(view()); }
+
+        constexpr static bool equals(Basic_fstring_literal lhs, Basic_fstring_literal rhs) noexcept {
+            if(lhs.m_size != rhs.m_size || lhs.m_hash != rhs.m_hash)
+                return false;
+            for(size_type i = 0; i < lhs.m_size; i++)
+                if(lhs.m_data[i] != rhs.m_data[i])
+                    return false;
+            return true;
+        }
+
+    private:
+        const Char* m_data;
+        size_type m_size;
+        SizeType m_hash;
+};
+
+//! Makes a Basic_fstring_literal, the character type is deduced: FS("if"), FS(u"if")
+template<typename Char, SizeType N>
+constexpr Basic_fstring_literal<Char> FS(const Char (&str)[N]) noexcept {
+    return Basic_fstring_literal<Char>(str);
+}
+
+template<typename Char> constexpr
+bool operator == (Basic_fstring_literal<Char> lhs, Basic_fstring_literal<Char> rhs){
+    return Basic_fstring_literal<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> constexpr
+bool operator != (Basic_fstring_literal<Char> lhs, Basic_fstring_literal<Char> rhs){
+    return !Basic_fstring_literal<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator == (Basic_fstring_literal<Char> lhs, Basic_fstring_view<Char> rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator == (Basic_fstring_view<Char> lhs, Basic_fstring_literal<Char> rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator == (Basic_fstring_literal<Char> lhs, const Basic_fstring<Char, Allocator>& rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator == (const Basic_fstring<Char, Allocator>& lhs, Basic_fstring_literal<Char> rhs){
+    return Basic_fstring_view<Char>::equals(lhs, rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator != (Basic_fstring_literal<Char> lhs, Basic_fstring_view<Char> rhs){
+    return !(lhs == rhs);
+}
+
+template<typename Char> inline FORCE_INLINE
+bool operator != (Basic_fstring_view<Char> lhs, Basic_fstring_literal<Char> rhs){
+    return !(lhs == rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator != (Basic_fstring_literal<Char> lhs, const Basic_fstring<Char, Allocator>& rhs){
+    return !(lhs == rhs);
+}
+
+template<typename Char, typename Allocator> inline FORCE_INLINE
+bool operator != (const Basic_fstring<Char, Allocator>& lhs, Basic_fstring_literal<Char> rhs){
+    return !(lhs == rhs);
+}
+
+template<typename Char>
+inline std::basic_ostream<Char>& operator << (std::basic_ostream<Char>& o, Basic_fstring_literal<Char> str){
+    return o << str.view();
+}
+
+//! The characters are inline or on the heap, never pointed to from inside
+template<typename Char, typename Allocator>
+struct IsTriviallyRelocatable<Basic_fstring<Char, Allocator>> : std::true_type {};
+
 using FString = Basic_fstring<char>;
 using FWString = Basic_fstring<wchar_t>;
 using F16String = Basic_fstring<char16_t>;
 using F32String = Basic_fstring<char32_t>;
 
+using FStringView = Basic_fstring_view<char>;
+using FWStringView = Basic_fstring_view<wchar_t>;
+using F16StringView = Basic_fstring_view<char16_t>;
+using F32StringView = Basic_fstring_view<char32_t>;
+
+using FStringLiteral = Basic_fstring_literal<char>;
+using FWStringLiteral = Basic_fstring_literal<wchar_t>;
+using F16StringLiteral = Basic_fstring_literal<char16_t>;
+using F32StringLiteral = Basic_fstring_literal<char32_t>;
+
 #endif // STRING_H
 
@@ -0,0 +1,521 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef STRINGALGORITHMS_HPP
+#define STRINGALGORITHMS_HPP
+
+#include <iterator>
+#include <cstdint>
+#include <algorithm>
+#include <initializer_list>
+#include "Config.hpp"
+#include "Simd.hpp"
+#include "String.hpp"
+#include "FVector.hpp"
+
+using CharSet = simd::CharSet;
+
+//! Character classes for lexers, built at compile time
+namespace char_class {
+constexpr CharSet whitespace(" \t\n\r\f\v");
+constexpr CharSet blank(" \t");
+constexpr CharSet digits = CharSet().add_range('0', '9');
+constexpr CharSet hex_digits = CharSet(digits).add_range('a', 'f').add_range('A', 'F');
+constexpr CharSet alpha = CharSet().add_range('a', 'z').add_range('A', 'Z');
+constexpr CharSet alnum = alpha | digits;
+constexpr CharSet identifier_start = alpha | CharSet("_");
+constexpr CharSet identifier = alnum | CharSet("_");
+}
+
+//! Index of the first character at or after \a pos that is not in \a cls,
+//! str.size() if there is none. Whole blocks of 16 or 32 bytes are tested
+//! at once, so long runs of blanks or identifier characters are cheap.
+template<typename Char>
+inline SizeType skip_while(Basic_fstring_view<Char> str, const CharSet& cls, SizeType pos = 0){
+    if(pos >= str.size())
+        return str.size();
+    const Char* found = simd::find_not_any(str.data() + pos, str.data() + str.size(), cls);
+    return found ? static_cast<SizeType>(found - str.data()) : str.size();
+}
+
+template<typename Char, typename Allocator>
+inline SizeType skip_while(const Basic_fstring<Char, Allocator>& str, const CharSet& cls, SizeType pos = 0){
+    return skip_while(str.view(), cls, pos);
+}
+
+//! Index of the first character at or after \a pos that is in \a cls,
+//! str.size() if there is none
+template<typename Char>
+inline SizeType skip_until(Basic_fstring_view<Char> str, const CharSet& cls, SizeType pos = 0){
+    if(pos >= str.size())
+        return str.size();
+    const Char* found = simd::find_any(str.data() + pos, str.data() + str.size(), cls);
+    return found ? static_cast<SizeType>(found - str.data()) : str.size();
+}
+
+template<typename Char, typename Allocator>
+inline SizeType skip_until(const Basic_fstring<Char, Allocator>& str, const CharSet& cls, SizeType pos = 0){
+    return skip_until(str.view(), cls, pos);
+}
+
+//! Drops the leading characters that are in \a cls
+template<typename Char>
+inline Basic_fstring_view<Char> ltrim(Basic_fstring_view<Char> str, const CharSet& cls = char_class::whitespace){
+    str.remove_prefix(skip_while(str, cls));
+    return str;
+}
+
+//! Drops the trailing characters that are in \a cls
+template<typename Char>
+inline Basic_fstring_view<Char> rtrim(Basic_fstring_view<Char> str, const CharSet& cls = char_class::whitespace){
+    const Char* last = simd::rfind_not_any(str.data(), str.data() + str.size(), cls);
+    return Basic_fstring_view<Char>(str.data(), last ? static_cast<SizeType>(last - str.data()) + 1 : 0);
+}
+
+template<typename Char>
+inline Basic_fstring_view<Char> trim(Basic_fstring_view<Char> str, const CharSet& cls = char_class::whitespace){
+    return rtrim(ltrim(str, cls), cls);
+}
+
+template<typename Char, typename Allocator>
+inline Basic_fstring_view<Char> ltrim(const Basic_fstring<Char, Allocator>& str, const CharSet& cls = char_class::whitespace){
+    return ltrim(str.view(), cls);
+}
+
+template<typename Char, typename Allocator>
+inline Basic_fstring_view<Char> rtrim(const Basic_fstring<Char, Allocator>& str, const CharSet& cls = char_class::whitespace){
+    return rtrim(str.view(), cls);
+}
+
+template<typename Char, typename Allocator>
+inline Basic_fstring_view<Char> trim(const Basic_fstring<Char, Allocator>& str, const CharSet& cls = char_class::whitespace){
+    return trim(str.view(), cls);
+}
+
+
+//! True if \a a and \a b are equal ignoring ASCII case. Only 'A'..'Z' are
+//! folded, every other byte (UTF-8 included) must match exactly.
+inline bool iequals(FStringView a, FStringView b){
+    return a.size() == b.size() && simd::mismatch_icase(a.data(), b.data(), a.size()) == a.size();
+}
+
+//! Orders \a a and \a b as their ASCII lowercase forms compare, negative,
+//! zero or positive like strcmp
+inline int icompare(FStringView a, FStringView b){
+    const SizeType n = a.size() < b.size() ? a.size() : b.size();
+    const SizeType i = simd::mismatch_icase(a.data(), b.data(), n);
+    if(i < n)
+        return simd::fold_case(a[i]) < simd::fold_case(b[i]) ? -1 : 1;
+    return a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0;
+}
+
+//! A hash consistent with iequals: strings that compare equal ignoring case hash alike
+inline SizeType ihash(FStringView str){
+    return static_cast<SizeType>(simd::hash_icase(str.data(), str.size()));
+}
+
+//! For case-insensitive keyword tables, no lowercased copy of the token needed:
+//!     HashMap<FString, Keyword, CaseInsensitiveHash, CaseInsensitiveEqual> keywords;
+//!     keywords.find(token_view);
+//! Both are transparent, so find() takes views of any key type.
+struct CaseInsensitiveHash{
+    using is_transparent = void;
+    SizeType operator () (FStringView str) const { return ihash(str); }
+};
+
+struct CaseInsensitiveEqual{
+    using is_transparent = void;
+    bool operator () (FStringView a, FStringView b) const { return iequals(a, b); }
+};
+
+
+namespace edit_distance_detail {
+
+//! One column step of Myers' bit-vector algorithm over a block of 64 rows,
+//! in Hyyrö's formulation for edit distance. \a hin is the horizontal delta
+//! entering the block's top row, the one leaving its \a high row is returned.
+inline int FORCE_INLINE advance_block(uint64_t& pv, uint64_t& mv, uint64_t eq, int hin, uint64_t high){
+    const uint64_t xv = eq | mv;
+    if(hin < 0)
+        eq |= 1;
+    const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    const int hout = (ph & high) ? 1 : (mh & high) ? -1 : 0;
+    ph <<= 1;
+    mh <<= 1;
+    if(hin < 0)
+        mh |= 1;
+    else if(hin > 0)
+        ph |= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    return hout;
+}
+
+//! Lower bound of the edit distance from character counts: every surplus
+//! character of one string needs an edit. Bytes are bucketed by their low
+//! five bits, which keeps the bound valid and the histogram small.
+struct Histogram{
+    int32_t counts[32] = {};
+
+    explicit Histogram(FStringView str){
+        for(char c : str)
+            counts[static_cast<unsigned char>(c) & 31]++;
+    }
+
+    SizeType lower_bound(const Histogram& other) const {
+        int surplus = 0, deficit = 0;
+        for(int i = 0; i < 32; i++){
+            const int d = counts[i] - other.counts[i];
+            if(d > 0)
+                surplus += d;
+            else
+                deficit -= d;
+        }
+        return static_cast<SizeType>(surplus > deficit ? surplus : deficit);
+    }
+};
+
+} // namespace edit_distance_detail
+
+//! Levenshtein distances from one string to many, with Myers' bit-parallel
+//! algorithm: 64 characters of the pattern advance per machine word
+//! operation, so a text of n characters costs O(n * ceil(m / 64)).
+//! The match masks are built once, in the constructor.
+class LevenshteinPattern
+{
+    public:
+        explicit LevenshteinPattern(FStringView pattern)
+            : m_size(pattern.size()), m_blocks((pattern.size() + 63) / 64), m_peq(256 * m_blocks, uint64_t(0)) {
+            for(SizeType i = 0; i < m_size; i++)
+                m_peq[static_cast<unsigned char>(pattern[i]) * m_blocks + i / 64] |= uint64_t(1) << (i % 64);
+        }
+
+        SizeType size() const { return m_size; }
+
+        //! The edit distance to \a text, or any value above \a max once it is
+        //! certain to exceed \a max, which lets hopeless texts stop early
+        SizeType distance(FStringView text, SizeType max = FStringView::npos) const {
+            using namespace edit_distance_detail;
+            const SizeType n = text.size();
+            if(m_size == 0 || n == 0)
+                return m_size + n;
+            const SizeType gap = m_size > n ? m_size - n : n - m_size;
+            if(gap > max)
+                return gap;
+
+            const uint64_t high = uint64_t(1) << ((m_size - 1) % 64);
+            SizeType score = m_size;
+            if(m_blocks == 1){
+                uint64_t pv = ~uint64_t(0), mv = 0;
+                for(SizeType j = 0; j < n; j++){
+                    const uint64_t eq = m_peq[static_cast<unsigned char>(text[j])];
+                    score += advance_block(pv, mv, eq, 1, high);
+                    // Each remaining column lowers the score by one at most
+                    if(score > max && score - max > n - j - 1)
+                        return score - (n - j - 1);
+                }
+                return score;
+            }
+
+            FVector<uint64_t> pv(m_blocks, ~uint64_t(0)), mv(m_blocks, uint64_t(0));
+            const uint64_t top = uint64_t(1) << 63;
+            for(SizeType j = 0; j < n; j++){
+                const uint64_t* eq = &m_peq[static_cast<unsigned char>(text[j]) * m_blocks];
+                int carry = 1;
+                for(SizeType b = 0; b + 1 < m_blocks; b++)
+                    carry = advance_block(pv[b], mv[b], eq[b], carry, top);
+                score += advance_block(pv[m_blocks - 1], mv[m_blocks - 1], eq[m_blocks - 1], carry, high);
+                if(score > max && score - max > n - j - 1)
+                    return score - (n - j - 1);
+            }
+            return score;
+        }
+
+    private:
+        SizeType m_size;
+        SizeType m_blocks;
+        //! Bit i of block b of m_peq[c * m_blocks + b] is set if pattern[64b + i] == c
+        FVector<uint64_t> m_peq;
+};
+
+//! Levenshtein distance: insertions, deletions and substitutions of bytes
+inline SizeType edit_distance(FStringView a, FStringView b){
+    return a.size() <= b.size() ? LevenshteinPattern(a).distance(b) : LevenshteinPattern(b).distance(a);
+}
+
+//! A key of a map and its edit distance to the looked up one
+struct NearestKey{
+    FStringView key;
+    SizeType distance;
+
+    friend bool operator < (const NearestKey& x, const NearestKey& y){
+        return x.distance != y.distance ? x.distance < y.distance : x.key < y.key;
+    }
+};
+
+//! The at most \a k keys of \a map within edit distance \a max_distance of
+//! \a key, closest first, for "did you mean" diagnostics. Keys whose length
+//! or character counts already rule them out never reach the distance
+//! computation. The views returned refer to the keys in \a map.
+template<typename Map>
+inline FVector<NearestKey> nearest_keys(const Map& map, FStringView key, SizeType k, SizeType max_distance){
+    using namespace edit_distance_detail;
+    const LevenshteinPattern pattern(key);
+    const Histogram histogram(key);
+    FVector<NearestKey> found;
+    for(const auto& entry : map){
+        const FStringView candidate(entry.first);
+        const SizeType gap = candidate.size() > key.size() ? candidate.size() - key.size() : key.size() - candidate.size();
+        if(gap > max_distance || histogram.lower_bound(Histogram(candidate)) > max_distance)
+            continue;
+        const SizeType distance = pattern.distance(candidate, max_distance);
+        if(distance <= max_distance)
+            found.push_back({ candidate, distance });
+    }
+    std::sort(found.begin(), found.end());
+    while(found.size() > k)
+        found.pop_back();
+    return found;
+}
+
+
+//! What split() does with the empty pieces between adjacent delimiters
+enum class SplitMode { KeepEmpty, SkipEmpty };
+
+namespace split_detail {
+
+template<typename Char>
+struct CharDelimiter{
+    Char ch;
+    const Char* find(const Char* first, const Char* last) const { return simd::find_char(first, last, ch); }
+    SizeType size() const { return 1; }
+};
+
+//! An empty delimiter never matches, the whole input is a single piece
+template<typename Char>
+struct StringDelimiter{
+    Basic_fstring_view<Char> str;
+    const Char* find(const Char* first, const Char* last) const {
+        if(str.empty())
+            return nullptr;
+        return simd::find_substring(first, static_cast<SizeType>(last - first), str.data(), str.size());
+    }
+    SizeType size() const { return str.size(); }
+};
+
+template<typename Char>
+struct AnyDelimiter{
+    CharSet set;
+    const Char* find(const Char* first, const Char* last) const { return simd::find_any(first, last, set); }
+    SizeType size() const { return 1; }
+};
+
+} // namespace split_detail
+
+
+//! A lazy range over the pieces of a string between delimiters. Pieces are
+//! views into the original characters; nothing is copied or allocated, so
+//! the string must outlive the range. Like Python's str.split(sep), n
+//! delimiters give n + 1 pieces unless SplitMode::SkipEmpty drops the empty ones.
+template<typename Char, typename Delimiter>
+class Basic_split_range
+{
+    public:
+        Basic_split_range(Basic_fstring_view<Char> str, Delimiter delimiter, SplitMode mode)
+            : m_str(str), m_delimiter(delimiter), m_mode(mode) {}
+
+        class iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Basic_fstring_view<Char>;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const value_type*;
+                using reference = const value_type&;
+
+                iterator() = default;
+
+                reference operator * () const { return m_piece; }
+                pointer operator -> () const { return &m_piece; }
+
+                iterator& operator ++ () { next(); return *this; }
+                iterator operator ++ (int) { iterator t(*this); next(); return t; }
+
+                friend bool operator == (const iterator& x, const iterator& y){
+                    return x.m_done == y.m_done && (x.m_done || x.m_piece.data() == y.m_piece.data());
+                }
+                friend bool operator != (const iterator& x, const iterator& y){ return !(x == y); }
+
+            private:
+                friend class Basic_split_range;
+
+                const Basic_split_range* m_range = nullptr;
+                Basic_fstring_view<Char> m_piece;
+                //! Start of the unsplit remainder, nullptr once the last piece is out
+                const Char* m_rest = nullptr;
+                bool m_done = true;
+
+                iterator(const Basic_split_range* range) : m_range(range), m_rest(range->m_str.data()), m_done(false) {
+                    next();
+                }
+
+                void next(){
+                    const Char* const last = m_range->m_str.data() + m_range->m_str.size();
+                    do{
+                        if(m_rest == nullptr){
+                            m_done = true;
+                            return;
+                        }
+                        const Char* hit = m_range->m_delimiter.find(m_rest, last);
+                        const Char* stop = hit ? hit : last;
+                        m_piece = Basic_fstring_view<Char>(m_rest, static_cast<SizeType>(stop - m_rest));
+                        m_rest = hit ? hit + m_range->m_delimiter.size() : nullptr;
+                    } while(m_piece.empty() && m_range->m_mode == SplitMode::SkipEmpty);
+                }
+        };
+
+        iterator begin() const { return iterator(this); }
+        iterator end() const { return iterator(); }
+
+        //! Number of pieces, which walks the whole range
+        SizeType count() const {
+            SizeType n = 0;
+            for(auto i = begin(); i != end(); ++i)
+                n++;
+            return n;
+        }
+
+    private:
+        Basic_fstring_view<Char> m_str;
+        Delimiter m_delimiter;
+        SplitMode m_mode;
+};
+
+//! Splits at every occurrence of \a delimiter: for(FStringView field : split(line, ','))
+template<typename Char>
+inline Basic_split_range<Char, split_detail::CharDelimiter<Char>>
+split(Basic_fstring_view<Char> str, Char delimiter, SplitMode mode = SplitMode::KeepEmpty){
+    return { str, { delimiter }, mode };
+}
+
+template<typename Char, typename Allocator>
+inline Basic_split_range<Char, split_detail::CharDelimiter<Char>>
+split(const Basic_fstring<Char, Allocator>& str, Char delimiter, SplitMode mode = SplitMode::KeepEmpty){
+    return { str.view(), { delimiter }, mode };
+}
+
+//! Splits at every occurrence of a multi character \a delimiter, e.g. "::"
+template<typename Char>
+inline Basic_split_range<Char, split_detail::StringDelimiter<Char>>
+split(Basic_fstring_view<Char> str, Basic_fstring_view<Char> delimiter, SplitMode mode = SplitMode::KeepEmpty){
+    return { str, { delimiter }, mode };
+}
+
+template<typename Char, typename Allocator>
+inline Basic_split_range<Char, split_detail::StringDelimiter<Char>>
+split(const Basic_fstring<Char, Allocator>& str, Basic_fstring_view<Char> delimiter, SplitMode mode = SplitMode::KeepEmpty){
+    return { str.view(), { delimiter }, mode };
+}
+
+template<typename Char, SizeType N>
+inline Basic_split_range<Char, split_detail::StringDelimiter<Char>>
+split(Basic_fstring_view<Char> str, const Char (&delimiter)[N], SplitMode mode = SplitMode::KeepEmpty){
+    return { str, { Basic_fstring_view<Char>(delimiter, N - 1) }, mode };
+}
+
+template<typename Char, typename Allocator, SizeType N>
+inline Basic_split_range<Char, split_detail::StringDelimiter<Char>>
+split(const Basic_fstring<Char, Allocator>& str, const Char (&delimiter)[N], SplitMode mode = SplitMode::KeepEmpty){
+    return { str.view(), { Basic_fstring_view<Char>(delimiter, N - 1) }, mode };
+}
+
+//! Splits at every character of \a delimiters, which are matched a whole
+//! SIMD block at a time: for(FStringView word : split_any(text, " \t\n", SplitMode::SkipEmpty))
+template<typename Char>
+inline Basic_split_range<Char, split_detail::AnyDelimiter<Char>>
+split_any(Basic_fstring_view<Char> str, const CharSet& delimiters, SplitMode mode = SplitMode::KeepEmpty){
+    return { str, { delimiters }, mode };
+}
+
+template<typename Char, typename Allocator>
+inline Basic_split_range<Char, split_detail::AnyDelimiter<Char>>
+split_any(const Basic_fstring<Char, Allocator>& str, const CharSet& delimiters, SplitMode mode = SplitMode::KeepEmpty){
+    return { str.view(), { delimiters }, mode };
+}
+
+
+namespace join_detail {
+
+//! Two passes over [first, last): the lengths, then the characters, so the
+//! result is allocated exactly once, or not at all if it fits the SSO buffer
+template<typename Char, typename Iterator>
+inline Basic_fstring<Char> join(Iterator first, Iterator last, Basic_fstring_view<Char> separator){
+    SizeType total = 0, count = 0;
+    for(Iterator i = first; i != last; ++i, ++count)
+        total += Basic_fstring_view<Char>(*i).size();
+    if(count)
+        total += separator.size() * (count - 1);
+
+    Basic_fstring<Char> str;
+    str.resize_and_overwrite(total, [&](Char* out, SizeType){
+        for(Iterator i = first; i != last; ++i){
+            if(i != first && separator.size()){
+                std::memcpy(out, separator.data(), sizeof(Char) * separator.size());
+                out += separator.size();
+            }
+            const Basic_fstring_view<Char> piece(*i);
+            if(piece.size())
+                std::memcpy(out, piece.data(), sizeof(Char) * piece.size());
+            out += piece.size();
+        }
+        return total;
+    });
+    return str;
+}
+
+} // namespace join_detail
+
+
+//! Concatenates the strings of [first, last) with \a separator between them,
+//! in a single allocation. The elements may be anything that converts to a
+//! view: FStrings, views, FS() literals, std::strings. join(segments, "/")
+template<typename Iterator, typename Char>
+inline Basic_fstring<Char> join(Iterator first, Iterator last, Basic_fstring_view<Char> separator){
+    return join_detail::join<Char>(first, last, separator);
+}
+
+template<typename Iterator, typename Char, SizeType N>
+inline Basic_fstring<Char> join(Iterator first, Iterator last, const Char (&separator)[N]){
+    return join_detail::join<Char>(first, last, Basic_fstring_view<Char>(separator));
+}
+
+template<typename Iterator, typename Char, std::enable_if_t<std::is_integral<Char>::value>* = nullptr>
+inline Basic_fstring<Char> join(Iterator first, Iterator last, Char separator){
+    return join_detail::join<Char>(first, last, Basic_fstring_view<Char>(&separator, 1));
+}
+
+//! Joins a whole range: an FVector, a std::vector, an array or an initializer list
+template<typename Range, typename Separator>
+inline auto join(const Range& range, const Separator& separator)
+        -> decltype(join(std::begin(range), std::end(range), separator)){
+    return join(std::begin(range), std::end(range), separator);
+}
+
+template<typename Char, typename Separator>
+inline auto join(std::initializer_list<Basic_fstring_view<Char>> range, const Separator& separator)
+        -> decltype(join(range.begin(), range.end(), separator)){
+    return join(range.begin(), range.end(), separator);
+}
+
+#endif // STRINGALGORITHMS_HPP
@@ -0,0 +1,197 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef STRINGINTERNER_HPP
+#define STRINGINTERNER_HPP
+
+#include <mutex>
+#include <cstdint>
+#include <cassert>
+#include "Config.hpp"
+#include "String.hpp"
+#include "FVector.hpp"
+#include "HashMap.hpp"
+
+//! A handle to an interned string. Atoms handed out by the same interner
+//! are equal if and only if their strings are equal, so comparing and
+//! hashing identifiers becomes an integer operation.
+class Atom{
+public:
+    using IndexType = uint32_t;
+
+    constexpr Atom() : m_value(std::numeric_limits<IndexType>::max()) {}
+    constexpr explicit Atom(IndexType value) : m_value(value) {}
+
+    constexpr static Atom invalid()
+    { return Atom(); }
+
+    constexpr IndexType id() const { return m_value; }
+    constexpr bool valid() const { return m_value != std::numeric_limits<IndexType>::max(); }
+
+    friend constexpr bool operator == (Atom x, Atom y) { return x.m_value == y.m_value; }
+    friend constexpr bool operator != (Atom x, Atom y) { return x.m_value != y.m_value; }
+    friend constexpr bool operator < (Atom x, Atom y) { return x.m_value < y.m_value; }
+
+private:
+    IndexType m_value;
+};
+
+template<>
+inline SizeType FORCE_INLINE hash_it<Atom>(const Atom& t){
+    return t.id();
+}
+
+
+//! Maps strings to Atoms. Characters are copied once into an append-only
+//! arena of blocks, hence the views returned by str() stay valid (and NULL
+//! terminated) for the lifetime of the interner.
+class StringInterner{
+public:
+
+    //! Size of the arena blocks that short strings are packed into
+    static constexpr SizeType kBlockSize = 16 * 1024;
+
+    //! Strings at least this long (counting the NULL) get a block of their
+    //! own, so one of them never wastes more than a quarter of a shared block
+    static constexpr SizeType kOwnBlockSize = kBlockSize / 4;
+
+    StringInterner() = default;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator = (const StringInterner&) = delete;
+
+    ~StringInterner(){
+        for(auto block : m_blocks)
+            SFAllocator<char>::deallocate(block);
+    }
+
+    Atom intern(const char* str, SizeType len){
+        const FStringView key(str, len);
+        auto iter = m_atoms.find(key);
+        if(iter != m_atoms.end())
+            return iter->second;
+
+        const Atom atom(m_strings.size());
+        const FStringView stored = store(str, len);
+        m_strings.push_back(stored);
+        m_atoms.insert({stored, atom});
+        return atom;
+    }
+
+    Atom intern(FStringView str){
+        return intern(str.data(), str.size());
+    }
+
+    //! Returns the Atom of \a str if it was interned, Atom::invalid() otherwise
+    Atom lookup(FStringView str) const {
+        auto iter = m_atoms.find(str);
+        return iter != m_atoms.cend() ? iter->second : Atom::invalid();
+    }
+
+    FStringView str(Atom atom) const {
+        assert(atom.id() < m_strings.size() && "Atom was not issued by this interner!");
+        return m_strings[atom.id()];
+    }
+
+    inline SizeType FORCE_INLINE size() const {
+        return m_strings.size();
+    }
+
+private:
+    HashMap<FStringView, Atom> m_atoms;
+    FVector<FStringView> m_strings;
+    FVector<char*> m_blocks;
+    char* m_cursor = nullptr;
+    SizeType m_available = 0;
+
+    FStringView store(const char* str, SizeType len){
+        const SizeType needed = len + 1;
+        char* dest;
+        if(needed >= kOwnBlockSize){
+            dest = static_cast<char*>(SFAllocator<char>::allocate(needed));
+            m_blocks.push_back(dest);
+        }
+        else{
+            if(needed > m_available){
+                m_cursor = static_cast<char*>(SFAllocator<char>::allocate(kBlockSize));
+                m_available = kBlockSize;
+                m_blocks.push_back(m_cursor);
+            }
+            dest = m_cursor;
+            m_cursor += needed;
+            m_available -= needed;
+        }
+        if(len)
+            std::memcpy(dest, str, len);
+        dest[len] = '\0';
+        return FStringView(dest, len);
+    }
+};
+
+
+//! A thread-safe StringInterner for parallel front ends. Strings are spread
+//! over kShards independently locked interners by hash; the low bits of an
+//! Atom name its shard, so Atoms remain unique across shards.
+class ConcurrentStringInterner{
+public:
+    static constexpr unsigned kShardBits = 4;
+    static constexpr unsigned kShards = 1u << kShardBits;
+
+    ConcurrentStringInterner() = default;
+    ConcurrentStringInterner(const ConcurrentStringInterner&) = delete;
+    ConcurrentStringInterner& operator = (const ConcurrentStringInterner&) = delete;
+
+    Atom intern(const char* str, SizeType len){
+        const Atom::IndexType shard = hash_it(FStringView(str, len)) % kShards;
+        std::lock_guard<std::mutex> lock(m_shards[shard].mutex);
+        const Atom atom = m_shards[shard].interner.intern(str, len);
+        assert(atom.id() < (1u << (32 - kShardBits)) - 1 && "Too many strings in a shard");
+        return Atom((atom.id() << kShardBits) | shard);
+    }
+
+    Atom intern(FStringView str){
+        return intern(str.data(), str.size());
+    }
+
+    Atom lookup(FStringView str) const {
+        const Atom::IndexType shard = hash_it(str) % kShards;
+        std::lock_guard<std::mutex> lock(m_shards[shard].mutex);
+        const Atom atom = m_shards[shard].interner.lookup(str);
+        return atom.valid() ? Atom((atom.id() << kShardBits) | shard) : atom;
+    }
+
+    //! The returned view points into the arena and remains valid after
+    //! the shard lock is released
+    FStringView str(Atom atom) const {
+        const Shard& shard = m_shards[atom.id() & (kShards - 1)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.interner.str(Atom(atom.id() >> kShardBits));
+    }
+
+    SizeType size() const {
+        SizeType total = 0;
+        for(const auto& shard : m_shards){
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.interner.size();
+        }
+        return total;
+    }
+
+private:
+    struct Shard{
+        mutable std::mutex mutex;
+        StringInterner interner;
+    };
+
+    Shard m_shards[kShards];
+};
+
+#endif // STRINGINTERNER_HPP
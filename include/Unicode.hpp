@@ -0,0 +1,877 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#ifndef UNICODE_HPP
+#define UNICODE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include "Config.hpp"
+#include "Simd.hpp"
+#include "String.hpp"
+
+namespace utf8_detail {
+
+constexpr char32_t kReplacement = 0xFFFD;
+
+inline unsigned FORCE_INLINE popcount(unsigned v){
+#ifdef __GNUC__
+    return static_cast<unsigned>(__builtin_popcount(v));
+#else
+    unsigned n = 0;
+    for(; v; v &= v - 1) n++;
+    return n;
+#endif
+}
+
+inline bool FORCE_INLINE is_continuation(unsigned char b){
+    return (b & 0xC0) == 0x80;
+}
+
+//! Decodes the sequence at \a p. Returns its length, or 0 if it is malformed:
+//! truncated, overlong, a surrogate or beyond U+10FFFF.
+inline unsigned decode(const unsigned char* p, const unsigned char* last, char32_t& cp){
+    const unsigned char b = p[0];
+    if(b < 0x80){
+        cp = b;
+        return 1;
+    }
+    unsigned len;
+    unsigned char low = 0x80, high = 0xBF;     // valid range of the second byte
+    if(b < 0xC2)
+        return 0;
+    else if(b < 0xE0){
+        len = 2; cp = b & 0x1F;
+    }
+    else if(b < 0xF0){
+        len = 3; cp = b & 0x0F;
+        if(b == 0xE0) low = 0xA0;
+        if(b == 0xED) high = 0x9F;
+    }
+    else if(b < 0xF5){
+        len = 4; cp = b & 0x07;
+        if(b == 0xF0) low = 0x90;
+        if(b == 0xF4) high = 0x8F;
+    }
+    else
+        return 0;
+
+    if(last - p < static_cast<std::ptrdiff_t>(len) || p[1] < low || p[1] > high)
+        return 0;
+    cp = (cp << 6) | (p[1] & 0x3F);
+    for(unsigned i = 2; i < len; i++){
+        if(!is_continuation(p[i]))
+            return 0;
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    return len;
+}
+
+//! Returns the first byte of the first malformed sequence, nullptr if none
+inline const unsigned char* find_invalid_scalar(const unsigned char* p, const unsigned char* last){
+    while(p != last){
+        // Eight ASCII bytes at a time
+        if(last - p >= 8){
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            if((word & 0x8080808080808080ULL) == 0){
+                p += 8;
+                continue;
+            }
+        }
+        char32_t cp;
+        const unsigned len = decode(p, last, cp);
+        if(len == 0)
+            return p;
+        p += len;
+    }
+    return nullptr;
+}
+
+inline SizeType count_scalar(const unsigned char* p, const unsigned char* last){
+    SizeType n = 0;
+    for(; p != last; ++p)
+        n += !is_continuation(*p);
+    return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////   Validation after J. Keiser and D. Lemire, "Validating UTF-8 In Less  //////
+////   Than One Instruction Per Byte". Each byte is checked together with   //////
+////   its predecessor by three 16 entry table lookups, indexed by the high //////
+////   nibble of the previous byte, its low nibble and the high nibble of   //////
+////   the current byte; an error bit survives the AND of all three only if //////
+////   every nibble agrees on it. Sequences longer than two bytes are then  //////
+////   checked by where the third and fourth bytes must be continuations.   //////
+////////////////////////////////////////////////////////////////////////////////
+
+constexpr uint8_t kTooShort = 1 << 0;     // 11______ 0_______  or  11______ 11______
+constexpr uint8_t kTooLong = 1 << 1;      // 0_______ 10______
+constexpr uint8_t kOverlong3 = 1 << 2;    // 11100000 100_____
+constexpr uint8_t kTooLarge = 1 << 3;     // 11110100 1001____ and larger
+constexpr uint8_t kSurrogate = 1 << 4;    // 11101101 101_____
+constexpr uint8_t kOverlong2 = 1 << 5;    // 1100000_ 10______
+constexpr uint8_t kTooLarge1000 = 1 << 6; // 11110101 1000____ and larger
+constexpr uint8_t kOverlong4 = 1 << 6;    // 11110000 1000____
+constexpr uint8_t kTwoConts = 1 << 7;     // 10______ 10______
+constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+#define UTF8_BYTE_1_HIGH \
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, \
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts, \
+    kTooShort | kOverlong2, kTooShort, kTooShort | kOverlong3 | kSurrogate, \
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4
+
+#define UTF8_BYTE_1_LOW \
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4, kCarry | kOverlong2, kCarry, kCarry, \
+    kCarry | kTooLarge, kCarry | kTooLarge | kTooLarge1000, \
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, \
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, \
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, \
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000 | kSurrogate, \
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000
+
+#define UTF8_BYTE_2_HIGH \
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, \
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4, \
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge, \
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge, \
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge, \
+    kTooShort, kTooShort, kTooShort, kTooShort
+
+#ifdef SIMD_SSSE3
+
+struct Utf8CheckerSSSE3{
+    __m128i error = _mm_setzero_si128();
+    __m128i previous = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+
+    TARGET_SSSE3 static __m128i FORCE_INLINE high_nibbles(__m128i v){
+        return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+    }
+
+    TARGET_SSSE3 void FORCE_INLINE check(__m128i input){
+        if(_mm_movemask_epi8(input) == 0){
+            error = _mm_or_si128(error, incomplete);
+            previous = input;
+            incomplete = _mm_setzero_si128();
+            return;
+        }
+        const __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+        const __m128i byte_1_high = _mm_shuffle_epi8(_mm_setr_epi8(UTF8_BYTE_1_HIGH), high_nibbles(prev1));
+        const __m128i byte_1_low = _mm_shuffle_epi8(_mm_setr_epi8(UTF8_BYTE_1_LOW), _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+        const __m128i byte_2_high = _mm_shuffle_epi8(_mm_setr_epi8(UTF8_BYTE_2_HIGH), high_nibbles(input));
+        const __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+        const __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+        const __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+        const __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(-128));
+        error = _mm_or_si128(error, _mm_xor_si128(must_continue, special));
+
+        // Lead bytes too close to the end of the block to be complete
+        const __m128i limits = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                             static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+        incomplete = _mm_subs_epu8(input, limits);
+        previous = input;
+    }
+
+    TARGET_SSSE3 bool FORCE_INLINE valid() const {
+        const __m128i all = _mm_or_si128(error, incomplete);
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(all, _mm_setzero_si128())) == 0xFFFF;
+    }
+};
+
+TARGET_SSSE3 inline bool validate_ssse3(const unsigned char* p, const unsigned char* last){
+    Utf8CheckerSSSE3 checker;
+    for(; last - p >= 16; p += 16)
+        checker.check(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    if(p != last){
+        // Zero padding is ASCII, hence neutral
+        unsigned char tail[16] = {};
+        std::memcpy(tail, p, static_cast<std::size_t>(last - p));
+        checker.check(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)));
+    }
+    return checker.valid();
+}
+
+#endif // SIMD_SSSE3
+
+#ifdef SIMD_AVX2
+
+struct Utf8CheckerAVX2{
+    __m256i error;
+    __m256i previous;
+    __m256i incomplete;
+
+    TARGET_AVX2 Utf8CheckerAVX2()
+        : error(_mm256_setzero_si256()), previous(_mm256_setzero_si256()), incomplete(_mm256_setzero_si256()) {}
+
+    //! The 32 bytes ending N bytes before the end of \a input
+    template<int N>
+    TARGET_AVX2 static __m256i FORCE_INLINE prev(__m256i input, __m256i previous){
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+    }
+
+    TARGET_AVX2 static __m256i FORCE_INLINE high_nibbles(__m256i v){
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    TARGET_AVX2 void FORCE_INLINE check(__m256i input){
+        if(_mm256_movemask_epi8(input) == 0){
+            error = _mm256_or_si256(error, incomplete);
+            previous = input;
+            incomplete = _mm256_setzero_si256();
+            return;
+        }
+        const __m256i prev1 = prev<1>(input, previous);
+        const __m256i byte_1_high = _mm256_shuffle_epi8(_mm256_setr_epi8(UTF8_BYTE_1_HIGH, UTF8_BYTE_1_HIGH), high_nibbles(prev1));
+        const __m256i byte_1_low = _mm256_shuffle_epi8(_mm256_setr_epi8(UTF8_BYTE_1_LOW, UTF8_BYTE_1_LOW),
+                                                       _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+        const __m256i byte_2_high = _mm256_shuffle_epi8(_mm256_setr_epi8(UTF8_BYTE_2_HIGH, UTF8_BYTE_2_HIGH), high_nibbles(input));
+        const __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+        const __m256i third = _mm256_subs_epu8(prev<2>(input, previous), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m256i fourth = _mm256_subs_epu8(prev<3>(input, previous), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(-128));
+        error = _mm256_or_si256(error, _mm256_xor_si256(must_continue, special));
+
+        const __m256i limits = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+        incomplete = _mm256_subs_epu8(input, limits);
+        previous = input;
+    }
+
+    TARGET_AVX2 bool FORCE_INLINE valid() const {
+        return _mm256_testz_si256(_mm256_or_si256(error, incomplete), _mm256_or_si256(error, incomplete));
+    }
+};
+
+//! 64 bytes per step: two blocks that are both ASCII cost one test
+TARGET_AVX2 inline bool validate_avx2(const unsigned char* p, const unsigned char* last){
+    Utf8CheckerAVX2 checker;
+    for(; last - p >= 64; p += 64){
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0){
+            checker.error = _mm256_or_si256(checker.error, checker.incomplete);
+            checker.incomplete = _mm256_setzero_si256();
+            checker.previous = b;
+            continue;
+        }
+        checker.check(a);
+        checker.check(b);
+    }
+    for(; last - p >= 32; p += 32)
+        checker.check(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    if(p != last){
+        unsigned char tail[32] = {};
+        std::memcpy(tail, p, static_cast<std::size_t>(last - p));
+        checker.check(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail)));
+    }
+    return checker.valid();
+}
+
+TARGET_AVX2 inline SizeType count_avx2(const unsigned char* p, const unsigned char* last){
+    // Continuation bytes are exactly the signed bytes below -64
+    const __m256i threshold = _mm256_set1_epi8(-65);
+    SizeType n = 0;
+    for(; last - p >= 32; p += 32){
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        n += popcount(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, threshold))));
+    }
+    return n + count_scalar(p, last);
+}
+
+#endif // SIMD_AVX2
+
+#undef UTF8_BYTE_1_HIGH
+#undef UTF8_BYTE_1_LOW
+#undef UTF8_BYTE_2_HIGH
+
+#ifdef SIMD_SSE2
+inline SizeType count_sse2(const unsigned char* p, const unsigned char* last){
+    const __m128i threshold = _mm_set1_epi8(-65);
+    SizeType n = 0;
+    for(; last - p >= 16; p += 16){
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        n += popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(block, threshold))));
+    }
+    return n + count_scalar(p, last);
+}
+#endif // SIMD_SSE2
+
+} // namespace utf8_detail
+
+
+//! True if \a str is well formed UTF-8: no truncated or overlong sequences,
+//! no surrogates, nothing beyond U+10FFFF.
+inline bool is_valid_utf8(FStringView str){
+    using namespace utf8_detail;
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(str.data());
+    const unsigned char* last = first + str.size();
+#ifdef SIMD_AVX2
+    if(str.size() >= 32 && simd::cpu_has_avx2())
+        return validate_avx2(first, last);
+#endif
+#ifdef SIMD_SSSE3
+    if(str.size() >= 16 && simd::cpu_has_ssse3())
+        return validate_ssse3(first, last);
+#endif
+    return find_invalid_scalar(first, last) == nullptr;
+}
+
+//! Offset of the first byte of the first malformed sequence, npos if \a str
+//! is valid. Slower than is_valid_utf8, meant for error reporting.
+inline SizeType find_invalid_utf8(FStringView str){
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(str.data());
+    const unsigned char* bad = utf8_detail::find_invalid_scalar(first, first + str.size());
+    return bad ? static_cast<SizeType>(bad - first) : FStringView::npos;
+}
+
+//! Number of code points in valid UTF-8; counts the bytes that are not
+//! continuation bytes, 16 or 32 at a time.
+inline SizeType count_code_points(FStringView str){
+    using namespace utf8_detail;
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(str.data());
+    const unsigned char* last = first + str.size();
+#ifdef SIMD_AVX2
+    if(str.size() >= 32 && simd::cpu_has_avx2())
+        return count_avx2(first, last);
+#endif
+#ifdef SIMD_SSE2
+    return count_sse2(first, last);
+#else
+    return count_scalar(first, last);
+#endif
+}
+
+
+//! Iterates the code points of UTF-8 text: for(char32_t cp : code_points(str)).
+//! ASCII is returned without decoding. A malformed sequence yields U+FFFD
+//! and iteration resumes at the following byte, so any input is safe.
+class Utf8_code_point_range
+{
+    public:
+        explicit Utf8_code_point_range(FStringView str)
+            : m_first(reinterpret_cast<const unsigned char*>(str.data())), m_last(m_first + str.size()) {}
+
+        class iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = char32_t;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const char32_t*;
+                using reference = char32_t;
+
+                iterator() = default;
+
+                char32_t operator * () const {
+                    const unsigned char b = *m_pos;
+                    if(b < 0x80)
+                        return b;
+                    char32_t cp;
+                    return utf8_detail::decode(m_pos, m_last, cp) ? cp : utf8_detail::kReplacement;
+                }
+
+                iterator& operator ++ () {
+                    if(*m_pos < 0x80)
+                        ++m_pos;
+                    else{
+                        char32_t cp;
+                        const unsigned len = utf8_detail::decode(m_pos, m_last, cp);
+                        m_pos += len ? len : 1;
+                    }
+                    return *this;
+                }
+                iterator operator ++ (int) { iterator t(*this); ++*this; return t; }
+
+                //! Where the current code point starts in the text
+                const char* base() const { return reinterpret_cast<const char*>(m_pos); }
+
+                friend bool operator == (const iterator& x, const iterator& y){ return x.m_pos == y.m_pos; }
+                friend bool operator != (const iterator& x, const iterator& y){ return x.m_pos != y.m_pos; }
+
+            private:
+                friend class Utf8_code_point_range;
+                iterator(const unsigned char* pos, const unsigned char* last) : m_pos(pos), m_last(last) {}
+
+                const unsigned char* m_pos = nullptr;
+                const unsigned char* m_last = nullptr;
+        };
+
+        iterator begin() const { return iterator(m_first, m_last); }
+        iterator end() const { return iterator(m_last, m_last); }
+
+    private:
+        const unsigned char* m_first;
+        const unsigned char* m_last;
+};
+
+inline Utf8_code_point_range code_points(FStringView str){
+    return Utf8_code_point_range(str);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//////  Transcoding. The output size is computed first, so the destination  ////
+//////  grows once and is written in place. Blocks of ASCII (or, between     ////
+//////  UTF-16 and UTF-32, of units that need no surrogates) are widened or  ////
+//////  narrowed 16 or 8 units at a time; everything else goes through the   ////
+//////  scalar coders one code point at a time.                              ////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace transcode_detail {
+
+using utf8_detail::kReplacement;
+
+inline bool FORCE_INLINE is_surrogate(char32_t cp){
+    return (cp & 0xFFFFF800) == 0xD800;
+}
+
+//! A UTF-32 unit as the code point it is written as
+inline char32_t FORCE_INLINE sanitize(char32_t cp){
+    return cp > 0x10FFFF || is_surrogate(cp) ? kReplacement : cp;
+}
+
+//! Decodes a unit or a surrogate pair, an unpaired surrogate reads as U+FFFD
+inline unsigned FORCE_INLINE decode(const char16_t* p, const char16_t* last, char32_t& cp){
+    const char16_t u = p[0];
+    cp = u;
+    if(!is_surrogate(u))
+        return 1;
+    if(u < 0xDC00 && last - p >= 2 && (p[1] & 0xFC00) == 0xDC00){
+        cp = 0x10000 + ((char32_t(u) - 0xD800) << 10) + (char32_t(p[1]) - 0xDC00);
+        return 2;
+    }
+    cp = kReplacement;
+    return 1;
+}
+
+//! Decodes a UTF-8 sequence, a malformed one reads as U+FFFD and takes one byte
+inline unsigned FORCE_INLINE decode(const unsigned char* p, const unsigned char* last, char32_t& cp){
+    cp = p[0];
+    if(cp < 0x80)
+        return 1;
+    const unsigned len = utf8_detail::decode(p, last, cp);
+    if(len)
+        return len;
+    cp = kReplacement;
+    return 1;
+}
+
+inline unsigned FORCE_INLINE utf8_length(char32_t cp){
+    return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+inline char* FORCE_INLINE encode(char* out, char32_t cp){
+    if(cp < 0x80){
+        *out++ = static_cast<char>(cp);
+    }
+    else if(cp < 0x800){
+        *out++ = static_cast<char>(0xC0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else if(cp < 0x10000){
+        *out++ = static_cast<char>(0xE0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else{
+        *out++ = static_cast<char>(0xF0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+inline char16_t* FORCE_INLINE encode(char16_t* out, char32_t cp){
+    if(cp < 0x10000){
+        *out++ = static_cast<char16_t>(cp);
+    }
+    else{
+        cp -= 0x10000;
+        *out++ = static_cast<char16_t>(0xD800 + (cp >> 10));
+        *out++ = static_cast<char16_t>(0xDC00 + (cp & 0x3FF));
+    }
+    return out;
+}
+
+inline char32_t* FORCE_INLINE encode(char32_t* out, char32_t cp){
+    *out = cp;
+    return out + 1;
+}
+
+#ifdef SIMD_SSE2
+inline __m128i FORCE_INLINE load(const void* p){
+    return _mm_loadu_si128(static_cast<const __m128i*>(p));
+}
+
+inline void FORCE_INLINE store(void* p, __m128i v){
+    _mm_storeu_si128(static_cast<__m128i*>(p), v);
+}
+
+inline char16_t* FORCE_INLINE widen_ascii(__m128i bytes, char16_t* out){
+    const __m128i zero = _mm_setzero_si128();
+    store(out, _mm_unpacklo_epi8(bytes, zero));
+    store(out + 8, _mm_unpackhi_epi8(bytes, zero));
+    return out + 16;
+}
+
+inline char32_t* FORCE_INLINE widen_ascii(__m128i bytes, char32_t* out){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+    const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+    store(out, _mm_unpacklo_epi16(low, zero));
+    store(out + 4, _mm_unpackhi_epi16(low, zero));
+    store(out + 8, _mm_unpacklo_epi16(high, zero));
+    store(out + 12, _mm_unpackhi_epi16(high, zero));
+    return out + 16;
+}
+
+//! True if all the units are zero outside \a mask
+inline bool FORCE_INLINE fits_epi16(__m128i units, short mask){
+    const __m128i outside = _mm_andnot_si128(_mm_set1_epi16(mask), units);
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(outside, _mm_setzero_si128())) == 0xFFFF;
+}
+
+inline bool FORCE_INLINE fits_epi32(__m128i units, int mask){
+    const __m128i outside = _mm_andnot_si128(_mm_set1_epi32(mask), units);
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(outside, _mm_setzero_si128())) == 0xFFFF;
+}
+
+//! Number of the eight units that are not zero outside \a mask
+inline unsigned FORCE_INLINE count_beyond_epi16(__m128i units, short mask){
+    const __m128i outside = _mm_andnot_si128(_mm_set1_epi16(mask), units);
+    return 8 - utf8_detail::popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(outside, _mm_setzero_si128())))) / 2;
+}
+
+inline bool FORCE_INLINE has_surrogate_epi16(__m128i units){
+    const __m128i high = _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_set1_epi16(static_cast<short>(0xD800)))) != 0;
+}
+
+inline bool FORCE_INLINE has_surrogate_epi32(__m128i units){
+    const __m128i high = _mm_and_si128(units, _mm_set1_epi32(0xFFFFF800));
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_set1_epi32(0xD800))) != 0;
+}
+#endif // SIMD_SSE2
+
+//! Bytes 0xF0 and up, which start the code points UTF-16 needs two units for
+inline SizeType count_four_byte_leads(const unsigned char* p, const unsigned char* last){
+    SizeType n = 0;
+#ifdef SIMD_SSE2
+    const __m128i threshold = _mm_set1_epi8(-17);
+    for(; last - p >= 16; p += 16)
+        n += utf8_detail::popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(load(p), threshold))));
+#endif
+    for(; p != last; ++p)
+        n += *p >= 0xF0;
+    return n;
+}
+
+//! UTF-8 to UTF-16 or UTF-32. The scalar loop runs until the end of a block
+//! that was not all ASCII, so mostly non-ASCII text is not tested twice.
+template<typename Out>
+inline Out* utf8_to(const unsigned char* p, const unsigned char* last, Out* out){
+    while(p != last){
+        const unsigned char* stop = last;
+#ifdef SIMD_SSE2
+        if(last - p >= 16){
+            const __m128i bytes = load(p);
+            if(_mm_movemask_epi8(bytes) == 0){
+                out = widen_ascii(bytes, out);
+                p += 16;
+                continue;
+            }
+            stop = p + 16;
+        }
+#endif
+        do{
+            char32_t cp;
+            p += decode(p, last, cp);
+            out = encode(out, cp);
+        } while(p < stop);
+    }
+    return out;
+}
+
+inline SizeType utf8_size(const char16_t* p, const char16_t* last){
+    SizeType n = 0;
+    while(p != last){
+        const char16_t* stop = last;
+#ifdef SIMD_SSE2
+        if(last - p >= 8){
+            const __m128i units = load(p);
+            if(!has_surrogate_epi16(units)){
+                // A byte each, one more from U+0080 and another from U+0800
+                n += 8 + count_beyond_epi16(units, 0x7F) + count_beyond_epi16(units, 0x7FF);
+                p += 8;
+                continue;
+            }
+            stop = p + 8;
+        }
+#endif
+        do{
+            char32_t cp;
+            p += decode(p, last, cp);
+            n += utf8_length(cp);
+        } while(p < stop);
+    }
+    return n;
+}
+
+inline char* utf16_to_utf8(const char16_t* p, const char16_t* last, char* out){
+    while(p != last){
+        const char16_t* stop = last;
+#ifdef SIMD_SSE2
+        if(last - p >= 16){
+            const __m128i low = load(p), high = load(p + 8);
+            if(fits_epi16(_mm_or_si128(low, high), 0x7F)){
+                store(out, _mm_packus_epi16(low, high));
+                out += 16;
+                p += 16;
+                continue;
+            }
+            stop = p + 16;
+        }
+#endif
+        do{
+            char32_t cp;
+            p += decode(p, last, cp);
+            out = encode(out, cp);
+        } while(p < stop);
+    }
+    return out;
+}
+
+inline SizeType utf8_size(const char32_t* p, const char32_t* last){
+    SizeType n = 0;
+    for(; p != last; ++p)
+        n += utf8_length(sanitize(*p));
+    return n;
+}
+
+inline char* utf32_to_utf8(const char32_t* p, const char32_t* last, char* out){
+    while(p != last){
+#ifdef SIMD_SSE2
+        if(last - p >= 16){
+            const __m128i a = load(p), b = load(p + 4), c = load(p + 8), d = load(p + 12);
+            if(fits_epi32(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), 0x7F)){
+                store(out, _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+                out += 16;
+                p += 16;
+                continue;
+            }
+            for(const char32_t* stop = p + 16; p != stop; ++p)
+                out = encode(out, sanitize(*p));
+            continue;
+        }
+#endif
+        out = encode(out, sanitize(*p++));
+    }
+    return out;
+}
+
+inline SizeType utf32_size(const char16_t* p, const char16_t* last){
+    SizeType n = 0;
+    while(p != last){
+        const char16_t* stop = last;
+#ifdef SIMD_SSE2
+        if(last - p >= 8){
+            if(!has_surrogate_epi16(load(p))){
+                n += 8;
+                p += 8;
+                continue;
+            }
+            stop = p + 8;
+        }
+#endif
+        do{
+            char32_t cp;
+            p += decode(p, last, cp);
+            n++;
+        } while(p < stop);
+    }
+    return n;
+}
+
+inline char32_t* utf16_to_utf32(const char16_t* p, const char16_t* last, char32_t* out){
+    while(p != last){
+        const char16_t* stop = last;
+#ifdef SIMD_SSE2
+        if(last - p >= 8){
+            const __m128i units = load(p);
+            if(!has_surrogate_epi16(units)){
+                const __m128i zero = _mm_setzero_si128();
+                store(out, _mm_unpacklo_epi16(units, zero));
+                store(out + 4, _mm_unpackhi_epi16(units, zero));
+                out += 8;
+                p += 8;
+                continue;
+            }
+            stop = p + 8;
+        }
+#endif
+        do{
+            char32_t cp;
+            p += decode(p, last, cp);
+            *out++ = cp;
+        } while(p < stop);
+    }
+    return out;
+}
+
+inline SizeType utf16_size(const char32_t* p, const char32_t* last){
+    SizeType n = 0;
+    for(; p != last; ++p)
+        n += 1 + (sanitize(*p) >= 0x10000);
+    return n;
+}
+
+inline char16_t* utf32_to_utf16(const char32_t* p, const char32_t* last, char16_t* out){
+    while(p != last){
+#ifdef SIMD_SSE2
+        if(last - p >= 8){
+            const __m128i low = load(p), high = load(p + 4);
+            if(fits_epi32(_mm_or_si128(low, high), 0xFFFF) && !has_surrogate_epi32(_mm_or_si128(low, high))){
+                // SSE2 only packs signed 32 bit values, so shift the range down and back
+                const __m128i bias = _mm_set1_epi32(0x8000);
+                const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(low, bias), _mm_sub_epi32(high, bias));
+                store(out, _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000))));
+                out += 8;
+                p += 8;
+                continue;
+            }
+            for(const char32_t* stop = p + 8; p != stop; ++p)
+                out = encode(out, sanitize(*p));
+            continue;
+        }
+#endif
+        out = encode(out, sanitize(*p++));
+    }
+    return out;
+}
+
+//! Appends \a size units produced by \a write(first, last, out)
+template<typename Char, typename Allocator, typename In, typename Writer>
+inline void append(Basic_fstring<Char, Allocator>& str, const In* first, const In* last, SizeType size, Writer write){
+    str.resize_and_overwrite(str.size() + size, [&](Char* data, SizeType){
+        return static_cast<SizeType>(write(first, last, data + str.size()) - data);
+    });
+}
+
+} // namespace transcode_detail
+
+
+//! Appends UTF-8 \a str to \a out as UTF-16. Malformed sequences become
+//! U+FFFD; valid input (the usual case, checked with is_valid_utf8) is
+//! sized exactly, otherwise the buffer may be larger than needed.
+template<typename Allocator>
+inline void append_utf16(Basic_fstring<char16_t, Allocator>& out, FStringView str){
+    using namespace transcode_detail;
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(str.data());
+    const unsigned char* last = first + str.size();
+    const SizeType size = is_valid_utf8(str) ? count_code_points(str) + count_four_byte_leads(first, last) : str.size();
+    append(out, first, last, size, utf8_to<char16_t>);
+}
+
+//! Appends UTF-32 \a str to \a out as UTF-16. Surrogates and values beyond
+//! U+10FFFF become U+FFFD.
+template<typename Allocator>
+inline void append_utf16(Basic_fstring<char16_t, Allocator>& out, F32StringView str){
+    using namespace transcode_detail;
+    const char32_t* first = str.data();
+    const char32_t* last = first + str.size();
+    append(out, first, last, utf16_size(first, last), utf32_to_utf16);
+}
+
+//! Appends UTF-8 \a str to \a out as UTF-32, malformed sequences become U+FFFD
+template<typename Allocator>
+inline void append_utf32(Basic_fstring<char32_t, Allocator>& out, FStringView str){
+    using namespace transcode_detail;
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(str.data());
+    const unsigned char* last = first + str.size();
+    const SizeType size = is_valid_utf8(str) ? count_code_points(str) : str.size();
+    append(out, first, last, size, utf8_to<char32_t>);
+}
+
+//! Appends UTF-16 \a str to \a out as UTF-32, unpaired surrogates become U+FFFD
+template<typename Allocator>
+inline void append_utf32(Basic_fstring<char32_t, Allocator>& out, F16StringView str){
+    using namespace transcode_detail;
+    const char16_t* first = str.data();
+    const char16_t* last = first + str.size();
+    append(out, first, last, utf32_size(first, last), utf16_to_utf32);
+}
+
+//! Appends UTF-16 \a str to \a out as UTF-8, unpaired surrogates become U+FFFD
+template<typename Allocator>
+inline void append_utf8(Basic_fstring<char, Allocator>& out, F16StringView str){
+    using namespace transcode_detail;
+    const char16_t* first = str.data();
+    const char16_t* last = first + str.size();
+    append(out, first, last, utf8_size(first, last), utf16_to_utf8);
+}
+
+//! Appends UTF-32 \a str to \a out as UTF-8. Surrogates and values beyond
+//! U+10FFFF become U+FFFD.
+template<typename Allocator>
+inline void append_utf8(Basic_fstring<char, Allocator>& out, F32StringView str){
+    using namespace transcode_detail;
+    const char32_t* first = str.data();
+    const char32_t* last = first + str.size();
+    append(out, first, last, utf8_size(first, last), utf32_to_utf8);
+}
+
+inline F16String to_utf16(FStringView str){
+    F16String out;
+    append_utf16(out, str);
+    return out;
+}
+
+inline F16String to_utf16(F32StringView str){
+    F16String out;
+    append_utf16(out, str);
+    return out;
+}
+
+inline F32String to_utf32(FStringView str){
+    F32String out;
+    append_utf32(out, str);
+    return out;
+}
+
+inline F32String to_utf32(F16StringView str){
+    F32String out;
+    append_utf32(out, str);
+    return out;
+}
+
+inline FString to_utf8(F16StringView str){
+    FString out;
+    append_utf8(out, str);
+    return out;
+}
+
+inline FString to_utf8(F32StringView str){
+    FString out;
+    append_utf8(out, str);
+    return out;
+}
+
+#endif // UNICODE_HPP
@@ -3,11 +3,26 @@
 #include "HashMap.hpp"
 #include "FVector.hpp"
 #include "String.hpp"
+#include "CharConv.hpp"
+#include "StringAlgorithms.hpp"
+#include "Unicode.hpp"
+#include "MultiMatcher.hpp"
+#include "SharedString.hpp"
+#include "Rope.hpp"
+#include "Escape.hpp"
+#include "SmallFVector.hpp"
+#include "MemoryAllocator.hpp"
+#include "SoAVector.hpp"
 
 #include <deque>
 #include <iomanip>
 #include <bitset>
 #include <chrono>
+#include <sstream>
+#include <random>
+#include <cstdio>
+#include <codecvt>
+#include <locale>
 
 using namespace std;
 
@@ -84,6 +99,982 @@ void __attribute__((optimize("O0"))) test_FVector(){
     }
 }
 
+//! The loops FString::find and FString::rfind used before the SIMD kernels
+SizeType naive_find(const FString& s, char ch, SizeType pos = 0){
+    for(unsigned i = pos; i < s.size(); i++)
+        if(s[i] == ch)
+            return i;
+    return FString::npos;
+}
+
+SizeType naive_find(const FString& s, const FString& str, SizeType pos = 0){
+    for(unsigned i = pos; i < s.size(); i++){
+        unsigned j = 0;
+        for(; j < str.size() && (i+j) < s.size(); j++)
+            if(s[i+j] != str[j])
+                break;
+        if(j == str.size())
+            return i;
+    }
+    return FString::npos;
+}
+
+SizeType naive_rfind(const FString& s, char ch){
+    for(unsigned i = s.size() - 1; ; i--){
+        if(s[i] == ch)
+            return i;
+        if(i == 0)
+            break;
+    }
+    return FString::npos;
+}
+
+FString make_lexer_input(){
+    std::string input;
+    for(int i = 0; input.size() < (1u << 20); i++)
+        input += "    auto identifier_" + std::to_string(i) + " = compute(lhs, rhs) * factor_value; // trailing comment\n";
+    input += "return;";
+    return input;
+}
+
+template<typename Finder>
+void scan_delimiters(const FString& input, Finder finder){
+    SizeType count = 0;
+    for(int round = 0; round < 20; round++)
+        for(SizeType pos = finder(input, ';', 0); pos != FString::npos; pos = finder(input, ';', pos + 1))
+            ++count;
+    std::cout << "  found " << count << " delimiters, ";
+}
+
+template<typename Finder>
+void scan_keyword(const FString& input, const FString& keyword, Finder finder){
+    SizeType count = 0;
+    for(int round = 0; round < 20; round++)
+        for(SizeType pos = finder(input, keyword, 0); pos != FString::npos; pos = finder(input, keyword, pos + 1))
+            ++count;
+    std::cout << "  found " << count << " keywords, ";
+}
+
+void benchmark_find(){
+    const FString input = make_lexer_input();
+    const FString keyword = "compute(";
+    const FString rare = "\nreturn;";
+
+    cout << "FString::find(char) naive loop....\n";
+    timeit([&]{ scan_delimiters(input, [](const FString& s, char c, SizeType p){ return naive_find(s, c, p); }); });
+    cout << "FString::find(char) SIMD....\n";
+    timeit([&]{ scan_delimiters(input, [](const FString& s, char c, SizeType p){ return s.find(c, p); }); });
+
+    cout << "FString::find(FString) naive loop....\n";
+    timeit([&]{ scan_keyword(input, keyword, [](const FString& s, const FString& k, SizeType p){ return naive_find(s, k, p); }); });
+    cout << "FString::find(FString) SIMD....\n";
+    timeit([&]{ scan_keyword(input, keyword, [](const FString& s, const FString& k, SizeType p){ return s.find(k, p); }); });
+
+    cout << "FString::find(rare FString) naive loop....\n";
+    timeit([&]{ scan_keyword(input, rare, [](const FString& s, const FString& k, SizeType p){ return naive_find(s, k, p); }); });
+    cout << "FString::find(rare FString) SIMD....\n";
+    timeit([&]{ scan_keyword(input, rare, [](const FString& s, const FString& k, SizeType p){ return s.find(k, p); }); });
+
+    cout << "FString::rfind(char) naive loop....\n";
+    timeit([&]{ volatile SizeType r = 0; for(int i = 0; i < 200; i++) r = r + naive_rfind(input, '@'); });
+    cout << "FString::rfind(char) SIMD....\n";
+    timeit([&]{ volatile SizeType r = 0; for(int i = 0; i < 200; i++) r = r + input.rfind('@'); });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_getline(){
+    std::stringstream source;
+    for(int i = 0; i < 200000; i++)
+        source << "record " << i << ", some payload that is longer than the small buffer\n";
+    const std::string input = source.str();
+
+    cout << "getline through a std::string temporary....\n";
+    timeit([&]{
+        std::stringstream ss(input);
+        std::string tmp; FString line; SizeType total = 0;
+        while(std::getline(ss, tmp)){ line = tmp; total += line.size(); }
+        std::cout << "  read " << total << " characters, ";
+    });
+    cout << "getline directly into FString....\n";
+    timeit([&]{
+        std::stringstream ss(input);
+        FString line; SizeType total = 0;
+        while(std::getline(ss, line)) total += line.size();
+        std::cout << "  read " << total << " characters, ";
+    });
+    cout << "\n---------------------\n";
+}
+
+//! Numbers the way they show up in JSON documents: integers, short decimals,
+//! coordinates with many digits and a few exponents
+FVector<FString> make_json_numbers(){
+    FVector<FString> numbers;
+    std::mt19937_64 gen(2016);
+    char buffer[64];
+    for(int i = 0; i < 500000; i++){
+        switch(i % 4){
+        case 0: std::snprintf(buffer, sizeof(buffer), "%d", int(gen() % 100000)); break;
+        case 1: std::snprintf(buffer, sizeof(buffer), "%.2f", double(gen() % 1000000) / 100); break;
+        case 2: std::snprintf(buffer, sizeof(buffer), "%.15g", double(gen() % 360000000000) / 1e9 - 180); break;
+        default: std::snprintf(buffer, sizeof(buffer), "%.6e", double(gen() % 1000000) * 1e-12); break;
+        }
+        numbers.push_back(FString(static_cast<const char*>(buffer)));
+    }
+    return numbers;
+}
+
+void benchmark_number_parsing(){
+    const FVector<FString> numbers = make_json_numbers();
+
+    cout << "strtod on a JSON number corpus....\n";
+    timeit([&]{
+        double sum = 0;
+        for(int r = 0; r < 4; r++)
+            for(const auto& n : numbers) sum += std::strtod(n.c_str(), nullptr);
+        std::cout << "  sum " << sum << ", ";
+    });
+    cout << "to_string + std::stod on a JSON number corpus....\n";
+    timeit([&]{
+        double sum = 0;
+        for(int r = 0; r < 4; r++)
+            for(const auto& n : numbers) sum += std::stod(n.to_string());
+        std::cout << "  sum " << sum << ", ";
+    });
+    cout << "parse_number(double) on a JSON number corpus....\n";
+    timeit([&]{
+        double sum = 0, d = 0;
+        for(int r = 0; r < 4; r++)
+            for(const auto& n : numbers){ parse_number(n, d); sum += d; }
+        std::cout << "  sum " << sum << ", ";
+    });
+
+    cout << "strtoll on integers....\n";
+    timeit([&]{
+        long long sum = 0;
+        for(int r = 0; r < 4; r++)
+            for(SizeType i = 0; i < numbers.size(); i += 4) sum += std::strtoll(numbers[i].c_str(), nullptr, 10);
+        std::cout << "  sum " << sum << ", ";
+    });
+    cout << "parse_number(long long) on integers....\n";
+    timeit([&]{
+        long long sum = 0, v = 0;
+        for(int r = 0; r < 4; r++)
+            for(SizeType i = 0; i < numbers.size(); i += 4){ parse_number(numbers[i], v); sum += v; }
+        std::cout << "  sum " << sum << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_number_formatting(){
+    std::mt19937_64 gen(2016);
+    FVector<long long> integers;
+    FVector<double> doubles;
+    for(int i = 0; i < 500000; i++){
+        integers.push_back(static_cast<long long>(gen() % 2000000) - 1000000);
+        doubles.push_back(double(gen() % 100000000) / 1000);
+    }
+
+    cout << "std::to_string + FString copy on integers....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        for(auto v : integers) total += FString(std::to_string(v)).size();
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "FString::from_integer on integers....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        for(auto v : integers) total += FString::from_integer(v).size();
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "snprintf(%.17g) + FString copy on doubles....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        char buffer[32];
+        for(auto v : doubles){
+            std::snprintf(buffer, sizeof(buffer), "%.17g", v);
+            total += FString(static_cast<const char*>(buffer)).size();
+        }
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "FString::from_double (shortest round trip) on doubles....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        for(auto v : doubles) total += FString::from_double(v).size();
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "append_number into one FString....\n";
+    timeit([&]{
+        FString out;
+        for(SizeType i = 0; i < doubles.size(); i++)
+            out.append_number(integers[i]).append_number(doubles[i]);
+        std::cout << "  chars " << out.size() << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+//! Builds scope-qualified names the way a semantic pass mangles symbols
+void benchmark_concatenation(){
+    FVector<FString> scopes, names;
+    for(int i = 0; i < 1000; i++){
+        scopes.push_back(FString("namespace_") + FString::from_integer(i));
+        names.push_back(FString("member") + FString::from_integer(i * 7));
+    }
+
+    cout << "std::string operator+ for qualified names....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        for(int r = 0; r < 200; r++)
+            for(SizeType i = 0; i < names.size(); i++){
+                std::string s = scopes[i].to_string() + "::" + names[i].to_string() + '@' + scopes[r].to_string();
+                total += s.size();
+            }
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "FString chained appends for qualified names....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        for(int r = 0; r < 200; r++)
+            for(SizeType i = 0; i < names.size(); i++){
+                FString s = scopes[i];
+                s.append(FStringView("::")).append(names[i]).push_back('@');
+                s.append(scopes[r]);
+                total += s.size();
+            }
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "FString concatenation expressions for qualified names....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        for(int r = 0; r < 200; r++)
+            for(SizeType i = 0; i < names.size(); i++){
+                FString s = scopes[i] + "::" + names[i] + '@' + scopes[r];
+                total += s.size();
+            }
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_split(){
+    std::string text;
+    std::mt19937 gen(2016);
+    for(int i = 0; i < 200000; i++){
+        text += "field" + std::to_string(gen() % 1000);
+        text += ",;| \t"[gen() % 5];
+    }
+    const FString input(text);
+
+    cout << "find + substr on ','....\n";
+    timeit([&]{
+        SizeType count = 0, start = 0, pos;
+        while((pos = input.find(',', start)) != FString::npos){
+            count += input.substr(start, pos - start).size() > 0;
+            start = pos + 1;
+        }
+        std::cout << "  pieces " << count << ", ";
+    });
+    cout << "split(str, ',')....\n";
+    timeit([&]{
+        SizeType count = 0;
+        for(FStringView piece : split(input, ','))
+            count += piece.size() > 0;
+        std::cout << "  pieces " << count << ", ";
+    });
+    cout << "strpbrk on \",;| \\t\"....\n";
+    timeit([&]{
+        SizeType count = 0;
+        for(const char* p = input.c_str(); (p = std::strpbrk(p, ",;| \t")) != nullptr; ++p)
+            count++;
+        std::cout << "  delimiters " << count << ", ";
+    });
+    cout << "split_any(str, \",;| \\t\")....\n";
+    timeit([&]{
+        SizeType count = 0;
+        for(FStringView piece : split_any(input, ",;| \t"))
+            count += piece.size() > 0;
+        std::cout << "  pieces " << count << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+//! Source text with deep indentation, long identifiers and numbers
+FString make_source_text(){
+    std::string text;
+    std::mt19937 gen(2016);
+    for(int line = 0; line < 50000; line++){
+        text.append(4 * (gen() % 8), ' ');
+        for(int token = gen() % 4; token >= 0; token--){
+            text += "some_fairly_long_identifier_" + std::to_string(gen() % 100000);
+            text += " = 1234567 ";
+        }
+        text += ";   \n";
+    }
+    return FString(text);
+}
+
+void benchmark_char_classes(){
+    const FString source = make_source_text();
+    const auto is_space = [](char c){ return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; };
+    const auto is_ident = [](char c){ return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; };
+
+    cout << "Scalar operator[] loops over whitespace and identifiers....\n";
+    timeit([&]{
+        SizeType tokens = 0, i = 0;
+        const SizeType n = source.size();
+        while(i < n){
+            while(i < n && is_space(source[i])) ++i;
+            const SizeType start = i;
+            while(i < n && is_ident(source[i])) ++i;
+            if(i == start) ++i;
+            tokens++;
+        }
+        std::cout << "  tokens " << tokens << ", ";
+    });
+    cout << "skip_while with compile time character classes....\n";
+    timeit([&]{
+        SizeType tokens = 0, i = 0;
+        const FStringView text = source;
+        const SizeType n = text.size();
+        while(i < n){
+            i = skip_while(text, char_class::whitespace, i);
+            const SizeType start = i;
+            i = skip_while(text, char_class::identifier, i);
+            if(i == start) ++i;
+            tokens++;
+        }
+        std::cout << "  tokens " << tokens << ", ";
+    });
+
+    FVector<FString> lines;
+    for(FStringView line : split(source, '\n'))
+        lines.push_back(FString(line));
+    cout << "Scalar trim of every line....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        for(const auto& line : lines){
+            SizeType first = 0, last = line.size();
+            while(first < last && is_space(line[first])) ++first;
+            while(last > first && is_space(line[last - 1])) --last;
+            total += last - first;
+        }
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "trim() of every line....\n";
+    timeit([&]{
+        std::size_t total = 0;
+        for(const auto& line : lines)
+            total += trim(line).size();
+        std::cout << "  chars " << total << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+FString make_utf8_text(){
+    // Mostly ASCII prose with accented Latin, Greek, CJK and emoji mixed in
+    const char* const words[] = { "parser", "naïve", "café", "λόγος", "語彙", "token", "😀", "grammar", "Ärger", "tree" };
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> pick(0, 9);
+    FString text;
+    while(text.size() < (1u << 22)){
+        text += words[pick(gen)];
+        text += ' ';
+    }
+    return text;
+}
+
+void benchmark_utf8(){
+    const FString text = make_utf8_text();
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* last = first + text.size();
+
+    cout << "Scalar UTF-8 validation....\n";
+    timeit([&]{
+        std::cout << "  valid " << (utf8_detail::find_invalid_scalar(first, last) == nullptr) << ", ";
+    });
+    cout << "is_valid_utf8....\n";
+    timeit([&]{
+        std::cout << "  valid " << is_valid_utf8(text) << ", ";
+    });
+    cout << "Scalar code point count....\n";
+    timeit([&]{
+        std::cout << "  code points " << utf8_detail::count_scalar(first, last) << ", ";
+    });
+    cout << "count_code_points....\n";
+    timeit([&]{
+        std::cout << "  code points " << count_code_points(text) << ", ";
+    });
+    cout << "Iterating code_points()....\n";
+    timeit([&]{
+        char32_t sum = 0;
+        for(char32_t cp : code_points(text))
+            sum += cp;
+        std::cout << "  checksum " << static_cast<uint32_t>(sum) << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_transcoding(){
+    const FString text = make_utf8_text();
+    const std::string std_text = text.to_string();
+    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> converter;
+    const std::u16string std_utf16 = converter.from_bytes(std_text);
+    const F16String utf16 = to_utf16(text);
+
+    cout << "codecvt UTF-8 to UTF-16....\n";
+    timeit([&]{
+        std::cout << "  units " << converter.from_bytes(std_text).size() << ", ";
+    });
+    cout << "to_utf16....\n";
+    timeit([&]{
+        std::cout << "  units " << to_utf16(text).size() << ", ";
+    });
+    cout << "codecvt UTF-16 to UTF-8....\n";
+    timeit([&]{
+        std::cout << "  bytes " << converter.to_bytes(std_utf16).size() << ", ";
+    });
+    cout << "to_utf8....\n";
+    timeit([&]{
+        std::cout << "  bytes " << to_utf8(utf16).size() << ", ";
+    });
+    const FString source = make_source_text();
+    const std::string std_source = source.to_string();
+    cout << "codecvt UTF-8 to UTF-16 of ASCII source....\n";
+    timeit([&]{
+        std::cout << "  units " << converter.from_bytes(std_source).size() << ", ";
+    });
+    cout << "to_utf16 of ASCII source....\n";
+    timeit([&]{
+        std::cout << "  units " << to_utf16(source).size() << ", ";
+    });
+    cout << "to_utf32 from UTF-16....\n";
+    timeit([&]{
+        std::cout << "  code points " << to_utf32(utf16).size() << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_keyword_lookup(){
+    const char* const keywords[] = { "select", "from", "where", "group", "by", "order", "having", "insert",
+                                     "into", "values", "update", "delete", "join", "inner", "outer", "distinct" };
+    HashMap<FString, int> lowered;
+    HashMap<FString, int, CaseInsensitiveHash, CaseInsensitiveEqual> folded;
+    for(int i = 0; i < 16; i++){
+        lowered.insert({FString(FStringView(keywords[i])), i});
+        folded.insert({FString(FStringView(keywords[i])), i});
+    }
+
+    // Mixed case keywords and identifiers
+    std::mt19937 gen(3);
+    FVector<FString> tokens;
+    for(int i = 0; i < 400000; i++){
+        FString token = gen() % 2 ? FString(FStringView(keywords[gen() % 16])) : FString("customer_identifier");
+        for(SizeType k = 0; k < token.size(); k++)
+            if(gen() % 2 && token[k] >= 'a' && token[k] <= 'z')
+                token[k] = static_cast<char>(token[k] - 32);
+        tokens.push_back(token);
+    }
+
+    cout << "Lowercasing every token before lookup....\n";
+    timeit([&]{
+        int hits = 0;
+        for(const auto& token : tokens){
+            FString lower(token);
+            for(SizeType k = 0; k < lower.size(); k++)
+                lower[k] = static_cast<char>(std::tolower(static_cast<unsigned char>(lower[k])));
+            hits += lowered.find(lower) != lowered.end();
+        }
+        std::cout << "  hits " << hits << ", ";
+    });
+    cout << "CaseInsensitiveHash and CaseInsensitiveEqual....\n";
+    timeit([&]{
+        int hits = 0;
+        for(const auto& token : tokens)
+            hits += folded.find(token.view()) != folded.end();
+        std::cout << "  hits " << hits << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_literal_lookup(){
+    HashMap<FString, int> table;
+    const char* const names[] = { "int", "long", "short", "char", "bool", "float", "double", "void" };
+    for(int i = 0; i < 8; i++)
+        table.insert({FString(FStringView(names[i])), i});
+
+    cout << "Looking up FStrings built from literals....\n";
+    timeit([&]{
+        int hits = 0;
+        for(int i = 0; i < 1000000; i++){
+            hits += table.find(FString("double")) != table.end();
+            hits += table.find(FString("unsigned")) != table.end();
+        }
+        std::cout << "  hits " << hits << ", ";
+    });
+    cout << "Looking up FS() literals, hashed at compile time....\n";
+    timeit([&]{
+        int hits = 0;
+        for(int i = 0; i < 1000000; i++){
+            hits += table.find(FS("double")) != table.end();
+            hits += table.find(FS("unsigned")) != table.end();
+        }
+        std::cout << "  hits " << hits << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+//! An AST pass copies its doc comments and string literals to the next
+template<typename Str>
+void copy_between_passes(const std::vector<Str>& nodes){
+    std::size_t total = 0;
+    for(int pass = 0; pass < 200; pass++){
+        std::vector<Str> next(nodes);
+        total += next[pass].size();
+    }
+    std::cout << "  chars " << total << ", ";
+}
+
+void benchmark_shared_strings(){
+    std::mt19937 gen(5);
+    std::vector<FString> owned;
+    std::vector<SharedFString> shared;
+    for(int i = 0; i < 5000; i++){
+        const FString comment(FStringView(std::string(64 + gen() % 512, 'c')));
+        owned.push_back(comment);
+        shared.push_back(comment);
+    }
+
+    cout << "Copying FString doc comments between passes....\n";
+    timeit([&]{ copy_between_passes(owned); });
+    cout << "Copying SharedFString doc comments between passes....\n";
+    timeit([&]{ copy_between_passes(shared); });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_rope(){
+    const std::string piece(4000, 'Q');
+    const int pieces = 8000;
+
+    cout << "Growing a 32MB payload in one FString....\n";
+    timeit([&]{
+        FString blob;
+        for(int i = 0; i < pieces; i++)
+            blob.append(FStringView(piece));
+        std::cout << "  size " << blob.size() << ", largest block " << blob.capacity() << ", ";
+    });
+    cout << "Growing a 32MB payload in an FRope....\n";
+    timeit([&]{
+        FRope blob;
+        for(int i = 0; i < pieces; i++)
+            blob.append(FStringView(piece));
+        std::cout << "  size " << blob.size() << ", largest block " << FRope::kChunkSize << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+//! The char by char loop escape_json replaces
+std::string escape_json_naive(const std::string& str){
+    std::string out;
+    for(char c : str){
+        switch(c){
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20){
+                    char hex[8];
+                    std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+                    out += hex;
+                }
+                else
+                    out += c;
+        }
+    }
+    return out;
+}
+
+std::string unescape_json_naive(const std::string& str){
+    std::string out;
+    for(std::size_t i = 0; i < str.size(); i++){
+        if(str[i] != '\\'){
+            out += str[i];
+            continue;
+        }
+        switch(str[++i]){
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            default: out += str[i];
+        }
+    }
+    return out;
+}
+
+void benchmark_escaping(){
+    std::mt19937 gen(13);
+    std::vector<std::string> strings;
+    for(int i = 0; i < 20000; i++){
+        std::string str(16 + gen() % 200, 'a');
+        for(char& c : str)
+            c = static_cast<char>('a' + gen() % 26);
+        if(gen() % 4 == 0)
+            str[gen() % str.size()] = '"';
+        if(gen() % 4 == 0)
+            str[gen() % str.size()] = '\n';
+        strings.push_back(str);
+    }
+    std::vector<std::string> escaped;
+    for(const auto& str : strings)
+        escaped.push_back(escape_json_naive(str));
+
+    cout << "Escaping char by char into std::string....\n";
+    timeit([&]{
+        std::size_t n = 0;
+        for(int r = 0; r < 10; r++)
+            for(const auto& str : strings)
+                n += escape_json_naive(str).size();
+        std::cout << "  chars " << n << ", ";
+    });
+    cout << "append_json_escaped....\n";
+    timeit([&]{
+        std::size_t n = 0;
+        FString out;
+        for(int r = 0; r < 10; r++)
+            for(const auto& str : strings){
+                out.clear();
+                append_json_escaped(out, FStringView(str));
+                n += out.size();
+            }
+        std::cout << "  chars " << n << ", ";
+    });
+    cout << "Unescaping char by char into std::string....\n";
+    timeit([&]{
+        std::size_t n = 0;
+        for(int r = 0; r < 10; r++)
+            for(const auto& str : escaped)
+                n += unescape_json_naive(str).size();
+        std::cout << "  chars " << n << ", ";
+    });
+    cout << "unescape_json....\n";
+    timeit([&]{
+        std::size_t n = 0;
+        FString buffer;
+        for(int r = 0; r < 10; r++)
+            for(const auto& str : escaped)
+                n += unescape_json(FStringView(str), buffer).str.size();
+        std::cout << "  chars " << n << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+//! The quadratic recurrence nearest_keys replaces
+SizeType levenshtein_dp(FStringView a, FStringView b){
+    std::vector<SizeType> row(b.size() + 1);
+    for(SizeType j = 0; j <= b.size(); j++)
+        row[j] = j;
+    for(SizeType i = 1; i <= a.size(); i++){
+        SizeType diagonal = row[0];
+        row[0] = i;
+        for(SizeType j = 1; j <= b.size(); j++){
+            const SizeType up = row[j];
+            row[j] = std::min({ up + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1) });
+            diagonal = up;
+        }
+    }
+    return row[b.size()];
+}
+
+void benchmark_nearest_keys(){
+    std::mt19937 gen(17);
+    HashMap<FString, int> symbols;
+    for(int i = 0; i < 100000; i++){
+        std::string name(4 + gen() % 20, 'a');
+        for(char& c : name)
+            c = "abcdefghijklmnopqrstuvwxyz_"[gen() % 27];
+        symbols.insert({FString(FStringView(name)), i});
+    }
+    const FStringView queries[] = { "get_value", "parse_expression", "tokn", "symbol_table_entry" };
+
+    cout << "Quadratic Levenshtein against every symbol....\n";
+    timeit([&]{
+        SizeType near = 0;
+        for(FStringView query : queries)
+            for(const auto& entry : symbols)
+                near += levenshtein_dp(query, entry.first) <= 2;
+        std::cout << "  near " << near << ", ";
+    });
+    cout << "nearest_keys....\n";
+    timeit([&]{
+        SizeType near = 0;
+        for(FStringView query : queries)
+            near += nearest_keys(symbols, query, 1000, 2).size();
+        std::cout << "  near " << near << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_replace_all(){
+    std::string text;
+    std::mt19937 gen(23);
+    while(text.size() < 1000000)
+        text += gen() % 8 ? "int value = compute(input);\n" : "LOG(MODULE_NAME, value);\n";
+
+    cout << "Expanding a macro with std::string::find and replace....\n";
+    timeit([&]{
+        std::string str = text;
+        std::size_t n = 0;
+        for(std::size_t pos = 0; (pos = str.find("MODULE_NAME", pos)) != std::string::npos; pos += 19, n++)
+            str.replace(pos, 11, "parser_core_module");
+        std::cout << "  replaced " << n << ", size " << str.size() << ", ";
+    });
+    cout << "Expanding a macro with FString::replace_all....\n";
+    timeit([&]{
+        FString str{FStringView(text)};
+        const SizeType n = str.replace_all("MODULE_NAME", "parser_core_module");
+        std::cout << "  replaced " << n << ", size " << str.size() << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_join(){
+    std::mt19937 gen(29);
+    std::vector<std::vector<FString>> paths;
+    for(int i = 0; i < 100000; i++){
+        std::vector<FString> segments;
+        for(int k = 0, n = 3 + gen() % 6; k < n; k++)
+            segments.push_back(FString(FStringView(std::string(3 + gen() % 10, static_cast<char>('a' + k)))));
+        paths.push_back(segments);
+    }
+
+    cout << "Joining path segments piece by piece....\n";
+    timeit([&]{
+        std::size_t n = 0;
+        for(const auto& segments : paths){
+            FString path;
+            for(std::size_t k = 0; k < segments.size(); k++){
+                if(k)
+                    path.push_back('/');
+                path.append(segments[k].view());
+            }
+            n += path.size();
+        }
+        std::cout << "  chars " << n << ", ";
+    });
+    cout << "Joining path segments with join....\n";
+    timeit([&]{
+        std::size_t n = 0;
+        for(const auto& segments : paths)
+            n += join(segments, '/').size();
+        std::cout << "  chars " << n << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+template<typename Children>
+struct TreeNode{
+    int kind;
+    Children children;
+};
+
+//! Builds a parser-shaped tree, most nodes having 0 to 4 children
+template<typename Children>
+std::size_t build_tree(std::size_t count, std::mt19937& gen){
+    std::vector<TreeNode<Children>> nodes(count);
+    std::size_t edges = 0;
+    for(std::size_t i = 1; i < count; i++){
+        TreeNode<Children>& node = nodes[i];
+        node.kind = static_cast<int>(i % 7);
+        for(int k = 0, n = gen() % 5; k < n; k++)
+            node.children.push_back(static_cast<SizeType>(gen() % count));
+        for(SizeType k = 0; k < node.children.size(); k++)
+            edges += nodes[node.children[k]].kind;
+    }
+    return edges;
+}
+
+void benchmark_small_vector(){
+    cout << "Building 1M AST nodes with FVector children....\n";
+    timeit([&]{
+        std::mt19937 gen(31);
+        std::cout << "  edges " << build_tree<FVector<SizeType>>(1000000, gen) << ", ";
+    });
+    cout << "Building 1M AST nodes with SmallFVector children....\n";
+    timeit([&]{
+        std::mt19937 gen(31);
+        std::cout << "  edges " << build_tree<SmallFVector<SizeType, 4>>(1000000, gen) << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+struct BenchToken{
+    SizeType kind;
+    SizeType offset;
+    SizeType length;
+    SizeType flags;
+};
+
+void benchmark_vector_growth(){
+    cout << "Growing an FVector to 20M tokens....\n";
+    timeit([&]{
+        FVector<BenchToken> tokens;
+        for(SizeType i = 0; i < 20000000; i++)
+            tokens.push_back(BenchToken{ i % 13, i, 3, 0 });
+        std::cout << "  tokens " << tokens.size() << ", ";
+    });
+    cout << "Growing an FVector to 2M strings....\n";
+    timeit([&]{
+        FVector<FString> strings;
+        for(SizeType i = 0; i < 2000000; i++)
+            strings.emplace_back("identifier");
+        std::cout << "  strings " << strings.size() << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+template<typename Offsets>
+void grow_offset_table(){
+    Offsets offsets;
+    for(SizeType i = 0; i < 64000000; i++)
+        offsets.push_back(i);
+    std::cout << "  offsets " << offsets.size() << ", ";
+}
+
+void benchmark_mapped_growth(){
+    cout << "Growing a 256MB offset table with SFAllocator....\n";
+    timeit([&]{ grow_offset_table<FVector<SizeType>>(); });
+    cout << "Growing a 256MB offset table with MappedAllocator....\n";
+    timeit([&]{ grow_offset_table<FVector<SizeType, MappedAllocator<SizeType>>>(); });
+    cout << "\n---------------------\n";
+}
+
+void benchmark_bulk_append(){
+    std::vector<char> input(64 << 20);
+    for(std::size_t i = 0; i < input.size(); i++)
+        input[i] = static_cast<char>(i * 131);
+
+    cout << "Copying 64MB in 4KB reads, element by element....\n";
+    timeit([&]{
+        FVector<char> out;
+        for(std::size_t at = 0; at < input.size(); at += 4096)
+            for(std::size_t i = at; i < at + 4096; i++)
+                out.push_back(input[i]);
+        std::cout << "  bytes " << out.size() << ", ";
+    });
+    cout << "Copying 64MB in 4KB reads with append....\n";
+    timeit([&]{
+        FVector<char> out;
+        for(std::size_t at = 0; at < input.size(); at += 4096)
+            out.append(input.data() + at, 4096);
+        std::cout << "  bytes " << out.size() << ", ";
+    });
+    cout << "Copying 64MB in 4KB reads into resize_uninitialized....\n";
+    timeit([&]{
+        FVector<char> out;
+        out.reserve(static_cast<SizeType>(input.size()));
+        for(std::size_t at = 0; at < input.size(); at += 4096){
+            const SizeType size = out.size();
+            out.resize_uninitialized(size + 4096);
+            std::memcpy(out.data() + size, input.data() + at, 4096);
+        }
+        std::cout << "  bytes " << out.size() << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+struct LexedToken{
+    uint16_t kind;
+    uint16_t flags;
+    uint32_t offset;
+    uint32_t length;
+};
+
+void benchmark_soa_tokens(){
+    std::mt19937 gen(37);
+    FVector<LexedToken> rows;
+    FSoAVector<uint16_t, uint16_t, uint32_t, uint32_t> columns;
+    for(uint32_t i = 0; i < 10000000; i++){
+        const uint16_t kind = static_cast<uint16_t>(gen() % 40);
+        rows.push_back(LexedToken{ kind, 0, i * 4, 3 });
+        columns.push_back(kind, 0, i * 4, 3);
+    }
+
+    cout << "Counting one kind in 10M tokens, FVector<Token>....\n";
+    timeit([&]{
+        std::size_t n = 0;
+        for(int pass = 0; pass < 10; pass++)
+            for(SizeType i = 0; i < rows.size(); i++)
+                n += rows[i].kind == 7;
+        std::cout << "  matches " << n << ", ";
+    });
+    cout << "Counting one kind in 10M tokens, FSoAVector column....\n";
+    timeit([&]{
+        std::size_t n = 0;
+        for(int pass = 0; pass < 10; pass++){
+            const FSpan<const uint16_t> kinds = static_cast<const decltype(columns)&>(columns).column<0>();
+            for(SizeType i = 0; i < kinds.size(); i++)
+                n += kinds[i] == 7;
+        }
+        std::cout << "  matches " << n << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
+FString make_log_text(){
+    const char* const words[] = { "GET", "/index.html", "200", "user=alice", "latency_ms=12", "POST", "/api/v1/items",
+                                  "201", "session", "cache", "hit", "miss", "upstream", "connect", "ok" };
+    std::mt19937 gen(11);
+    FString text;
+    while(text.size() < (1u << 22)){
+        for(int w = 0; w < 8; w++){
+            text += words[gen() % 15];
+            text += ' ';
+        }
+        if(gen() % 50 == 0)
+            text += "ERROR upstream timeout ";
+        text += '\n';
+    }
+    return text;
+}
+
+void benchmark_multi_matcher(){
+    const FString text = make_log_text();
+    FVector<FString> patterns;
+    const char* const small[] = { "ERROR", "WARN", "FATAL", "timeout", "refused", "panic", "denied", "overflow" };
+    for(const char* p : small)
+        patterns.push_back(FString(FStringView(p)));
+
+    const auto find_each = [&](SizeType count){
+        SizeType matches = 0;
+        for(SizeType k = 0; k < count; k++)
+            for(SizeType pos = text.find(patterns[k]); pos != FString::npos; pos = text.find(patterns[k], pos + 1))
+                matches++;
+        return matches;
+    };
+
+    cout << "FString::find once per pattern, 8 patterns....\n";
+    timeit([&]{ std::cout << "  matches " << find_each(8) << ", "; });
+    const MultiMatcher teddy(patterns.begin(), patterns.end());
+    cout << "MultiMatcher, 8 patterns (" << (teddy.engine() == MatchEngine::Teddy ? "Teddy" : "Aho-Corasick") << ")....\n";
+    timeit([&]{
+        SizeType matches = 0;
+        teddy.for_each_match(text, [&](PatternMatch){ matches++; });
+        std::cout << "  matches " << matches << ", ";
+    });
+
+    for(int i = 0; i < 56; i++)
+        patterns.push_back(FString("code_") + FString::from_integer(i * 7919));
+    patterns.push_back(FString("timeout"));
+    cout << "FString::find once per pattern, 65 patterns....\n";
+    timeit([&]{ std::cout << "  matches " << find_each(patterns.size()) << ", "; });
+    const MultiMatcher automaton(patterns.begin(), patterns.end());
+    cout << "MultiMatcher, 65 patterns (" << (automaton.engine() == MatchEngine::Teddy ? "Teddy" : "Aho-Corasick") << ")....\n";
+    timeit([&]{
+        SizeType matches = 0;
+        automaton.for_each_match(text, [&](PatternMatch){ matches++; });
+        std::cout << "  matches " << matches << ", ";
+    });
+    cout << "\n---------------------\n";
+}
+
 struct S{ char ch[24]; };
 
 int main()
@@ -95,6 +1086,30 @@ int main()
     //rmpx.erase("Funny");
     mpx.erase(mpx.begin());
 
+    benchmark_find();
+    benchmark_getline();
+    benchmark_number_parsing();
+    benchmark_number_formatting();
+    benchmark_concatenation();
+    benchmark_split();
+    benchmark_char_classes();
+    benchmark_utf8();
+    benchmark_transcoding();
+    benchmark_keyword_lookup();
+    benchmark_literal_lookup();
+    benchmark_shared_strings();
+    benchmark_rope();
+    benchmark_escaping();
+    benchmark_nearest_keys();
+    benchmark_replace_all();
+    benchmark_join();
+    benchmark_small_vector();
+    benchmark_vector_growth();
+    benchmark_mapped_growth();
+    benchmark_bulk_append();
+    benchmark_soa_tokens();
+    benchmark_multi_matcher();
+
 /*
     cout << "Running CustomString....\n";
     timeit(randomString);
@@ -0,0 +1,230 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <random>
+#include <cstring>
+#include "CharConv.hpp"
+
+namespace {
+
+template<typename T>
+bool parses_to(const char* text, T expected){
+    T value{};
+    auto result = parse_number(FStringView(text), value);
+    return result && value == expected && result.ptr == text + std::strlen(text);
+}
+
+template<typename T>
+std::errc parse_error(const char* text){
+    T value{};
+    return parse_number(FStringView(text), value).ec;
+}
+
+bool same_bits(double a, double b){
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+bool matches_strtod(const std::string& text){
+    double value = 0;
+    auto result = parse_number(FStringView(text), value);
+    return result && result.ptr == text.data() + text.size() && same_bits(value, std::strtod(text.c_str(), nullptr));
+}
+
+}
+
+TEST_CASE( "Parsing integers", "[charconv]" ) {
+    REQUIRE( parses_to<int>("0", 0) );
+    REQUIRE( parses_to<int>("-0", 0) );
+    REQUIRE( parses_to<int>("42", 42) );
+    REQUIRE( parses_to<int>("-2147483648", std::numeric_limits<int>::min()) );
+    REQUIRE( parses_to<int>("2147483647", std::numeric_limits<int>::max()) );
+    REQUIRE( parses_to<unsigned>("4294967295", 4294967295u) );
+    REQUIRE( parses_to<long long>("-9223372036854775808", std::numeric_limits<long long>::min()) );
+    REQUIRE( parses_to<unsigned long long>("18446744073709551615", 18446744073709551615ULL) );
+    REQUIRE( parses_to<unsigned long long>("000000000000000000000000012345678901234", 12345678901234ULL) );
+    REQUIRE( parses_to<short>("-32768", short(-32768)) );
+    REQUIRE( parses_to<unsigned char>("255", static_cast<unsigned char>(255)) );
+
+    REQUIRE( parse_error<int>("2147483648") == std::errc::result_out_of_range );
+    REQUIRE( parse_error<int>("-2147483649") == std::errc::result_out_of_range );
+    REQUIRE( parse_error<unsigned long long>("18446744073709551616") == std::errc::result_out_of_range );
+    REQUIRE( parse_error<unsigned long long>("99999999999999999999") == std::errc::result_out_of_range );
+    REQUIRE( parse_error<unsigned long long>("123456789012345678901") == std::errc::result_out_of_range );
+    REQUIRE( parse_error<unsigned char>("256") == std::errc::result_out_of_range );
+    REQUIRE( parse_error<unsigned>("-1") == std::errc::invalid_argument );
+    REQUIRE( parse_error<int>("") == std::errc::invalid_argument );
+    REQUIRE( parse_error<int>("-") == std::errc::invalid_argument );
+    REQUIRE( parse_error<int>("+1") == std::errc::invalid_argument );
+
+    SECTION( "Parsing stops at the first non digit and leaves the value on error" ){
+        FString token = "12345678901,rest";
+        long long value = 7;
+        auto result = parse_number(token, value);
+        REQUIRE( result );
+        REQUIRE( value == 12345678901LL );
+        REQUIRE( *result.ptr == ',' );
+
+        int small = 7;
+        REQUIRE( !parse_number("x1", small) );
+        REQUIRE( small == 7 );
+    }
+
+    SECTION( "Every length of digit run agrees with strtoull" ){
+        std::string digits;
+        for(int i = 0; i < 19; i++){
+            digits += char('1' + (i * 7) % 9);
+            REQUIRE( parses_to<unsigned long long>(digits.c_str(), std::strtoull(digits.c_str(), nullptr, 10)) );
+        }
+    }
+}
+
+TEST_CASE( "Parsing doubles", "[charconv]" ) {
+    const char* cases[] = {
+        "0", "-0", "0.0", "1", "-1", "3.14159", "1e10", "1E-10", "1.5e+3", ".5", "5.", "-.25",
+        "123456789012345678", "9007199254740993", "0.1", "0.3", "2.2250738585072011e-308",
+        "2.2250738585072014e-308", "4.9406564584124654e-324", "1.7976931348623157e308",
+        "123456789012345678901234567890", "0.000000000000000000000000000123456789",
+        "3.141592653589793238462643383279502884197169399375105820974944",
+        "7.2057594037927933e16", "9007199254740992.5", "9007199254740993.0000000000000000000001",
+        "1e-300", "1e300", "2.5e-320", "6.02214076e23", "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124", "00000012.5"
+    };
+    for(auto text : cases){
+        INFO( text );
+        REQUIRE( matches_strtod(text) );
+    }
+
+    SECTION( "Out of range and malformed input" ){
+        double value = 42;
+        REQUIRE( parse_number("1e400", value).ec == std::errc::result_out_of_range );
+        REQUIRE( parse_number("-1e400", value).ec == std::errc::result_out_of_range );
+        REQUIRE( parse_number("1e-400", value).ec == std::errc::result_out_of_range );
+        REQUIRE( parse_number(".", value).ec == std::errc::invalid_argument );
+        REQUIRE( parse_number("-", value).ec == std::errc::invalid_argument );
+        REQUIRE( parse_number("e5", value).ec == std::errc::invalid_argument );
+        REQUIRE( value == 42 );
+
+        auto result = parse_number("2.5e", value);
+        REQUIRE( result );
+        REQUIRE( value == 2.5 );
+        REQUIRE( *result.ptr == 'e' );
+    }
+
+    SECTION( "Random numbers round trip like strtod" ){
+        std::mt19937_64 gen(29);
+        char buffer[64];
+        for(int i = 0; i < 20000; i++){
+            const uint64_t bits = gen();
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            if(d != d || std::abs(d) > std::numeric_limits<double>::max())
+                continue;
+            std::snprintf(buffer, sizeof(buffer), i % 3 == 0 ? "%.17g" : (i % 3 == 1 ? "%.6e" : "%.25g"), d);
+            INFO( buffer );
+            REQUIRE( matches_strtod(buffer) );
+        }
+        std::uniform_int_distribution<int> digits(1, 30), exps(-30, 30);
+        for(int i = 0; i < 20000; i++){
+            std::string text = std::to_string(gen() % 1000000) + "." ;
+            for(int d = digits(gen); d > 0; d--)
+                text += char('0' + gen() % 10);
+            text += "e" + std::to_string(exps(gen));
+            INFO( text );
+            REQUIRE( matches_strtod(text) );
+        }
+    }
+}
+
+TEST_CASE( "Formatting integers", "[charconv]" ) {
+    REQUIRE( FString::from_integer(0) == "0" );
+    REQUIRE( FString::from_integer(-7) == "-7" );
+    REQUIRE( FString::from_integer(1234567).size() == 7 );
+    REQUIRE( FString::from_integer(std::numeric_limits<int64_t>::min()).to_string() == "-9223372036854775808" );
+    REQUIRE( FString::from_integer(std::numeric_limits<uint64_t>::max()).to_string() == "18446744073709551615" );
+    REQUIRE( FString::from_integer(static_cast<unsigned char>(255)) == "255" );
+
+    std::mt19937_64 gen(30);
+    for(int i = 0; i < 20000; i++){
+        const int64_t value = static_cast<int64_t>(gen()) >> (gen() % 64);
+        REQUIRE( FString::from_integer(value).to_string() == std::to_string(value) );
+    }
+
+    FString str("id=");
+    str.append_number(42).append_number(-1).append_number(100u);
+    REQUIRE( str == "id=42-1100" );
+    REQUIRE( str.size() == 10 );
+
+    F32String wide = F32String::from_integer(-305);
+    REQUIRE( wide.size() == 4 );
+    REQUIRE( wide[0] == U'-' );
+    REQUIRE( wide[3] == U'5' );
+}
+
+TEST_CASE( "Formatting doubles", "[charconv]" ) {
+    REQUIRE( FString::from_double(0.0) == "0" );
+    REQUIRE( FString::from_double(-0.0) == "-0" );
+    REQUIRE( FString::from_double(1.0) == "1" );
+    REQUIRE( FString::from_double(-2.5) == "-2.5" );
+    REQUIRE( FString::from_double(0.1).to_string() == "0.1" );
+    REQUIRE( FString::from_double(0.001).to_string() == "0.001" );
+    REQUIRE( FString::from_double(1.5e-7).to_string() == "1.5e-07" );
+    REQUIRE( FString::from_double(123456.0).to_string() == "123456" );
+    REQUIRE( FString::from_double(1e21).to_string() == "1e+21" );
+    REQUIRE( FString::from_double(1e100).to_string() == "1e+100" );
+    REQUIRE( FString::from_double(5e-324).to_string() == "5e-324" );
+    REQUIRE( FString::from_double(1.7976931348623157e308).to_string() == "1.7976931348623157e+308" );
+    REQUIRE( FString::from_double(std::numeric_limits<double>::infinity()).to_string() == "inf" );
+    REQUIRE( FString::from_double(-std::numeric_limits<double>::infinity()).to_string() == "-inf" );
+    REQUIRE( FString::from_double(std::numeric_limits<double>::quiet_NaN()).to_string() == "nan" );
+
+    SECTION( "Shortest round trip" ){
+        std::mt19937_64 gen(31);
+        for(int i = 0; i < 50000; i++){
+            const uint64_t bits = gen();
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            if(d != d || std::abs(d) > std::numeric_limits<double>::max())
+                continue;
+            const FString text = FString::from_double(d);
+            INFO( text );
+            double back = 0;
+            REQUIRE( parse_number(text, back) );
+            REQUIRE( same_bits(back, d) );
+
+            // No representation with one significant digit less round trips
+            int digits = 0, zeros = 0;
+            for(SizeType k = 0; k < text.size() && text[k] != 'e'; k++){
+                if(text[k] < '0' || text[k] > '9' || (!digits && text[k] == '0'))
+                    continue;
+                zeros = text[k] == '0' ? zeros + 1 : 0;
+                digits++;
+            }
+            digits -= zeros;
+            if(digits > 1){
+                char shorter[64];
+                std::snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, d);
+                REQUIRE_FALSE( same_bits(std::strtod(shorter, nullptr), d) );
+            }
+        }
+    }
+
+    SECTION( "Appending" ){
+        FString str("[");
+        str.append_number(0.5).append_number(-3.25e-10);
+        REQUIRE( str.to_string() == "[0.5-3.25e-10" );
+        REQUIRE( F16String::from_double(0.25).size() == 4 );
+    }
+}
@@ -0,0 +1,113 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include "Escape.hpp"
+
+namespace {
+
+std::string unescaped(const std::string& str){
+    FString buffer;
+    const UnescapeResult result = unescape_json(FStringView(str), buffer);
+    REQUIRE( result );
+    return result.str.to_string();
+}
+
+}
+
+TEST_CASE( "Escaping strings for JSON", "[escape]" ) {
+    SECTION("Clean strings are copied as they are"){
+        const std::string clean(100, 'a');
+        REQUIRE( escape_json(FStringView(clean)).to_string() == clean );
+        REQUIRE( escape_json(FStringView("caf\xc3\xa9")).to_string() == "caf\xc3\xa9" );
+        REQUIRE( escape_json(FStringView("")).empty() );
+    }
+
+    SECTION("Quotes, backslashes and controls are escaped"){
+        REQUIRE( escape_json(FStringView("say \"hi\"\n")).to_string() == "say \\\"hi\\\"\\n" );
+        REQUIRE( escape_json(FStringView("C:\\dir\ttab\r\b\f")).to_string() == "C:\\\\dir\\ttab\\r\\b\\f" );
+        REQUIRE( escape_json(FStringView("\x01\x1f" "x", 3)).to_string() == "\\u0001\\u001fx" );
+        REQUIRE( escape_json(FStringView("a\0b", 3)).to_string() == "a\\u0000b" );
+        REQUIRE( escape_json(FStringView("\x7f" " /")).to_string() == "\x7f /" );
+    }
+
+    SECTION("Every position of a long string, to cover the block loops"){
+        for(std::size_t at = 0; at < 70; at++){
+            std::string str(70, 'x');
+            str[at] = '"';
+            std::string expected = str;
+            expected.replace(at, 1, "\\\"");
+            REQUIRE( escape_json(FStringView(str)).to_string() == expected );
+        }
+    }
+
+    SECTION("Appending keeps what is already there"){
+        FString out = "\"";
+        append_json_escaped(out, FStringView("a\\b"));
+        out += '"';
+        REQUIRE( out.to_string() == "\"a\\\\b\"" );
+    }
+}
+
+TEST_CASE( "Unescaping JSON strings", "[escape]" ) {
+    SECTION("Strings without escapes are returned as views of the input"){
+        const FStringView input("no escapes here, just a fairly long string");
+        FString buffer;
+        const UnescapeResult result = unescape_json(input, buffer);
+        REQUIRE( result );
+        REQUIRE( result.str.data() == input.data() );
+        REQUIRE( result.str.size() == input.size() );
+        REQUIRE( buffer.capacity() == FString::kSS - 1 );
+    }
+
+    SECTION("Short escapes"){
+        REQUIRE( unescaped("a\\nb") == "a\nb" );
+        REQUIRE( unescaped("\\\"\\\\\\/\\b\\f\\n\\r\\t") == "\"\\/\b\f\n\r\t" );
+        REQUIRE( unescaped(std::string(40, 'y') + "\\t" + std::string(40, 'z')) ==
+                 std::string(40, 'y') + "\t" + std::string(40, 'z') );
+    }
+
+    SECTION("Unicode escapes and surrogate pairs become UTF-8"){
+        REQUIRE( unescaped("\\u0041") == "A" );
+        REQUIRE( unescaped("caf\\u00e9") == "caf\xc3\xa9" );
+        REQUIRE( unescaped("\\u20AC") == "\xe2\x82\xac" );
+        REQUIRE( unescaped("\\ud83d\\ude00!") == "\xf0\x9f\x98\x80!" );
+        REQUIRE( unescaped("\\u0000") == std::string(1, '\0') );
+    }
+
+    SECTION("Lone surrogates become U+FFFD"){
+        REQUIRE( unescaped("\\ud83d") == "\xef\xbf\xbd" );
+        REQUIRE( unescaped("\\ude00x") == "\xef\xbf\xbdx" );
+        REQUIRE( unescaped("\\ud83d\\u0041") == "\xef\xbf\xbd" "A" );
+    }
+
+    SECTION("Malformed escapes are reported"){
+        FString buffer;
+        const std::string bad[] = { "abc\\", "\\x41", "\\u12", "\\u12g4", "ok\\q" };
+        for(const std::string& str : bad){
+            const UnescapeResult result = unescape_json(FStringView(str), buffer);
+            REQUIRE( !result );
+            REQUIRE( result.ec == std::errc::invalid_argument );
+            REQUIRE( *result.ptr == '\\' );
+        }
+    }
+
+    SECTION("Round trips"){
+        std::string all;
+        for(int c = 1; c < 256; c++)
+            all += static_cast<char>(c);
+        all += std::string(1, '\0') + "tail";
+        const FString escaped = escape_json(FStringView(all));
+        REQUIRE( unescaped(escaped.to_string()) == all );
+    }
+}
@@ -18,6 +18,8 @@
 #include <functional>
 #include <iostream>
 #include <unordered_map>
+#include <random>
+#include <iterator>
 #include "HashMap.hpp"
 #include "String.hpp"
 #include <string>
@@ -255,3 +257,82 @@ TEST_CASE( "HashMaps should work", "[hash_map]" ) {
     }
 
 }
+
+TEST_CASE( "HashMaps keep every entry when they grow", "[hash_map]" ) {
+    HashMap<int, int> mp;
+    for(int i = 0; i < 5000; i++)
+        mp[i] = i * 2;
+
+    REQUIRE( mp.size() == 5000 );
+    for(int i = 0; i < 5000; i++){
+        REQUIRE( mp.find(i) != mp.end() );
+        REQUIRE( mp.find(i)->second == i * 2 );
+    }
+
+    HashMap<FStringView, int> views;
+    std::vector<std::string> keys;
+    for(int i = 0; i < 500; i++)
+        keys.push_back("key" + std::to_string(i));
+    for(int i = 0; i < 500; i++)
+        views[keys[i]] = i;
+    for(int i = 0; i < 500; i++)
+        REQUIRE( views[keys[i]] == i );
+    REQUIRE( views.size() == 500 );
+}
+
+TEST_CASE( "HashMaps never duplicate a key at the end of a chain", "[hash_map]" ) {
+    // Few buckets, so most keys sit in chains and some are their last node
+    HashMap<int, int> mp;
+    std::unordered_map<int, int> expected;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(0, 1999);
+    for(int i = 0; i < 3000; i++){
+        const int k = dist(gen);
+        REQUIRE( mp.insert({k, i}).second == expected.insert({k, i}).second );
+    }
+    REQUIRE( mp.size() == expected.size() );
+    REQUIRE( std::distance(mp.begin(), mp.end()) == static_cast<std::ptrdiff_t>(expected.size()) );
+
+    for(const auto& kv : expected){
+        REQUIRE( mp.insert({kv.first, -1}).second == false );
+        REQUIRE( mp[kv.first] == kv.second );
+    }
+    REQUIRE( mp.size() == expected.size() );
+}
+
+TEST_CASE( "HashMaps take their hash and key equality as parameters", "[hash_map]" ) {
+    // Keys are equal when they are congruent modulo 10
+    auto hash = [](int x){ return static_cast<SizeType>(x % 10); };
+    auto equal = [](int x, int y){ return x % 10 == y % 10; };
+    HashMap<int, int, decltype(hash), decltype(equal)> mp(hash, equal);
+
+    for(int i = 0; i < 100; i++)
+        mp.insert({i, i});
+    REQUIRE( mp.size() == 10 );
+    REQUIRE( mp.find(47)->second == 7 );
+    REQUIRE( mp.count(1003) == 1 );
+
+    auto copy = mp;
+    REQUIRE( copy.find(12)->second == 2 );
+    auto moved = std::move(copy);
+    REQUIRE( moved.size() == 10 );
+    REQUIRE( moved.erase(25) == 1 );
+    REQUIRE( moved.find(5) == moved.end() );
+}
+
+TEST_CASE( "HashMaps keyed by strings are searched with views and literals", "[hash_map]" ) {
+    HashMap<FString, int> keywords;
+    keywords.insert({"if", 1});
+    keywords.insert({"while", 2});
+    keywords.insert({"return", 3});
+
+    REQUIRE( keywords.find(FS("while"))->second == 2 );
+    REQUIRE( keywords.count(FS("whil")) == 0 );
+    REQUIRE( keywords.find(FStringView("return value", 6))->second == 3 );
+    REQUIRE( keywords.count("if") == 1 );
+    REQUIRE( keywords.count(std::string("if")) == 1 );
+
+    REQUIRE( hash_it(FString("return")) == FS("return").hash() );
+    REQUIRE( hash_it(FStringView("return")) == FS("return").hash() );
+    REQUIRE( hash_it(FString("a\0b")) != hash_it(FString("a\0c")) );
+}
@@ -1,8 +1,17 @@
 
 #include "MemoryAllocator.hpp"
+#include "FVector.hpp"
+#include "String.hpp"
+#include "HashMap.hpp"
+#include "StringAlgorithms.hpp"
+#include "Unicode.hpp"
+#include "Escape.hpp"
+#include "SharedString.hpp"
+#include "Rope.hpp"
 #include "catch.hpp"
 #include <string>
 #include <vector>
+#include <cstring>
 
 class CX {
 public:
@@ -49,3 +58,184 @@ TEST_CASE( "Memory Allocator", "[memory]" ){
     //REQUIRE(  )
 }
 
+
+TEST_CASE( "Mapped buffers grow in place of copies", "[memory]" ){
+    using Offsets = FVector<uint32_t, MappedAllocator<uint32_t, 4096>>;
+
+    SECTION("Crossing the threshold both ways keeps the elements"){
+        Offsets v;
+        for(uint32_t i = 0; i < 100000; i++)
+            v.push_back(i * 3);
+        REQUIRE( v.size() == 100000 );
+        bool intact = true;
+        for(uint32_t i = 0; i < v.size(); i++)
+            intact = intact && v[i] == i * 3;
+        REQUIRE( intact );
+
+        v.resize(100);
+        v.shrink_to_fit();
+        REQUIRE( v.capacity() == 100 );
+        REQUIRE( v[99] == 297 );
+        v.reserve(50000);
+        REQUIRE( v[99] == 297 );
+        REQUIRE( v.capacity() == 50000 );
+
+        Offsets moved = std::move(v);
+        REQUIRE( moved.size() == 100 );
+        Offsets copied = moved;
+        REQUIRE( copied[50] == 150 );
+    }
+
+    SECTION("Relocatable strings survive mremap"){
+        FVector<FString, MappedAllocator<FString, 4096>> strings;
+        for(int i = 0; i < 20000; i++)
+            strings.push_back(FString(std::to_string(i) + " is a string longer than the small buffer"));
+        REQUIRE( strings[19999] == FString(std::string("19999 is a string longer than the small buffer")) );
+        strings.erase(strings.begin(), strings.begin() + 19990);
+        strings.shrink_to_fit();
+        REQUIRE( strings[0] == FString(std::string("19990 is a string longer than the small buffer")) );
+    }
+
+    SECTION("The allocator on its own"){
+        using Mapped = MappedAllocator<char, 4096>;
+        char* small = static_cast<char*>(Mapped::allocate(100));
+        std::memset(small, 'a', 100);
+        char* big = static_cast<char*>(Mapped::reallocate(small, 1 << 20));
+        REQUIRE( big[99] == 'a' );
+        big[(1 << 20) - 1] = 'z';
+        big = static_cast<char*>(Mapped::reallocate(big, 1 << 24));
+        REQUIRE( big[(1 << 20) - 1] == 'z' );
+        char* back = static_cast<char*>(Mapped::reallocate(big, 10));
+        REQUIRE( back[9] == 'a' );
+        Mapped::deallocate(back);
+        Mapped::deallocate(nullptr);
+    }
+}
+
+//! Counts the live blocks of every type it is rebound to
+struct LiveBlocks{
+    static int count;
+};
+
+int LiveBlocks::count = 0;
+
+template<typename T>
+struct CountingAllocator {
+    template<typename U>
+    using rebind = CountingAllocator<U>;
+
+    static void* allocate(SizeType sz){
+        ++LiveBlocks::count;
+        return SFAllocator<T>::allocate(sz);
+    }
+    static void* reallocate(void* m, SizeType sz){
+        if(!m)
+            ++LiveBlocks::count;
+        return SFAllocator<T>::reallocate(m, sz);
+    }
+    static void deallocate(void* m){
+        if(m)
+            --LiveBlocks::count;
+        SFAllocator<T>::deallocate(m);
+    }
+};
+
+TEST_CASE( "Containers take their memory from an allocator policy", "[memory]" ){
+    using CountedString = Basic_fstring<char, CountingAllocator<char>>;
+    using CountedMap = HashMap<FString, int, HashIt<FString>, std::equal_to<>, CountingAllocator<std::pair<const FString, int>>>;
+
+    static_assert(sizeof(CountedString) == sizeof(FString), "a policy adds nothing to the object");
+    static_assert(sizeof(FVector<int, CountingAllocator<int>>) == sizeof(FVector<int>), "a policy adds nothing to the object");
+    static_assert(sizeof(CountedMap) == sizeof(HashMap<FString, int>), "a policy adds nothing to the object");
+
+    LiveBlocks::count = 0;
+    {
+        CountedString str("a string that does not fit the small buffer");
+        REQUIRE( LiveBlocks::count == 1 );
+        str += " and grows";
+        str.replace_all("small", "tiny");
+        CountedString copy = str;
+        REQUIRE( LiveBlocks::count == 2 );
+        REQUIRE( copy == str );
+        REQUIRE( copy.view() == FStringView("a string that does not fit the tiny buffer and grows") );
+        REQUIRE( CountedString("short") < CountedString("shorter") );
+
+        FVector<int, CountingAllocator<int>> v;
+        for(int i = 0; i < 100; i++)
+            v.push_back(i);
+        REQUIRE( LiveBlocks::count == 3 );
+
+        CountedMap map;
+        map.insert({ FString("one"), 1 });
+        map.insert({ FString("two"), 2 });
+        REQUIRE( map.find(FStringView("two"))->second == 2 );
+        REQUIRE( LiveBlocks::count == 6 );
+        map.erase(FString("one"));
+        REQUIRE( LiveBlocks::count == 5 );
+
+        auto node = map.extract(FString("two"));
+        REQUIRE( LiveBlocks::count == 5 );
+    }
+    REQUIRE( LiveBlocks::count == 0 );
+}
+
+TEST_CASE( "String algorithms accept strings of any allocator policy", "[memory]" ){
+    using CountedString = Basic_fstring<char, CountingAllocator<char>>;
+    using Counted16String = Basic_fstring<char16_t, CountingAllocator<char16_t>>;
+    using Counted32String = Basic_fstring<char32_t, CountingAllocator<char32_t>>;
+
+    LiveBlocks::count = 0;
+    {
+        const CountedString line("  alpha beta,gamma  \t");
+        REQUIRE( trim(line) == FStringView("alpha beta,gamma") );
+        REQUIRE( ltrim(line).size() == line.size() - 2 );
+        REQUIRE( rtrim(line).size() == line.size() - 3 );
+        REQUIRE( skip_while(line, char_class::blank) == 2 );
+        REQUIRE( skip_until(line, CharSet(",")) == 12 );
+
+        std::vector<std::string> fields;
+        for(FStringView field : split(line, ' ', SplitMode::SkipEmpty))
+            fields.push_back(field.to_string());
+        REQUIRE(( fields == std::vector<std::string>{ "alpha", "beta,gamma", "\t" } ));
+        REQUIRE( std::distance(split(line, ",").begin(), split(line, ",").end()) == 2 );
+        REQUIRE( std::distance(split(line, FStringView("a ")).begin(), split(line, FStringView("a ")).end()) == 3 );
+        REQUIRE( std::distance(split_any(line, CharSet(" ,"), SplitMode::SkipEmpty).begin(),
+                               split_any(line, CharSet(" ,"), SplitMode::SkipEmpty).end()) == 4 );
+
+        const char text[] = "na\xc3\xafve \xf0\x9f\x98\x80";
+        Counted16String utf16;
+        append_utf16(utf16, FStringView(text));
+        REQUIRE( utf16.size() == 8 );
+        Counted32String utf32;
+        append_utf32(utf32, FStringView(text));
+        REQUIRE( utf32.size() == 7 );
+        CountedString utf8;
+        append_utf8(utf8, utf16.view());
+        append_utf8(utf8, utf32.view());
+        REQUIRE( utf8.view() == FStringView("na\xc3\xafve \xf0\x9f\x98\x80na\xc3\xafve \xf0\x9f\x98\x80") );
+        utf16.clear();
+        append_utf16(utf16, utf32.view());
+        REQUIRE( utf16.size() == 8 );
+        utf32.clear();
+        append_utf32(utf32, utf16.view());
+        REQUIRE( utf32.size() == 7 );
+
+        CountedString escaped;
+        append_json_escaped(escaped, FStringView("say \"hi\"\n"));
+        REQUIRE( escaped.view() == FStringView("say \\\"hi\\\"\\n") );
+        CountedString buffer;
+        const UnescapeResult unescaped = unescape_json(escaped.view(), buffer);
+        REQUIRE( unescaped );
+        REQUIRE( unescaped.str == FStringView("say \"hi\"\n") );
+        REQUIRE( unescaped.str.data() == buffer.data() );
+
+        const SharedFString shared(line);
+        REQUIRE( shared == line );
+        REQUIRE_FALSE( shared != line );
+        FRope rope;
+        rope += line;
+        REQUIRE( rope == line );
+        REQUIRE( LiveBlocks::count > 0 );
+    }
+    REQUIRE( LiveBlocks::count == 0 );
+}
@@ -0,0 +1,113 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include "MultiMatcher.hpp"
+
+namespace {
+
+std::vector<PatternMatch> brute_force(const std::vector<std::string>& patterns, const std::string& text){
+    std::vector<PatternMatch> matches;
+    for(SizeType pos = 0; pos < text.size(); pos++)
+        for(SizeType id = 0; id < patterns.size(); id++)
+            if(!patterns[id].empty() && text.compare(pos, patterns[id].size(), patterns[id]) == 0)
+                matches.push_back({id, pos});
+    return matches;
+}
+
+std::vector<PatternMatch> found(const MultiMatcher& matcher, const std::string& text){
+    const auto all = matcher.find_all(FStringView(text));
+    return std::vector<PatternMatch>(all.begin(), all.end());
+}
+
+std::string random_string(std::mt19937& gen, std::size_t n, const char* alphabet){
+    const std::size_t letters = std::strlen(alphabet);
+    std::string s;
+    for(std::size_t i = 0; i < n; i++)
+        s += alphabet[gen() % letters];
+    return s;
+}
+
+}
+
+TEST_CASE("Multi-pattern matching", "[multi_matcher]"){
+    const MatchEngine engines[] = { MatchEngine::Automatic, MatchEngine::Teddy, MatchEngine::AhoCorasick };
+
+    SECTION("Keywords in a log line"){
+        for(MatchEngine engine : engines){
+            const MultiMatcher matcher({"ERROR", "WARN", "timeout", "time"}, engine);
+            const std::string line = "12:00 WARN connect timeout; ERROR: timeout again";
+            const std::vector<PatternMatch> expected = { {1, 6}, {3, 19}, {2, 19}, {0, 28}, {3, 35}, {2, 35} };
+            auto sorted = expected;
+            std::sort(sorted.begin(), sorted.end());
+            REQUIRE(found(matcher, line) == sorted);
+        }
+    }
+
+    SECTION("Engine selection"){
+        std::vector<std::string> many;
+        for(int i = 0; i < 100; i++)
+            many.push_back("keyword" + std::to_string(i));
+        REQUIRE(MultiMatcher(many.begin(), many.end(), MatchEngine::Teddy).engine() == MatchEngine::AhoCorasick);
+        REQUIRE(MultiMatcher({"a", "b"}, MatchEngine::AhoCorasick).engine() == MatchEngine::AhoCorasick);
+        REQUIRE(MultiMatcher({"a", "b"}, MatchEngine::Teddy).engine() == MatchEngine::Teddy);
+        REQUIRE(MultiMatcher({"", ""}, MatchEngine::Teddy).engine() == MatchEngine::AhoCorasick);
+    }
+
+    SECTION("Empty patterns, empty text and duplicates"){
+        for(MatchEngine engine : engines){
+            REQUIRE(found(MultiMatcher(), "abc").empty());
+            const MultiMatcher matcher({"", "ab", "ab", "b"}, engine);
+            REQUIRE(matcher.size() == 4);
+            REQUIRE(matcher.pattern(2) == FStringView("ab"));
+            REQUIRE(found(matcher, "").empty());
+            const std::vector<PatternMatch> expected = { {1, 0}, {2, 0}, {3, 1}, {1, 2}, {2, 2}, {3, 3} };
+            REQUIRE(found(matcher, "abab") == expected);
+        }
+    }
+
+    SECTION("Agrees with brute force on random patterns and texts"){
+        std::mt19937 gen(37);
+        for(int round = 0; round < 60; round++){
+            const SizeType count = 1 + gen() % (round < 30 ? 12 : 80);
+            const char* alphabet = round % 3 == 0 ? "ab" : round % 3 == 1 ? "abcd" : "abcdefghij\xF0\x80";
+            std::vector<std::string> patterns;
+            for(SizeType i = 0; i < count; i++)
+                patterns.push_back(random_string(gen, gen() % 7, alphabet));
+            const std::string text = random_string(gen, gen() % 300, alphabet);
+            const auto expected = brute_force(patterns, text);
+            for(MatchEngine engine : engines){
+                const MultiMatcher matcher(patterns.begin(), patterns.end(), engine);
+                REQUIRE(found(matcher, text) == expected);
+                const MultiMatcher copy = matcher;
+                REQUIRE(found(copy, text) == expected);
+            }
+        }
+    }
+
+    SECTION("Matches across block boundaries"){
+        for(MatchEngine engine : engines){
+            const MultiMatcher matcher({"needle", "xyz"}, engine);
+            for(SizeType at = 0; at + 6 <= 64; at++){
+                std::string text(64, '.');
+                text.replace(at, 6, "needle");
+                const std::vector<PatternMatch> expected = { {0, at} };
+                REQUIRE(found(matcher, text) == expected);
+            }
+        }
+    }
+}
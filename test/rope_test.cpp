@@ -0,0 +1,115 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include <sstream>
+#include <random>
+#include "Rope.hpp"
+
+namespace {
+
+std::string make_payload(std::size_t size){
+    const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string str(size, ' ');
+    for(std::size_t i = 0; i < size; i++)
+        str[i] = alphabet[(i * 7 + i / 64) % 64];
+    return str;
+}
+
+}
+
+TEST_CASE( "Ropes keep large strings in chunks", "[rope]" ) {
+    const std::string payload = make_payload(5 * FRope::kChunkSize + 123);
+
+    SECTION("Appending in pieces of any size"){
+        FRope rope;
+        std::mt19937 gen(7);
+        std::size_t pos = 0;
+        while(pos < payload.size()){
+            const std::size_t n = std::min<std::size_t>(gen() % 3000, payload.size() - pos);
+            rope.append(payload.data() + pos, static_cast<SizeType>(n));
+            pos += n;
+        }
+        REQUIRE( rope.size() == payload.size() );
+        REQUIRE( rope.chunk_count() == 6 );
+        for(SizeType i = 0; i + 1 < rope.chunk_count(); i++)
+            REQUIRE( rope.chunk(i).size() == FRope::kChunkSize );
+        REQUIRE( rope == FStringView(payload) );
+        REQUIRE( rope.flatten().view() == FStringView(payload) );
+        REQUIRE( std::string(rope.begin(), rope.end()) == payload );
+    }
+
+    SECTION("Indexing and slicing across chunk boundaries"){
+        const FRope rope{FStringView(payload)};
+        for(SizeType i = 0; i < payload.size(); i += 997)
+            REQUIRE( rope[i] == payload[i] );
+        REQUIRE( rope[rope.size() - 1] == payload.back() );
+
+        const SizeType start = FRope::kChunkSize - 10;
+        const FRopeSlice slice = rope.slice(start, 2 * FRope::kChunkSize);
+        REQUIRE( slice.size() == 2 * FRope::kChunkSize );
+        REQUIRE( slice.flatten().to_string() == payload.substr(start, 2 * FRope::kChunkSize) );
+        REQUIRE( slice[15] == payload[start + 15] );
+
+        SizeType pieces = 0;
+        slice.for_each_piece([&pieces](FStringView){ pieces++; });
+        REQUIRE( pieces == 3 );
+
+        REQUIRE( slice.slice(5, 20).flatten().to_string() == payload.substr(start + 5, 20) );
+        REQUIRE( rope.slice(rope.size() - 3).flatten().to_string() == payload.substr(payload.size() - 3) );
+        REQUIRE( rope.slice(rope.size()).empty() );
+
+        std::string copied(40, ' ');
+        REQUIRE( rope.copy(&copied[0], 40, start) == 40 );
+        REQUIRE( copied == payload.substr(start, 40) );
+    }
+
+    SECTION("Splicing another rope moves its chunks"){
+        FRope head{FStringView("<<EOF\n")};
+        FRope body{FStringView(payload)};
+        const FStringView first_chunk = body.chunk(0);
+        head.append(std::move(body));
+        head += "\nEOF";
+        REQUIRE( body.empty() );
+        REQUIRE( static_cast<const void*>(head.chunk(1).data()) == static_cast<const void*>(first_chunk.data()) );
+        REQUIRE( head == FStringView("<<EOF\n" + payload + "\nEOF") );
+        REQUIRE( head[6] == payload[0] );
+        REQUIRE( head.slice(3, 10).flatten().to_string() == ("<<EOF\n" + payload).substr(3, 10) );
+    }
+
+    SECTION("Copying, moving and clearing"){
+        FRope rope{FStringView(payload)};
+        FRope copy = rope;
+        REQUIRE( copy == FStringView(payload) );
+        copy.append(copy);
+        REQUIRE( copy.size() == 2 * payload.size() );
+        REQUIRE( copy.slice(payload.size()).flatten().view() == FStringView(payload) );
+
+        FRope moved = std::move(copy);
+        REQUIRE( copy.empty() );
+        rope = moved;
+        REQUIRE( rope.size() == moved.size() );
+        rope.clear();
+        REQUIRE( rope.empty() );
+        REQUIRE( rope.begin() == rope.end() );
+        REQUIRE( rope.flatten().empty() );
+        rope += 'x';
+        REQUIRE( rope == "x" );
+    }
+
+    SECTION("Streaming"){
+        std::ostringstream out;
+        out << FRope(FStringView(payload));
+        REQUIRE( out.str() == payload );
+    }
+}
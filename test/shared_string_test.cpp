@@ -0,0 +1,108 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+#include "SharedString.hpp"
+
+TEST_CASE( "Shared strings share their characters between copies", "[shared_string]" ) {
+    const std::string text(1000, 'x');
+
+    SECTION("Copies of long strings point to the same characters"){
+        SharedFString str{FString(text)};
+        REQUIRE( str.use_count() == 1 );
+        SharedFString copy = str;
+        REQUIRE( copy.data() == str.data() );
+        REQUIRE( str.use_count() == 2 );
+        {
+            SharedFString another;
+            another = copy;
+            REQUIRE( str.use_count() == 3 );
+        }
+        REQUIRE( str.use_count() == 2 );
+        REQUIRE( copy.to_string() == text );
+        REQUIRE( copy.c_str()[copy.size()] == '\0' );
+    }
+
+    SECTION("Moving transfers the reference"){
+        SharedFString str(FStringView(text.data(), 100));
+        const char* chars = str.data();
+        SharedFString moved = std::move(str);
+        REQUIRE( moved.data() == chars );
+        REQUIRE( moved.use_count() == 1 );
+        REQUIRE( str.empty() );
+        REQUIRE( str.c_str()[0] == '\0' );
+        str = moved;
+        REQUIRE( moved.use_count() == 2 );
+        moved = SharedFString("short");
+        REQUIRE( str.use_count() == 1 );
+        REQUIRE( moved == "short" );
+    }
+
+    SECTION("Short strings are stored inline"){
+        SharedFString str = "1234567";
+        SharedFString copy = str;
+        REQUIRE( copy.data() != str.data() );
+        REQUIRE( copy == str );
+        REQUIRE( copy.use_count() == 1 );
+        REQUIRE( sizeof(SharedFString) == sizeof(FString) );
+    }
+
+    SECTION("Converting to and from FString"){
+        const FString original = "a doc comment that is well beyond the small buffer";
+        const SharedFString shared = original;
+        REQUIRE( shared == original );
+        REQUIRE( original == shared );
+        FString back = shared.str();
+        back[0] = 'A';
+        REQUIRE( shared[0] == 'a' );
+        REQUIRE( shared.view() == original.view() );
+        REQUIRE( shared != back );
+    }
+
+    SECTION("Comparing and ordering"){
+        REQUIRE( SharedFString("abc") < SharedFString("abd") );
+        REQUIRE( SharedFString("ab") < SharedFString("abc") );
+        REQUIRE( SharedFString("ab") != SharedFString("abc") );
+        REQUIRE( SharedFString() == SharedFString("") );
+    }
+
+    SECTION("Usable as HashMap keys"){
+        HashMap<SharedFString, int> mp;
+        mp.insert({SharedFString{FString(text)}, 1});
+        mp.insert({SharedFString("key"), 2});
+        REQUIRE( mp.find(FStringView(text))->second == 1 );
+        REQUIRE( mp.find(FStringView("key"))->second == 2 );
+        REQUIRE( hash_it(SharedFString("key")) == hash_it(FString("key")) );
+    }
+}
+
+TEST_CASE( "Shared strings can be copied and dropped on many threads", "[shared_string]" ) {
+    const SharedFString str{FString(std::string(4096, 'q'))};
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++)
+        threads.emplace_back([&str]{
+            std::vector<SharedFString> copies;
+            for(int i = 0; i < 10000; i++){
+                copies.push_back(str);
+                if(copies.size() > 16)
+                    copies.clear();
+            }
+        });
+    for(auto& thread : threads)
+        thread.join();
+    REQUIRE( str.use_count() == 1 );
+    REQUIRE( str.size() == 4096 );
+    REQUIRE( str[4095] == 'q' );
+}
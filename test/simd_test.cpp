@@ -0,0 +1,157 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include <random>
+#include "Simd.hpp"
+
+namespace {
+
+std::string random_text(std::mt19937& gen, std::size_t len, char alphabet){
+    std::uniform_int_distribution<int> dist(0, alphabet - 'a');
+    std::string s(len, 'a');
+    for(auto& c : s)
+        c = static_cast<char>('a' + dist(gen));
+    return s;
+}
+
+std::size_t to_index(const char* found, const std::string& hay){
+    return found ? std::size_t(found - hay.data()) : std::string::npos;
+}
+
+}
+
+TEST_CASE("SIMD character search matches the scalar kernels", "[simd]"){
+    std::mt19937 gen(2016);
+    for(std::size_t len = 0; len < 200; len += 3){
+        const std::string hay = random_text(gen, len, 'h');
+        const char* first = hay.data();
+        const char* last = hay.data() + hay.size();
+        for(char ch = 'a'; ch <= 'i'; ch++){
+            const auto fwd = simd::find_char_scalar(first, last, ch);
+            const auto bwd = simd::rfind_char_scalar(first, last, ch);
+            REQUIRE( to_index(fwd, hay) == hay.find(ch) );
+            REQUIRE( to_index(bwd, hay) == hay.rfind(ch) );
+            REQUIRE( simd::find_char(first, last, ch) == fwd );
+            REQUIRE( simd::rfind_char(first, last, ch) == bwd );
+#ifdef SIMD_SSE2
+            REQUIRE( simd::find_char_sse2(first, last, ch) == fwd );
+            REQUIRE( simd::rfind_char_sse2(first, last, ch) == bwd );
+#endif
+#ifdef SIMD_AVX2
+            if(simd::cpu_has_avx2()){
+                REQUIRE( simd::find_char_avx2(first, last, ch) == fwd );
+                REQUIRE( simd::rfind_char_avx2(first, last, ch) == bwd );
+            }
+#endif
+        }
+    }
+}
+
+TEST_CASE("SIMD and Two-Way substring search match std::string", "[simd]"){
+    std::mt19937 gen(1603);
+    for(int round = 0; round < 400; round++){
+        const char alphabet = round % 2 ? 'b' : 'd';
+        const std::string hay = random_text(gen, 1 + round * 3 % 700, alphabet);
+        std::uniform_int_distribution<std::size_t> pick(0, hay.size() - 1);
+        const std::size_t at = pick(gen);
+        const std::string needle = hay.substr(at, 2 + round % 90);
+        const std::size_t expected = hay.find(needle);
+        const auto hlen = SizeType(hay.size());
+        const auto nlen = SizeType(needle.size());
+
+        REQUIRE( to_index(simd::find_substring(hay.data(), hlen, needle.data(), nlen), hay) == expected );
+        REQUIRE( to_index(simd::find_substring_scalar(hay.data(), hlen, needle.data(), nlen), hay) == expected );
+        REQUIRE( to_index(simd::find_substring_two_way(hay.data(), hlen, needle.data(), nlen), hay) == expected );
+        REQUIRE( to_index(simd::rfind_substring(hay.data(), hlen, needle.data(), nlen), hay) == hay.rfind(needle) );
+#ifdef SIMD_SSE2
+        if(nlen >= 2)
+            REQUIRE( to_index(simd::find_substring_sse2(hay.data(), hlen, needle.data(), nlen), hay) == expected );
+#endif
+#ifdef SIMD_AVX2
+        if(nlen >= 2 && simd::cpu_has_avx2())
+            REQUIRE( to_index(simd::find_substring_avx2(hay.data(), hlen, needle.data(), nlen), hay) == expected );
+#endif
+    }
+
+    SECTION("Periodic needles"){
+        const std::string hay = std::string(5000, 'a') + "b" + std::string(200, 'a');
+        const std::string needle = std::string(100, 'a') + "b";
+        REQUIRE( to_index(simd::find_substring(hay.data(), SizeType(hay.size()), needle.data(), SizeType(needle.size())), hay)
+                 == hay.find(needle) );
+        const std::string missing = std::string(100, 'a') + "c";
+        REQUIRE( simd::find_substring(hay.data(), SizeType(hay.size()), missing.data(), SizeType(missing.size())) == nullptr );
+    }
+}
+
+TEST_CASE("Character sets classify every byte value", "[simd]"){
+    constexpr simd::CharSet separators(",;| \t");
+    static_assert(separators.contains(';') && !separators.contains('a'), "CharSet is usable at compile time");
+
+    std::mt19937 gen(32);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::string all(256, '\0');
+    for(int i = 0; i < 256; i++)
+        all[i] = static_cast<char>(i);
+
+    for(int round = 0; round < 200; round++){
+        // Sets spread over all sixteen high nibbles, including bytes >= 0x80
+        simd::CharSet set;
+        for(int k = round % 12; k > 0; k--)
+            set.add(static_cast<unsigned char>(byte(gen)));
+        if(round % 7 == 0)
+            set = ~set;
+
+        std::string hay = all;
+        std::shuffle(hay.begin(), hay.end(), gen);
+        hay += hay;
+        for(std::size_t start = 0; start < 80; start += 7){
+            const char* first = hay.data() + start;
+            const char* last = hay.data() + hay.size();
+            const auto expected = simd::find_set_scalar<true>(first, last, set);
+            const auto outsider = simd::find_set_scalar<false>(first, last, set);
+            const auto last_member = simd::rfind_set_scalar<true>(first, last, set);
+            const auto last_outsider = simd::rfind_set_scalar<false>(first, last, set);
+            if(expected)
+                REQUIRE( set.contains(*expected) );
+            if(last_outsider)
+                REQUIRE_FALSE( set.contains(*last_outsider) );
+            REQUIRE( simd::find_any(first, last, set) == expected );
+            REQUIRE( simd::find_not_any(first, last, set) == outsider );
+            REQUIRE( simd::rfind_any(first, last, set) == last_member );
+            REQUIRE( simd::rfind_not_any(first, last, set) == last_outsider );
+#ifdef SIMD_SSSE3
+            if(simd::cpu_has_ssse3()){
+                REQUIRE( simd::find_set_ssse3<true>(first, last, set) == expected );
+                REQUIRE( simd::find_set_ssse3<false>(first, last, set) == outsider );
+                REQUIRE( simd::rfind_set_ssse3<true>(first, last, set) == last_member );
+                REQUIRE( simd::rfind_set_ssse3<false>(first, last, set) == last_outsider );
+            }
+#endif
+#ifdef SIMD_AVX2
+            if(simd::cpu_has_avx2()){
+                REQUIRE( simd::find_set_avx2<true>(first, last, set) == expected );
+                REQUIRE( simd::find_set_avx2<false>(first, last, set) == outsider );
+                REQUIRE( simd::rfind_set_avx2<true>(first, last, set) == last_member );
+                REQUIRE( simd::rfind_set_avx2<false>(first, last, set) == last_outsider );
+            }
+#endif
+        }
+    }
+
+    const simd::CharSet digits = simd::CharSet().add_range('0', '9');
+    const std::string text = "identifier_without_any_numbers_until_here_42";
+    REQUIRE( simd::find_any(text.data(), text.data() + text.size(), digits) - text.data() == 42 );
+    REQUIRE( simd::find_any(text.data(), text.data() + 40, digits) == nullptr );
+    REQUIRE( (digits | simd::CharSet("_")).contains('_') );
+}
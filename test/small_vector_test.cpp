@@ -0,0 +1,139 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include "SmallFVector.hpp"
+
+TEST_CASE( "Small vectors keep their first elements inline", "[small_vector]" ) {
+    SmallFVector<int, 4> v;
+    REQUIRE( v.empty() );
+    REQUIRE( v.capacity() == 4 );
+    REQUIRE( v.is_inline() );
+
+    SECTION("Up to N elements never allocate"){
+        for(int i = 0; i < 4; i++)
+            v.push_back(i);
+        REQUIRE( v.is_inline() );
+        const char* object = reinterpret_cast<const char*>(&v);
+        const char* data = reinterpret_cast<const char*>(v.data());
+        REQUIRE( (data >= object && data < object + sizeof(v)) );
+        REQUIRE( v.size() == 4 );
+    }
+
+    SECTION("Spilling to the heap and coming back"){
+        for(int i = 0; i < 100; i++)
+            v.push_back(i);
+        REQUIRE( !v.is_inline() );
+        REQUIRE( v.size() == 100 );
+        REQUIRE( v[99] == 99 );
+        v.erase(v.begin() + 3, v.end());
+        REQUIRE( v.size() == 3 );
+        v.shrink_to_fit();
+        REQUIRE( v.is_inline() );
+        REQUIRE(( std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 0, 1, 2 } ));
+    }
+
+    SECTION("The API of FVector"){
+        SmallFVector<int, 4> w{ 5, 3, 1, 4, 2, 6 };
+        std::sort(w.begin(), w.end());
+        REQUIRE(( std::vector<int>(w.cbegin(), w.cend()) == std::vector<int>{ 1, 2, 3, 4, 5, 6 } ));
+        REQUIRE(( std::vector<int>(w.rbegin(), w.rend()) == std::vector<int>{ 6, 5, 4, 3, 2, 1 } ));
+        REQUIRE( w.front() == 1 );
+        REQUIRE( w.back() == 6 );
+        REQUIRE( w.at(2) == 3 );
+        REQUIRE_THROWS_AS( w.at(6), const std::out_of_range& );
+
+        auto next = w.erase(w.begin() + 1);
+        REQUIRE( *next == 3 );
+        w.pop_back();
+        REQUIRE(( std::vector<int>(w.begin(), w.end()) == std::vector<int>{ 1, 3, 4, 5 } ));
+
+        w.resize(6, 9);
+        REQUIRE( w[5] == 9 );
+        w.resize(2);
+        REQUIRE( w.size() == 2 );
+        w.assign(3, 7);
+        REQUIRE( std::count(w.begin(), w.end(), 7) == 3 );
+        w.assign({ 8, 9 });
+        REQUIRE( w.size() == 2 );
+
+        FVector<int>::iterator it = w.begin();
+        REQUIRE( *it == 8 );
+    }
+}
+
+TEST_CASE( "Small vectors own their elements", "[small_vector]" ) {
+    using Strings = SmallFVector<std::string, 2>;
+    const std::string long_text(100, 'x');
+
+    SECTION("Copying and moving, inline and spilled"){
+        Strings inline_strings{ "a", long_text };
+        Strings spilled{ "a", "b", long_text, "d" };
+
+        Strings copy = spilled;
+        REQUIRE( copy.size() == 4 );
+        REQUIRE( copy[2] == long_text );
+
+        Strings moved = std::move(spilled);
+        REQUIRE( spilled.empty() );
+        REQUIRE( spilled.is_inline() );
+        REQUIRE( moved[3] == "d" );
+
+        Strings moved_inline = std::move(inline_strings);
+        REQUIRE( moved_inline.is_inline() );
+        REQUIRE( moved_inline[1] == long_text );
+        REQUIRE( inline_strings.empty() );
+
+        copy = moved_inline;
+        REQUIRE( copy.size() == 2 );
+        moved_inline = std::move(moved);
+        REQUIRE( moved_inline.size() == 4 );
+        REQUIRE( !moved_inline.is_inline() );
+    }
+
+    SECTION("Swapping every combination"){
+        Strings small{ "s" };
+        Strings big{ "1", "2", "3" };
+        using std::swap;
+        swap(small, big);
+        REQUIRE( small.size() == 3 );
+        REQUIRE( big.size() == 1 );
+        REQUIRE( big[0] == "s" );
+        Strings other_big{ "x", "y", "z", "w" };
+        swap(small, other_big);
+        REQUIRE( small[3] == "w" );
+        REQUIRE( other_big[0] == "1" );
+    }
+
+    SECTION("Elements are destroyed"){
+        auto tracker = std::make_shared<int>(0);
+        {
+            SmallFVector<std::shared_ptr<int>, 2> v;
+            for(int i = 0; i < 5; i++)
+                v.push_back(tracker);
+            REQUIRE( tracker.use_count() == 6 );
+            v.erase(v.begin());
+            REQUIRE( tracker.use_count() == 5 );
+        }
+        REQUIRE( tracker.use_count() == 1 );
+    }
+
+    SECTION("Appending an element of the vector itself while it grows"){
+        Strings v{ long_text, "b" };
+        v.push_back(v[0]);
+        REQUIRE( v[2] == long_text );
+    }
+}
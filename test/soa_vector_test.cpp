@@ -0,0 +1,116 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "SoAVector.hpp"
+#include "String.hpp"
+
+using Tokens = FSoAVector<uint8_t, uint32_t, uint16_t, uint64_t>;
+
+TEST_CASE( "Structure of arrays vectors store one column per field", "[soa_vector]" ) {
+    Tokens tokens;
+    REQUIRE( tokens.empty() );
+    REQUIRE( sizeof(Tokens) == sizeof(void*) + 2 * sizeof(SizeType) );
+
+    for(uint32_t i = 0; i < 1000; i++)
+        tokens.push_back(static_cast<uint8_t>(i % 7), i * 10, static_cast<uint16_t>(i % 100), uint64_t(i) << 32);
+
+    SECTION("Rows read and write through tuples of references"){
+        REQUIRE( tokens.size() == 1000 );
+        REQUIRE( std::get<1>(tokens[5]) == 50 );
+        std::get<1>(tokens[5]) = 7;
+        REQUIRE( tokens.get<1>(5) == 7 );
+        tokens.get<3>(999) = 1;
+        REQUIRE( std::get<3>(tokens.back()) == 1 );
+        REQUIRE( std::get<0>(tokens.front()) == 0 );
+        REQUIRE_THROWS_AS( tokens.at(1000), const std::out_of_range& );
+
+        const Tokens& ro = tokens;
+        REQUIRE( std::get<2>(ro[150]) == 50 );
+        REQUIRE( ro.get<0>(8) == 1 );
+    }
+
+    SECTION("Columns are contiguous, aligned and share one block"){
+        FSpan<uint8_t> kinds = tokens.column<0>();
+        FSpan<uint32_t> offsets = tokens.column<1>();
+        FSpan<uint64_t> wide = tokens.column<3>();
+        REQUIRE( kinds.size() == 1000 );
+        REQUIRE( std::count(kinds.begin(), kinds.end(), uint8_t(3)) == 143 );
+        REQUIRE( offsets[999] == 9990 );
+        REQUIRE( reinterpret_cast<std::uintptr_t>(offsets.data()) % 16 == 0 );
+        REQUIRE( reinterpret_cast<std::uintptr_t>(wide.data()) % 16 == 0 );
+        const char* first = reinterpret_cast<const char*>(kinds.data());
+        const char* last = reinterpret_cast<const char*>(wide.data());
+        REQUIRE( last > first );
+        REQUIRE( SizeType(last - first) < 8 * tokens.capacity() );
+    }
+
+    SECTION("Iterating rows"){
+        uint64_t sum = 0;
+        for(auto row : tokens)
+            sum += std::get<1>(row);
+        REQUIRE( sum == 4995000 );
+        REQUIRE( tokens.end() - tokens.begin() == 1000 );
+        auto it = std::find_if(tokens.cbegin(), tokens.cend(), [](std::tuple<const uint8_t&, const uint32_t&, const uint16_t&, const uint64_t&> row){
+            return std::get<1>(row) == 300;
+        });
+        REQUIRE( it - tokens.cbegin() == 30 );
+    }
+
+    SECTION("Resizing, copying and moving"){
+        tokens.resize(1200);
+        REQUIRE( tokens.get<1>(1199) == 0 );
+        REQUIRE( tokens.get<1>(999) == 9990 );
+        tokens.resize(10);
+        tokens.shrink_to_fit();
+        REQUIRE( tokens.capacity() == 10 );
+        REQUIRE( tokens.get<1>(9) == 90 );
+
+        Tokens copy = tokens;
+        copy.get<1>(0) = 42;
+        REQUIRE( tokens.get<1>(0) == 0 );
+        Tokens moved = std::move(copy);
+        REQUIRE( copy.empty() );
+        REQUIRE( moved.get<1>(0) == 42 );
+        moved.push_back(moved[3]);
+        REQUIRE( moved.get<1>(10) == 30 );
+        moved.pop_back();
+        moved.clear();
+        REQUIRE( moved.empty() );
+        swap(moved, tokens);
+        REQUIRE( moved.size() == 10 );
+    }
+}
+
+TEST_CASE( "Structure of arrays vectors hold non trivial fields", "[soa_vector]" ) {
+    const std::string long_text(40, 'x');
+    FSoAVector<std::string, int> names;
+    for(int i = 0; i < 100; i++)
+        names.push_back(long_text + std::to_string(i), i);
+    names.push_back(std::make_tuple(std::string("last"), -1));
+    REQUIRE( names.get<0>(99) == long_text + "99" );
+    REQUIRE( std::get<0>(names.back()) == "last" );
+
+    FSoAVector<std::string, int> copy = names;
+    names.resize(5);
+    REQUIRE( copy.size() == 101 );
+    REQUIRE( copy.get<0>(50) == long_text + "50" );
+
+    FSoAVector<FString, char> strings(3);
+    strings.get<0>(2) = FString(long_text);
+    strings.reserve(100);
+    REQUIRE( strings.get<0>(2).to_string() == long_text );
+}
@@ -0,0 +1,359 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include <cctype>
+#include <random>
+#include <algorithm>
+#include "StringAlgorithms.hpp"
+#include "HashMap.hpp"
+
+namespace {
+
+template<typename Range>
+std::vector<std::string> pieces(const Range& range){
+    std::vector<std::string> result;
+    for(FStringView piece : range)
+        result.push_back(piece.to_string());
+    return result;
+}
+
+using Pieces = std::vector<std::string>;
+
+}
+
+TEST_CASE("Splitting strings into views", "[string_algorithms]"){
+
+    SECTION("Single character delimiters keep empty pieces"){
+        FString csv = "name,,age,";
+        REQUIRE( pieces(split(csv, ',')) == (Pieces{"name", "", "age", ""}) );
+        REQUIRE( pieces(split(csv, ',', SplitMode::SkipEmpty)) == (Pieces{"name", "age"}) );
+        REQUIRE( pieces(split(FStringView(""), ',')) == (Pieces{""}) );
+        REQUIRE( pieces(split(FStringView(""), ',', SplitMode::SkipEmpty)).empty() );
+        REQUIRE( pieces(split(FStringView("plain"), ',')) == (Pieces{"plain"}) );
+        REQUIRE( split(csv, ',').count() == 4 );
+    }
+
+    SECTION("Pieces point into the original characters"){
+        FString path = "usr/local/include/ParserDataStructures";
+        auto range = split(path, '/');
+        auto it = range.begin();
+        REQUIRE( it->data() == path.data() );
+        ++it;
+        REQUIRE( it->data() == path.data() + 4 );
+        REQUIRE( *it == "local" );
+    }
+
+    SECTION("Multi character delimiters"){
+        FString name = "std::chrono::duration";
+        REQUIRE( pieces(split(name, "::")) == (Pieces{"std", "chrono", "duration"}) );
+        REQUIRE( pieces(split(FStringView("a->b->"), FStringView("->"))) == (Pieces{"a", "b", ""}) );
+        REQUIRE( pieces(split(name, "")) == (Pieces{"std::chrono::duration"}) );
+    }
+
+    SECTION("Any of a set of delimiters, over a raw buffer"){
+        const char buffer[] = "int  x=1;\tfloat y = 2.5;\n";
+        const FStringView raw(buffer, sizeof(buffer) - 1);
+        REQUIRE( pieces(split_any(raw, " \t\n=;", SplitMode::SkipEmpty)) ==
+                 (Pieces{"int", "x", "1", "float", "y", "2.5"}) );
+        REQUIRE( split_any(raw, " \t\n=;").count() == 12 );
+    }
+
+    SECTION("Long inputs agree with a naive splitter"){
+        std::string text;
+        for(int i = 0; i < 3000; i++)
+            text += (i % 11 == 0) ? ',' : (i % 17 == 0 ? '\xE9' : static_cast<char>('a' + i % 26));
+        const CharSet delimiters = CharSet(",").add('\xE9');
+
+        Pieces expected(1);
+        for(char c : text){
+            if(delimiters.contains(c))
+                expected.emplace_back();
+            else
+                expected.back() += c;
+        }
+        REQUIRE( pieces(split_any(FStringView(text), delimiters)) == expected );
+    }
+
+    SECTION("Wide strings"){
+        F32String wide(U"a b  c");
+        REQUIRE( split(wide, U' ').count() == 4 );
+        REQUIRE( split_any(wide, " ", SplitMode::SkipEmpty).count() == 3 );
+    }
+}
+
+TEST_CASE("Skipping character classes and trimming", "[string_algorithms]"){
+    static_assert(char_class::identifier.contains('_') && !char_class::identifier_start.contains('7'),
+                  "character classes are built at compile time");
+
+    SECTION("Lexing with skip_while and skip_until"){
+        const FString source = "    counter_42 = 0x1F;";
+        SizeType pos = skip_while(source, char_class::blank);
+        REQUIRE( pos == 4 );
+        REQUIRE( char_class::identifier_start.contains(source[pos]) );
+        const SizeType end = skip_while(source, char_class::identifier, pos);
+        REQUIRE( source.substr(pos, end - pos) == FStringView("counter_42") );
+        pos = skip_until(source, char_class::digits, end);
+        REQUIRE( pos == 17 );
+        REQUIRE( skip_while(source, char_class::hex_digits, pos + 2) == 21 );
+        REQUIRE( skip_while(source, char_class::identifier, 100) == source.size() );
+        REQUIRE( skip_until(source, CharSet("@"), 0) == source.size() );
+    }
+
+    SECTION("Long runs cross SIMD block boundaries"){
+        for(SizeType run = 0; run < 100; run++){
+            const std::string text = std::string(run, ' ') + "x" + std::string(run, '\t');
+            const FStringView view(text);
+            REQUIRE( skip_while(view, char_class::whitespace) == run );
+            REQUIRE( trim(view) == FStringView("x") );
+            REQUIRE( ltrim(view).size() == run + 1 );
+            REQUIRE( rtrim(view).size() == run + 1 );
+        }
+    }
+
+    SECTION("Trimming"){
+        REQUIRE( trim(FString(" \t value \r\n")) == FStringView("value") );
+        REQUIRE( trim(FStringView("   ")).empty() );
+        REQUIRE( trim(FStringView("")).empty() );
+        REQUIRE( trim(FStringView("--x--"), CharSet("-")) == FStringView("x") );
+        REQUIRE( rtrim(FStringView("a \xA0\xA0"), CharSet(" \xA0")) == FStringView("a") );
+
+        F32String wide(U"  wide  ");
+        REQUIRE( trim(wide).size() == 4 );
+    }
+}
+
+TEST_CASE("Case-insensitive comparison and hashing", "[string_algorithms]"){
+    SECTION("Only ASCII letters are folded"){
+        REQUIRE(iequals("SELECT", "select"));
+        REQUIRE(iequals("Select_1", "sELECT_1"));
+        REQUIRE_FALSE(iequals("select", "selects"));
+        REQUIRE_FALSE(iequals("[", "{"));                 // 0x5B and 0x7B differ by 0x20 too
+        REQUIRE_FALSE(iequals("@", "`"));
+        REQUIRE_FALSE(iequals("\xC3\x89", "\xC3\xA9"));   // É and é are not ASCII
+        REQUIRE(iequals("", ""));
+
+        for(int x = 0; x < 256; x++)
+            for(int y = 0; y < 256; y++){
+                const char a = static_cast<char>(x), b = static_cast<char>(y);
+                const bool expected = std::tolower(x) == std::tolower(y);   // "C" locale
+                REQUIRE(iequals(FStringView(&a, 1), FStringView(&b, 1)) == expected);
+            }
+    }
+
+    SECTION("Every block position and length"){
+        std::string lower, upper;
+        for(int i = 0; i < 70; i++){
+            lower += static_cast<char>('a' + i % 26);
+            upper += static_cast<char>('A' + i % 26);
+        }
+        for(SizeType n = 0; n <= lower.size(); n++){
+            const FStringView a(lower.data(), n), b(upper.data(), n);
+            REQUIRE(iequals(a, b));
+            REQUIRE(icompare(a, b) == 0);
+            REQUIRE(ihash(a) == ihash(b));
+            REQUIRE(simd::hash_icase_scalar(a.data(), n) == simd::hash_icase(b.data(), n));
+            for(SizeType at = 0; at < n; at++){
+                std::string changed = upper.substr(0, n);
+                changed[at] = '#';
+                REQUIRE(simd::mismatch_icase(a.data(), changed.data(), n) == at);
+                REQUIRE(simd::mismatch_icase_scalar(a.data(), changed.data(), n) == at);
+                REQUIRE_FALSE(iequals(a, FStringView(changed)));
+            }
+        }
+    }
+
+    SECTION("Ordering follows the lowercase forms"){
+        REQUIRE(icompare("apple", "BANANA") < 0);
+        REQUIRE(icompare("Banana", "apple") > 0);
+        REQUIRE(icompare("ABC", "abcd") < 0);
+        REQUIRE(icompare("abcd", "ABC") > 0);
+        REQUIRE(icompare("_", "a") < 0);          // '_' is below 'a' though above 'A'
+        REQUIRE(icompare("Zebra_crossing_with_a_long_name", "zebra_crossing_with_a_LONG_nAme") == 0);
+    }
+
+    SECTION("Hashes tell different strings apart"){
+        REQUIRE(ihash("a") != ihash(FStringView("a\0", 2)));
+        REQUIRE(ihash("keyword") != ihash("keywore"));
+        REQUIRE(ihash("") != ihash(FStringView("\0", 1)));
+    }
+
+    SECTION("Keyword table lookups without lowercasing"){
+        HashMap<FString, int, CaseInsensitiveHash, CaseInsensitiveEqual> keywords;
+        keywords.insert({"select", 1});
+        keywords.insert({"from", 2});
+        keywords.insert({"WHERE", 3});
+        REQUIRE(keywords.insert({"SELECT", 4}).second == false);
+        REQUIRE(keywords.size() == 3);
+
+        const std::string query = "Select name From t wHeRe id = 1";
+        int found = 0;
+        for(FStringView token : split(FStringView(query), ' ')){
+            auto iter = keywords.find(token);
+            if(iter != keywords.end())
+                found += iter->second;
+        }
+        REQUIRE(found == 6);
+        REQUIRE(keywords.count(FStringView("FROM")) == 1);
+        REQUIRE(keywords.count(FStringView("fro")) == 0);
+    }
+}
+
+namespace {
+
+//! The quadratic textbook recurrence, as the reference
+SizeType levenshtein_dp(const std::string& a, const std::string& b){
+    std::vector<SizeType> row(b.size() + 1);
+    for(SizeType j = 0; j <= b.size(); j++)
+        row[j] = j;
+    for(SizeType i = 1; i <= a.size(); i++){
+        SizeType diagonal = row[0];
+        row[0] = i;
+        for(SizeType j = 1; j <= b.size(); j++){
+            const SizeType up = row[j];
+            row[j] = std::min({ up + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1) });
+            diagonal = up;
+        }
+    }
+    return row[b.size()];
+}
+
+}
+
+TEST_CASE("Bit-parallel edit distance", "[string_algorithms]"){
+    SECTION("Small cases"){
+        REQUIRE( edit_distance("kitten", "sitting") == 3 );
+        REQUIRE( edit_distance("", "abc") == 3 );
+        REQUIRE( edit_distance("abc", "") == 3 );
+        REQUIRE( edit_distance("", "") == 0 );
+        REQUIRE( edit_distance("flaw", "lawn") == 2 );
+        REQUIRE( edit_distance("same", "same") == 0 );
+        REQUIRE( edit_distance("a", "b") == 1 );
+    }
+
+    SECTION("Agrees with the quadratic recurrence, across block boundaries"){
+        std::mt19937 gen(42);
+        const SizeType lengths[] = { 1, 5, 63, 64, 65, 127, 128, 130, 200 };
+        for(SizeType m : lengths)
+            for(int round = 0; round < 6; round++){
+                std::string a(m, 'a');
+                for(char& c : a)
+                    c = static_cast<char>('a' + gen() % 4);
+                std::string b = a;
+                for(int e = 0, edits = static_cast<int>(gen() % 12); e < edits && !b.empty(); e++){
+                    const SizeType at = gen() % b.size();
+                    switch(gen() % 3){
+                        case 0: b[at] = static_cast<char>('a' + gen() % 4); break;
+                        case 1: b.erase(at, 1); break;
+                        default: b.insert(at, 1, static_cast<char>('a' + gen() % 4));
+                    }
+                }
+                const SizeType expected = levenshtein_dp(a, b);
+                REQUIRE( edit_distance(FStringView(a), FStringView(b)) == expected );
+                REQUIRE( LevenshteinPattern(FStringView(a)).distance(FStringView(b)) == expected );
+                REQUIRE( LevenshteinPattern(FStringView(b)).distance(FStringView(a)) == expected );
+            }
+    }
+
+    SECTION("A bound stops early but never hides a distance within it"){
+        const LevenshteinPattern pattern(FStringView("identifier"));
+        REQUIRE( pattern.distance(FStringView("identifeir"), 2) == 2 );
+        REQUIRE( pattern.distance(FStringView("something_else"), 2) > 2 );
+        REQUIRE( pattern.distance(FStringView("id"), 2) > 2 );
+    }
+}
+
+TEST_CASE("Nearest keys for did you mean diagnostics", "[string_algorithms]"){
+    HashMap<FString, int> symbols;
+    const char* const names[] = { "counter", "count", "country", "cursor", "mount", "account_total", "c" };
+    for(const char* name : names)
+        symbols.insert({FString(FStringView(name)), 0});
+
+    const FVector<NearestKey> near = nearest_keys(symbols, FStringView("coutn"), 3, 3);
+    REQUIRE( near.size() == 3 );
+    REQUIRE( near[0].key == FStringView("count") );
+    REQUIRE( near[0].distance == 2 );
+    // Ties are broken by the keys, "mount" is the fourth at distance 3
+    REQUIRE( near[1].key == FStringView("counter") );
+    REQUIRE( near[2].key == FStringView("country") );
+    REQUIRE( near[2].distance == 3 );
+    REQUIRE( nearest_keys(symbols, FStringView("coutn"), 3, 2).size() == 1 );
+
+    const FVector<NearestKey> one = nearest_keys(symbols, FStringView("countr"), 1, 3);
+    REQUIRE( one.size() == 1 );
+    REQUIRE( one[0].distance == 1 );
+    REQUIRE( one[0].key == FStringView("count") );
+
+    REQUIRE( nearest_keys(symbols, FStringView("zzzzzzzz"), 5, 2).empty() );
+
+    // More than 127 of one character must not wrap the histogram bound
+    HashMap<FString, int> longKeys;
+    longKeys.insert({FString(std::string(127, 'a').c_str()), 0});
+    const std::string query(130, 'a');
+    const FVector<NearestKey> far = nearest_keys(longKeys, FStringView(query.c_str()), 1, 3);
+    REQUIRE( far.size() == 1 );
+    REQUIRE( far[0].distance == 3 );
+}
+
+TEST_CASE("Joining strings with one allocation", "[string_algorithms]"){
+    SECTION("FVector, std::vector and arrays of any string kind"){
+        FVector<FString> segments;
+        segments.push_back("usr");
+        segments.push_back("local");
+        segments.push_back("include");
+        REQUIRE( join(segments, '/').to_string() == "usr/local/include" );
+        REQUIRE( join(segments, "::").to_string() == "usr::local::include" );
+        REQUIRE( join(segments, FStringView(", ")).to_string() == "usr, local, include" );
+
+        const std::vector<FStringView> views = { "a", "", "c" };
+        REQUIRE( join(views, ',').to_string() == "a,,c" );
+        REQUIRE( join(views.begin() + 1, views.end(), "-").to_string() == "-c" );
+
+        const FStringLiteral literals[] = { FS("std"), FS("vector") };
+        REQUIRE( join(literals, "::").to_string() == "std::vector" );
+
+        const std::vector<std::string> strings = { "x", "y" };
+        REQUIRE( join(strings, "").to_string() == "xy" );
+        REQUIRE( join({ FStringView("p"), FStringView("q") }, '.').to_string() == "p.q" );
+    }
+
+    SECTION("Empty ranges and single pieces"){
+        const std::vector<FString> none;
+        REQUIRE( join(none, ", ").empty() );
+        REQUIRE( join(none, ", ").c_str()[0] == '\0' );
+        const std::vector<FString> one = { "alone" };
+        REQUIRE( join(one, ", ").to_string() == "alone" );
+    }
+
+    SECTION("Short results stay in the small buffer, long ones get exactly one buffer"){
+        const std::vector<FStringView> short_parts = { "a", "b", "c" };
+        const FString small = join(short_parts, '.');
+        REQUIRE( small.capacity() == FString::kSS - 1 );
+
+        std::vector<FString> long_parts;
+        std::string expected;
+        for(int i = 0; i < 100; i++){
+            long_parts.push_back("segment");
+            expected += i ? "/segment" : "segment";
+        }
+        const FString joined = join(long_parts, '/');
+        REQUIRE( joined.to_string() == expected );
+        REQUIRE( joined.capacity() == expected.size() );
+    }
+
+    SECTION("Wide strings"){
+        const std::vector<F32StringView> parts = { U"a", U"b" };
+        REQUIRE( join(parts, U'+') == U"a+b" );
+    }
+}
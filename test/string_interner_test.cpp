@@ -0,0 +1,96 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+#include "StringInterner.hpp"
+
+TEST_CASE( "Interning returns one Atom per distinct string", "[interner]" ) {
+    StringInterner interner;
+
+    const Atom a = interner.intern("identifier");
+    const Atom b = interner.intern("other_identifier");
+    const Atom c = interner.intern(FString("identifier"));
+
+    REQUIRE( a.valid() );
+    REQUIRE( a == c );
+    REQUIRE( a != b );
+    REQUIRE( interner.size() == 2 );
+
+    REQUIRE( interner.str(a) == "identifier" );
+    REQUIRE( interner.str(b) == "other_identifier" );
+    REQUIRE( interner.str(a).data()[interner.str(a).size()] == '\0' );
+
+    REQUIRE( interner.lookup("identifier") == a );
+    REQUIRE( !interner.lookup("missing").valid() );
+
+    SECTION( "Prefixes and the empty string are distinct atoms" ){
+        const Atom p = interner.intern("ident");
+        const Atom e = interner.intern("");
+        REQUIRE( p != a );
+        REQUIRE( e != a );
+        REQUIRE( interner.str(e).empty() );
+        REQUIRE( interner.intern(FStringView("identifier", 5)) == p );
+    }
+
+    SECTION( "Views survive growth of the arena and the table" ){
+        std::vector<Atom> atoms;
+        const std::string big(StringInterner::kBlockSize, 'x');
+        for(int i = 0; i < 5000; i++)
+            atoms.push_back(interner.intern(FStringView("name_" + std::to_string(i))));
+        const Atom large = interner.intern(FStringView(big));
+
+        REQUIRE( interner.size() == 5003 );
+        for(int i = 0; i < 5000; i++){
+            REQUIRE( interner.str(atoms[i]) == FStringView("name_" + std::to_string(i)) );
+            REQUIRE( interner.intern(FStringView("name_" + std::to_string(i))) == atoms[i] );
+        }
+        REQUIRE( interner.str(large).size() == big.size() );
+        REQUIRE( interner.str(a) == "identifier" );
+    }
+}
+
+TEST_CASE( "Atoms are usable as HashMap keys", "[interner]" ) {
+    StringInterner interner;
+    HashMap<Atom, int> uses;
+    for(const char* name : { "x", "y", "x", "z", "x" })
+        uses[interner.intern(FStringView(name))] += 1;
+
+    REQUIRE( uses.size() == 3 );
+    REQUIRE( uses[interner.intern("x")] == 3 );
+    REQUIRE( uses[interner.intern("z")] == 1 );
+}
+
+TEST_CASE( "Concurrent interning agrees across threads", "[interner]" ) {
+    ConcurrentStringInterner interner;
+    const int kThreads = 4, kNames = 2000;
+    std::vector<std::vector<Atom>> results(kThreads);
+    std::vector<std::thread> threads;
+
+    for(int t = 0; t < kThreads; t++)
+        threads.emplace_back([&, t]{
+            for(int i = 0; i < kNames; i++)
+                results[t].push_back(interner.intern(FStringView("symbol" + std::to_string((i * (t + 1)) % kNames))));
+        });
+    for(auto& th : threads)
+        th.join();
+
+    REQUIRE( interner.size() == SizeType(kNames) );
+    for(int t = 0; t < kThreads; t++)
+        for(int i = 0; i < kNames; i++){
+            const std::string name = "symbol" + std::to_string((i * (t + 1)) % kNames);
+            REQUIRE( interner.str(results[t][i]) == FStringView(name) );
+            REQUIRE( interner.lookup(FStringView(name)) == results[t][i] );
+        }
+}
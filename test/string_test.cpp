@@ -11,6 +11,7 @@
 */
 //#define CATCH_CONFIG_MAIN
 #include "catch.hpp"
+#include <random>
 #include <vector>
 #include <algorithm>
 #include <string>
@@ -335,7 +336,8 @@ TEST_CASE("Find and SubStr Methods", "[string]"){
         REQUIRE( substr == "day"    );
 
         substr = FString("Today").substr(2, 3);
-        REQUIRE( substr == "d" );
+        REQUIRE( substr == "day" );
+        REQUIRE( substr != "d" );
 
         //Large String
         substr = str.substr(8);
@@ -374,4 +376,370 @@ TEST_CASE("Test with streams", "[string]"){
 
         REQUIRE( s == "Thisbetterbeagoodthing" );
     }
+
+    SECTION("extraction matches std::string"){
+        std::string input = "  short   a_considerably_longer_token_than_the_small_buffer\n\tx  ";
+        input += std::string(5000, 'y') + " tail";
+        std::stringstream ss(input), ref(input);
+        std::string expected;
+        while (ref >> expected) {
+            REQUIRE( (ss >> str) );
+            REQUIRE( str.to_string() == expected );
+        }
+        REQUIRE( !(ss >> str) );
+        REQUIRE( ss.eof() );
+    }
+
+    SECTION("extraction honours the stream width"){
+        std::stringstream ss("abcdefghij");
+        ss.width(4);
+        ss >> str;
+        REQUIRE( str == "abcd" );
+        ss >> str;
+        REQUIRE( str == "efghij" );
+    }
+
+    SECTION("getline reads every line, including empty ones"){
+        std::string input = "first line\n\nthird line is longer than the rest\n";
+        input += std::string(10000, 'z') + "\nlast";
+        std::stringstream ss(input), ref(input);
+        std::string expected;
+        while (std::getline(ref, expected)) {
+            REQUIRE( std::getline(ss, str) );
+            REQUIRE( str.to_string() == expected );
+        }
+        REQUIRE( !std::getline(ss, str) );
+    }
+
+    SECTION("getline with a custom delimiter"){
+        std::stringstream ss("a,bb,,ccc");
+        std::vector<std::string> parts;
+        while (std::getline(ss, str, ','))
+            parts.push_back(str.to_string());
+        REQUIRE( parts == std::vector<std::string>({"a", "bb", "", "ccc"}) );
+    }
+
+    SECTION("getline reuses the buffer of the string"){
+        std::stringstream ss(std::string(100, 'l') + "\nshort\n" + std::string(80, 'm') + "\n");
+        std::getline(ss, str);
+        const char* buffer = str.data();
+        const SizeType cap = str.capacity();
+        REQUIRE( cap >= 100 );
+
+        std::getline(ss, str);
+        REQUIRE( str == "short" );
+        std::getline(ss, str);
+        REQUIRE( str.size() == 80 );
+        REQUIRE( str.data() == buffer );
+        REQUIRE( str.capacity() == cap );
+    }
+}
+
+TEST_CASE("Appending and reserving", "[string]"){
+    FString str;
+    REQUIRE( str.capacity() == FString::kSS - 1 );
+
+    std::string expected;
+    for(int i = 0; i < 200; i++){
+        str.push_back(char('a' + i % 26));
+        expected += char('a' + i % 26);
+        REQUIRE( str.size() == expected.size() );
+        REQUIRE( str.c_str() == expected );
+    }
+
+    str.append(FStringView("-tail"));
+    REQUIRE( str.to_string() == expected + "-tail" );
+
+    FString copy = str;
+    REQUIRE( copy == str );
+
+    str.clear();
+    REQUIRE( str.empty() );
+    REQUIRE( str.c_str()[0] == '\0' );
+    REQUIRE( str.capacity() >= 205 );
+    str.append("x", 1);
+    REQUIRE( str == "x" );
+
+    FString small = str;
+    REQUIRE( small.capacity() == FString::kSS - 1 );
+
+    str.reserve(1000);
+    REQUIRE( str.capacity() >= 1000 );
+    REQUIRE( str == "x" );
+
+    FString moved = std::move(str);
+    REQUIRE( moved == "x" );
+    REQUIRE( str.empty() );
+}
+
+TEST_CASE("Find agrees with std::string on long and repetitive strings", "[string]"){
+    std::string base;
+    for(int i = 0; i < 300; i++)
+        base += static_cast<char>('a' + (i * 7 + i / 13) % 5);
+    base += "needle_at_the_very_end";
+
+    FString str = base;
+    auto widen = [](SizeType idx){ return idx == FString::npos ? std::string::npos : idx; };
+    const char* needles[] = { "a", "ab", "cab", "eeee", "abcdeabcde", "needle_at_the_very_end", "zz" };
+
+    for(auto n : needles){
+        const FString fn(n);
+        for(SizeType pos = 0; pos < str.size(); pos += 17){
+            REQUIRE( widen(str.find(fn, pos)) == base.find(n, pos) );
+            REQUIRE( widen(str.rfind(fn, pos)) == base.rfind(n, pos) );
+            REQUIRE( widen(str.find(n[0], pos)) == base.find(n[0], pos) );
+            REQUIRE( widen(str.rfind(n[0], pos)) == base.rfind(n[0], pos) );
+        }
+        REQUIRE( widen(str.rfind(fn)) == base.rfind(n) );
+    }
+
+    REQUIRE( widen(str.rfind('d', 1000)) == base.rfind('d') );
+    REQUIRE( str.find('d', 1000) == FString::npos );
+}
+
+TEST_CASE("String views", "[string]"){
+    FString str = "the quick brown fox jumps over the lazy dog";
+    FStringView view = str;
+
+    REQUIRE( view.size() == str.size() );
+    REQUIRE( view.data() == str.data() );
+    REQUIRE( view == str );
+    REQUIRE( str == view );
+    REQUIRE( view == "the quick brown fox jumps over the lazy dog" );
+
+    SECTION("Slicing does not copy"){
+        FStringView fox = view.substr(16, 3);
+        REQUIRE( fox == "fox" );
+        REQUIRE( fox.data() == str.data() + 16 );
+        REQUIRE( fox != "fo" );
+        REQUIRE( FStringView("fo") != fox );
+        REQUIRE( FStringView("fo") < fox );
+
+        view.remove_prefix(4);
+        view.remove_suffix(4);
+        REQUIRE( view == "quick brown fox jumps over the lazy" );
+        REQUIRE( view.starts_with("quick") );
+        REQUIRE( view.ends_with("lazy") );
+    }
+
+    SECTION("Searching"){
+        REQUIRE( view.find("the") == 0 );
+        REQUIRE( view.find("the", 1) == 31 );
+        REQUIRE( view.rfind("the") == 31 );
+        REQUIRE( view.find('q') == 4 );
+        REQUIRE( view.rfind('o', 30) == 26 );
+        REQUIRE( view.find("cat") == FStringView::npos );
+    }
+
+    SECTION("Strings can be built from views"){
+        for(SizeType len = 0; len < 20; len++){
+            FString piece(view.substr(4, len));
+            REQUIRE( piece.size() == len );
+            REQUIRE( piece == view.substr(4, len) );
+            REQUIRE( piece.c_str()[len] == '\0' );
+        }
+    }
+}
+
+TEST_CASE("Seven character strings use the small buffer consistently", "[string]"){
+    FString str = "1234567";
+    REQUIRE( str.size() == 7 );
+    REQUIRE( std::strcmp(str.c_str(), "1234567") == 0 );
+
+    FString copy = str;
+    REQUIRE( std::strcmp(copy.c_str(), "1234567") == 0 );
+    REQUIRE( FString("abcdefghijkl").substr(2, 7) == FStringView("cdefghi") );
+}
+
+TEST_CASE("Concatenation expressions", "[string]"){
+    const FString scope = "ParserDataStructures";
+    const FString name = "HashMap";
+    const FStringView view("insert");
+
+    SECTION("Mixing strings, views, literals and characters"){
+        FString qualified = scope + "::" + name + '.' + view;
+        REQUIRE( qualified.to_string() == "ParserDataStructures::HashMap.insert" );
+        REQUIRE( qualified.size() == 36 );
+        REQUIRE( qualified.capacity() == 36 );
+        REQUIRE( qualified.c_str()[36] == '\0' );
+
+        FString reversed = '<' + view + "@" + std::string("std") + '>';
+        REQUIRE( reversed == "<insert@std>" );
+
+        const char* pointer = "ptr";
+        REQUIRE( FString(name + pointer) == "HashMapptr" );
+        REQUIRE( (name + name).str() == "HashMapHashMap" );
+    }
+
+    SECTION("Short results stay in the small buffer"){
+        FString small = FString("a") + 'b' + "cd";
+        REQUIRE( small == "abcd" );
+        REQUIRE( small.capacity() == FString::kSS - 1 );
+
+        FString empty = FString() + "";
+        REQUIRE( empty.empty() );
+        REQUIRE( empty.c_str()[0] == '\0' );
+    }
+
+    SECTION("Appending expressions, including the string itself"){
+        FString str = "x";
+        str += str + "y" + str;
+        REQUIRE( str == "xxyx" );
+        str += '!';
+        str += FStringView("?");
+        REQUIRE( str == "xxyx!?" );
+        for(int i = 0; i < 4; i++)
+            str += str + str;
+        REQUIRE( str.size() == 6 * 81 );
+        REQUIRE( str.substr(0, 12) == "xxyx!?xxyx!?" );
+        REQUIRE( str.c_str()[str.size()] == '\0' );
+    }
+
+    SECTION("Wide strings"){
+        F32String wide = F32String(U"ab") + U"cd" + U'e';
+        REQUIRE( wide.size() == 5 );
+        REQUIRE( wide[4] == U'e' );
+    }
+}
+
+TEST_CASE("Literals know their length and hash at compile time", "[string]"){
+    constexpr FStringLiteral kWhile = FS("while");
+    static_assert(kWhile.size() == 5, "length of a literal is a constant");
+    static_assert(kWhile.hash() == hash_chars("while", 5), "hash of a literal is a constant");
+    static_assert(kWhile == FS("while") && kWhile != FS("whilst") && kWhile != FS("whil"), "");
+    static_assert(FS("").empty() && FS(U"if").size() == 2, "");
+
+    SECTION("Comparing with strings and views"){
+        const FString str = "while";
+        REQUIRE( str == kWhile );
+        REQUIRE( kWhile == str );
+        REQUIRE( kWhile == FStringView("while loop", 5) );
+        REQUIRE( FStringView("whil") != kWhile );
+        REQUIRE( FString("while loop") != kWhile );
+        REQUIRE( kWhile.str() == str );
+        REQUIRE( kWhile.view().to_string() == "while" );
+    }
+
+    SECTION("Embedded NULs count towards length and hash"){
+        constexpr auto with_nul = FS("a\0b");
+        REQUIRE( with_nul.size() == 3 );
+        REQUIRE( with_nul != FS("a\0c") );
+        REQUIRE( with_nul.hash() == hash_chars(FStringView(with_nul).data(), 3) );
+    }
+
+    SECTION("A proper prefix is not equal and orders first"){
+        REQUIRE( FString("abc") != FString("ab") );
+        REQUIRE( FString::compare("ab", "abc") < 0 );
+        REQUIRE( FString::compare("abc", "ab") > 0 );
+        REQUIRE( FString("ab") != "abc" );
+    }
+}
+
+TEST_CASE("Inserting, erasing and replacing in place", "[string]"){
+    SECTION("Agrees with std::string"){
+        std::mt19937 gen(99);
+        FString str;
+        std::string expected;
+        const std::string pieces[] = { "", "x", "abc", "a longer piece of text", std::string(40, 'q') };
+        for(int i = 0; i < 2000; i++){
+            const SizeType pos = static_cast<SizeType>(gen() % (expected.size() + 1));
+            const SizeType count = static_cast<SizeType>(gen() % 8);
+            const std::string& piece = pieces[gen() % 5];
+            switch(gen() % 4){
+                case 0: str.insert(pos, FStringView(piece)); expected.insert(pos, piece); break;
+                case 1: str.erase(pos, count); expected.erase(pos, count); break;
+                case 2: str.insert(pos, 'z'); expected.insert(expected.begin() + pos, 'z'); break;
+                default: str.replace(pos, count, FStringView(piece)); expected.replace(pos, count, piece);
+            }
+            if(expected.size() > 400){
+                str.erase(200);
+                expected.erase(200);
+            }
+            REQUIRE( str.size() == expected.size() );
+            REQUIRE( str.c_str() == expected );
+        }
+    }
+
+    SECTION("Within the capacity nothing is reallocated"){
+        FString str;
+        str.reserve(100);
+        str.append(FStringView("hello world"));
+        const char* buffer = str.c_str();
+        str.replace(0, 5, "goodbye");
+        str.insert(str.size(), '!');
+        str.erase(7, 1);
+        REQUIRE( str.c_str() == std::string("goodbyeworld!") );
+        REQUIRE( static_cast<const void*>(str.c_str()) == static_cast<const void*>(buffer) );
+        str.erase();
+        REQUIRE( str.empty() );
+        REQUIRE( str.c_str()[0] == '\0' );
+    }
+
+    SECTION("The replacement may come from the string itself"){
+        FString str = "abcdefghij";
+        str.replace(0, 2, str.view().substr(5));
+        REQUIRE( str.c_str() == std::string("fghijcdefghij") );
+        str.insert(3, str.view());
+        REQUIRE( str.c_str() == std::string("fghfghijcdefghijijcdefghij") );
+        FString small = "abc";
+        small.replace(1, 1, small.view());
+        REQUIRE( small.c_str() == std::string("aabcc") );
+    }
+
+    SECTION("replace_all"){
+        FString str = "foo bar foo baz foo";
+        REQUIRE( str.replace_all("foo", "x") == 3 );
+        REQUIRE( str.c_str() == std::string("x bar x baz x") );
+        REQUIRE( str.replace_all("x", "quux") == 3 );
+        REQUIRE( str.c_str() == std::string("quux bar quux baz quux") );
+        REQUIRE( str.replace_all("quux ", "") == 2 );
+        REQUIRE( str.c_str() == std::string("bar baz quux") );
+        REQUIRE( str.replace_all("nothing", "x") == 0 );
+        REQUIRE( str.replace_all("", "x") == 0 );
+        REQUIRE( str.replace_all("a", "a") == 2 );
+
+        FString runs = "aaaaa";
+        REQUIRE( runs.replace_all("aa", "b") == 2 );
+        REQUIRE( runs.c_str() == std::string("bba") );
+
+        std::string big;
+        for(int i = 0; i < 300; i++)
+            big += "$(NAME)/";
+        FString macro{FStringView(big)};
+        REQUIRE( macro.replace_all("$(NAME)", "expanded_value") == 300 );
+        std::string expected;
+        for(int i = 0; i < 300; i++)
+            expected += "expanded_value/";
+        REQUIRE( macro.size() == expected.size() );
+        REQUIRE( macro.c_str() == expected );
+
+        FString self = "abab";
+        REQUIRE( self.replace_all(self.view().substr(0, 2), self.view()) == 2 );
+        REQUIRE( self.c_str() == std::string("abababab") );
+    }
+
+    SECTION("replace_all grows in place within the capacity"){
+        FString sso = "a-b";
+        const SizeType ssoCapacity = sso.capacity();
+        REQUIRE( sso.replace_all("-", "--") == 1 );
+        REQUIRE( sso.c_str() == std::string("a--b") );
+        REQUIRE( sso.capacity() == ssoCapacity );
+
+        FString runs = "aaaaa";
+        runs.reserve(64);
+        const char* buffer = runs.c_str();
+        REQUIRE( runs.replace_all("aa", "aaa") == 2 );
+        REQUIRE( runs.c_str() == std::string("aaaaaaa") );
+        REQUIRE( runs.c_str() == buffer );
+
+        FString path = "x/y/z/";
+        path.reserve(40);
+        buffer = path.c_str();
+        REQUIRE( path.replace_all("/", "::") == 3 );
+        REQUIRE( path.c_str() == std::string("x::y::z::") );
+        REQUIRE( path.replace_all("::", "<sep>") == 3 );
+        REQUIRE( path.c_str() == std::string("x<sep>y<sep>z<sep>") );
+        REQUIRE( path.c_str() == buffer );
+        REQUIRE( path.capacity() == 40 );
+    }
 }
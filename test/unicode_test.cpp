@@ -0,0 +1,247 @@
+/*
+* ParserDataStructures
+*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Author: Ibrahim Timothy Onogu
+* Email: ionogu@acm.org
+* Project Date: March, 2016
+*/
+
+#include "catch.hpp"
+#include <string>
+#include <vector>
+#include <random>
+#include "Unicode.hpp"
+
+namespace {
+
+std::string encode(char32_t cp){
+    std::string out;
+    if(cp < 0x80)
+        out += static_cast<char>(cp);
+    else if(cp < 0x800){
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else if(cp < 0x10000){
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else{
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+//! Mostly ASCII with runs of two, three and four byte sequences
+std::vector<char32_t> random_code_points(std::mt19937& gen, std::size_t n){
+    std::vector<char32_t> cps;
+    std::uniform_int_distribution<int> kind(0, 9);
+    for(std::size_t i = 0; i < n; i++){
+        char32_t cp;
+        switch(kind(gen)){
+        case 0: cp = 0x80 + gen() % (0x800 - 0x80); break;
+        case 1: do{ cp = 0x800 + gen() % (0x10000 - 0x800); } while(cp >= 0xD800 && cp <= 0xDFFF); break;
+        case 2: cp = 0x10000 + gen() % (0x110000 - 0x10000); break;
+        default: cp = 0x20 + gen() % 0x5F; break;
+        }
+        cps.push_back(cp);
+    }
+    return cps;
+}
+
+std::u16string encode16(const std::vector<char32_t>& cps){
+    std::u16string out;
+    for(char32_t cp : cps){
+        if(cp < 0x10000)
+            out += static_cast<char16_t>(cp);
+        else{
+            out += static_cast<char16_t>(0xD800 + ((cp - 0x10000) >> 10));
+            out += static_cast<char16_t>(0xDC00 + ((cp - 0x10000) & 0x3FF));
+        }
+    }
+    return out;
+}
+
+bool all_validators_agree(const std::string& text, bool expected){
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* last = first + text.size();
+    bool ok = is_valid_utf8(FStringView(text)) == expected;
+    ok = ok && (utf8_detail::find_invalid_scalar(first, last) == nullptr) == expected;
+#ifdef SIMD_SSSE3
+    if(simd::cpu_has_ssse3())
+        ok = ok && utf8_detail::validate_ssse3(first, last) == expected;
+#endif
+#ifdef SIMD_AVX2
+    if(simd::cpu_has_avx2())
+        ok = ok && utf8_detail::validate_avx2(first, last) == expected;
+#endif
+    return ok;
+}
+
+}
+
+TEST_CASE("UTF-8 validation", "[unicode]"){
+
+    SECTION("Well formed text at every alignment"){
+        std::mt19937 gen(34);
+        std::string text;
+        for(char32_t cp : random_code_points(gen, 400))
+            text += encode(cp);
+        for(std::size_t start = 0; start < 70; start += 5)
+            REQUIRE( all_validators_agree(text.substr(start + (start % 3)), is_valid_utf8(FStringView(text).substr(start + (start % 3)))) );
+        REQUIRE( all_validators_agree(text, true) );
+        REQUIRE( all_validators_agree(encode(0x10FFFF) + encode(0xFFFF) + encode(0x7FF) + encode(0), true) );
+    }
+
+    SECTION("Malformed sequences are rejected wherever they appear"){
+        const std::vector<std::string> bad = {
+            "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80",
+            "\xED\xBF\xBF", "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80",
+            "\xFF", "\xC2", "\xE2\x82", "\xF0\x9F\x98", "\xC2\x41", "\xE2\x28\xA1", "\xC2\xA9\xA9"
+        };
+        const std::string padding(40, 'a');
+        for(const auto& seq : bad){
+            INFO( seq.size() );
+            for(std::size_t before = 0; before < 40; before += 3){
+                REQUIRE( all_validators_agree(padding.substr(0, before) + seq, false) );
+                REQUIRE( all_validators_agree(padding.substr(0, before) + seq + padding, false) );
+            }
+        }
+        REQUIRE( find_invalid_utf8(FStringView("abc\xC0\x80")) == 3 );
+        REQUIRE( find_invalid_utf8(FStringView("abc")) == FStringView::npos );
+    }
+
+    SECTION("Random corruption agrees with the scalar validator"){
+        std::mt19937 gen(35);
+        for(int round = 0; round < 2000; round++){
+            std::string text;
+            for(char32_t cp : random_code_points(gen, 20 + gen() % 60))
+                text += encode(cp);
+            for(int k = gen() % 3; k >= 0; k--)
+                text[gen() % text.size()] = static_cast<char>(gen());
+            const unsigned char* first = reinterpret_cast<const unsigned char*>(text.data());
+            const bool expected = utf8_detail::find_invalid_scalar(first, first + text.size()) == nullptr;
+            REQUIRE( all_validators_agree(text, expected) );
+        }
+    }
+}
+
+TEST_CASE("Counting and iterating code points", "[unicode]"){
+    std::mt19937 gen(36);
+    for(int round = 0; round < 50; round++){
+        const auto cps = random_code_points(gen, gen() % 200);
+        std::string text;
+        for(char32_t cp : cps)
+            text += encode(cp);
+        const FString str(text);
+        REQUIRE( count_code_points(str) == cps.size() );
+
+        std::vector<char32_t> decoded;
+        for(char32_t cp : code_points(str))
+            decoded.push_back(cp);
+        REQUIRE( decoded == cps );
+    }
+
+    SECTION("Malformed bytes become replacement characters"){
+        std::vector<char32_t> decoded;
+        for(char32_t cp : code_points(FStringView("a\xC0\x80" "b\xE2\x82")))
+            decoded.push_back(cp);
+        REQUIRE( decoded == (std::vector<char32_t>{ U'a', 0xFFFD, 0xFFFD, U'b', 0xFFFD, 0xFFFD }) );
+    }
+
+    SECTION("Iterators expose their position"){
+        const FString str("\xC3\xA9t\xC3\xA9");
+        auto it = code_points(str).begin();
+        REQUIRE( *it == 0xE9 );
+        ++it;
+        REQUIRE( it.base() == str.data() + 2 );
+        REQUIRE( *it == U't' );
+    }
+}
+
+TEST_CASE("Transcoding between UTF-8, UTF-16 and UTF-32", "[unicode]"){
+    std::mt19937 gen(2016);
+
+    SECTION("Random text round trips through every encoding"){
+        for(std::size_t n = 0; n < 200; n += 1 + n / 8){
+            const auto cps = random_code_points(gen, n);
+            std::string utf8;
+            for(char32_t cp : cps)
+                utf8 += encode(cp);
+            const std::u16string utf16 = encode16(cps);
+            const std::u32string utf32(cps.begin(), cps.end());
+
+            REQUIRE(to_utf16(FStringView(utf8)).to_string() == utf16);
+            REQUIRE(to_utf32(FStringView(utf8)).to_string() == utf32);
+            REQUIRE(to_utf8(F16StringView(utf16)).to_string() == utf8);
+            REQUIRE(to_utf32(F16StringView(utf16)).to_string() == utf32);
+            REQUIRE(to_utf8(F32StringView(utf32)).to_string() == utf8);
+            REQUIRE(to_utf16(F32StringView(utf32)).to_string() == utf16);
+        }
+    }
+
+    SECTION("ASCII blocks at every offset"){
+        std::string ascii;
+        for(int i = 0; i < 70; i++)
+            ascii += static_cast<char>('!' + i);
+        for(std::size_t at = 0; at < ascii.size(); at++){
+            std::string text = ascii;
+            text.insert(at, "\xC3\xA9");   // é
+            const std::u32string utf32 = to_utf32(FStringView(text)).to_string();
+            REQUIRE(utf32.size() == ascii.size() + 1);
+            REQUIRE(utf32[at] == U'\u00E9');
+            REQUIRE(to_utf8(F32StringView(utf32)).to_string() == text);
+            REQUIRE(to_utf8(to_utf16(FStringView(text))).to_string() == text);
+        }
+    }
+
+    SECTION("Appending keeps what is already there"){
+        F16String out(u"ab");
+        append_utf16(out, FStringView("c\xE2\x82\xAC"));
+        append_utf16(out, F32StringView(U"\U0001F600"));
+        REQUIRE(out.to_string() == u"abc\u20AC\U0001F600");
+
+        FString utf8("x");
+        append_utf8(utf8, F16StringView(out));
+        REQUIRE(utf8.to_string() == std::string("xabc\xE2\x82\xAC\xF0\x9F\x98\x80"));
+    }
+
+    SECTION("Malformed input becomes U+FFFD"){
+        REQUIRE(to_utf32(FStringView("a\xFF" "b\xE2\x82")).to_string() == U"a\uFFFDb\uFFFD\uFFFD");
+        REQUIRE(to_utf16(FStringView("\xED\xA0\x80")).to_string() == u"\uFFFD\uFFFD\uFFFD");
+
+        const char16_t lone[] = { u'a', 0xD800, u'b', 0xDC00 };
+        REQUIRE(to_utf32(F16StringView(lone, 4)).to_string() == U"a\uFFFDb\uFFFD");
+        REQUIRE(to_utf8(F16StringView(lone, 4)).to_string() == std::string("a\xEF\xBF\xBD" "b\xEF\xBF\xBD"));
+
+        const char32_t bad[] = { U'a', 0xD800, 0x110000, U'b' };
+        REQUIRE(to_utf16(F32StringView(bad, 4)).to_string() == u"a\uFFFD\uFFFDb");
+        REQUIRE(to_utf8(F32StringView(bad, 4)).to_string() == std::string("a\xEF\xBF\xBD\xEF\xBF\xBD" "b"));
+    }
+
+    SECTION("Long malformed runs through the vector paths"){
+        std::u16string utf16(40, u'x');
+        utf16[17] = 0xDBFF;     // high surrogate followed by a plain unit
+        const std::u32string utf32 = to_utf32(F16StringView(utf16)).to_string();
+        REQUIRE(utf32.size() == 40);
+        REQUIRE(utf32[17] == 0xFFFD);
+        REQUIRE(to_utf8(F16StringView(utf16)).size() == 39 + 3);
+
+        std::u32string wide(40, U'y');
+        wide[9] = 0xDFFF;
+        wide[30] = 0x10FFFF;
+        const std::u16string narrow = to_utf16(F32StringView(wide)).to_string();
+        REQUIRE(narrow.size() == 41);
+        REQUIRE(narrow[9] == 0xFFFD);
+        REQUIRE(narrow[30] == 0xDBFF);
+        REQUIRE(narrow[31] == 0xDFFF);
+    }
+}
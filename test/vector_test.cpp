@@ -16,7 +16,15 @@
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <string>
+#include <memory>
+#include <list>
+#include <sstream>
+#include <cstring>
 #include "FVector.hpp"
+#include "String.hpp"
+#include "HashMap.hpp"
+#include "SmallFVector.hpp"
 
 TEST_CASE( "vectors can be sized and resized", "[vector]" ) {
 
@@ -354,3 +362,162 @@ TEST_CASE( "Test Swap and Assign", "[vector]" ){
         REQUIRE( v.size() == 5 );
     }
 }
+
+//! Holds a pointer into itself, so it must be moved by its constructor
+struct SelfReferencing{
+    int value;
+    int* self = &value;
+
+    SelfReferencing(int v) : value(v) {}
+    SelfReferencing(const SelfReferencing& other) : value(other.value) {}
+    SelfReferencing& operator = (const SelfReferencing& other){ value = other.value; return *this; }
+};
+
+TEST_CASE( "Relocatable elements are moved as bytes", "[vector]" ) {
+    static_assert(IsTriviallyRelocatable<int>::value, "");
+    static_assert(IsTriviallyRelocatable<FString>::value, "");
+    static_assert(IsTriviallyRelocatable<FVector<std::string>>::value, "");
+    static_assert(IsTriviallyRelocatable<HashMap<FString, int>>::value, "");
+    static_assert(!IsTriviallyRelocatable<std::string>::value, "");
+    static_assert(!IsTriviallyRelocatable<SmallFVector<int, 4>>::value, "");
+    static_assert(!IsTriviallyRelocatable<SelfReferencing>::value, "");
+
+    const std::string long_text(50, 'L');
+
+    SECTION("Growing, erasing and shrinking a vector of strings"){
+        FVector<FString> v;
+        for(int i = 0; i < 1000; i++)
+            v.push_back(FString(i % 2 ? long_text : std::to_string(i)));
+        REQUIRE( v[998] == "998" );
+        REQUIRE( v[999].to_string() == long_text );
+
+        auto next = v.erase(v.begin() + 10, v.begin() + 990);
+        REQUIRE( v.size() == 20 );
+        REQUIRE( *next == "990" );
+        REQUIRE( v[9].to_string() == long_text );
+
+        v.shrink_to_fit();
+        REQUIRE( v.capacity() == 20 );
+        REQUIRE( v[19].to_string() == long_text );
+
+        auto after = v.erase(v.begin(), v.end());
+        REQUIRE( after == v.end() );
+        REQUIRE( v.empty() );
+        v.shrink_to_fit();
+        REQUIRE( v.capacity() == 0 );
+        v.push_back(FString(long_text));
+        REQUIRE( v.size() == 1 );
+    }
+
+    SECTION("Vectors of vectors and of maps"){
+        FVector<FVector<std::string>> v;
+        for(int i = 0; i < 100; i++)
+            v.push_back(FVector<std::string>{ long_text, std::to_string(i) });
+        v.erase(v.begin());
+        REQUIRE( v[0][1] == "1" );
+        REQUIRE( v[98][0] == long_text );
+
+        FVector<HashMap<FString, int>> maps;
+        for(int i = 0; i < 20; i++){
+            maps.emplace_back();
+            maps.back().insert({ FString(long_text), i });
+        }
+        REQUIRE( maps[19].find(FString(long_text))->second == 19 );
+    }
+
+    SECTION("Other elements are moved by their constructors"){
+        FVector<SelfReferencing> v;
+        for(int i = 0; i < 100; i++)
+            v.emplace_back(i);
+        v.erase(v.begin() + 3);
+        for(SizeType i = 0; i < v.size(); i++)
+            REQUIRE( v[i].self == &v[i].value );
+        REQUIRE( v[3].value == 4 );
+    }
+
+    SECTION("Elements are destroyed with the vector"){
+        auto tracker = std::make_shared<int>(0);
+        {
+            FVector<std::shared_ptr<int>> v;
+            for(int i = 0; i < 10; i++)
+                v.push_back(tracker);
+            v.erase(v.begin());
+            REQUIRE( tracker.use_count() == 10 );
+        }
+        REQUIRE( tracker.use_count() == 1 );
+    }
+}
+
+TEST_CASE( "Bulk appends and inserts", "[vector]" ) {
+    const std::string long_text(40, 'L');
+
+    SECTION("Resizing with a value and without initializing"){
+        FVector<int> v{ 1, 2, 3 };
+        v.resize(6, 9);
+        REQUIRE( (std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 1, 2, 3, 9, 9, 9 }) );
+        v.resize(20, v[0]);
+        REQUIRE( v[19] == 1 );
+        v.resize(2, 5);
+        REQUIRE( v.size() == 2 );
+
+        FVector<char> buffer;
+        buffer.resize_uninitialized(5);
+        REQUIRE( buffer.size() == 5 );
+        std::memcpy(buffer.data(), "hello", 5);
+        buffer.resize_uninitialized(3);
+        REQUIRE( buffer.size() == 3 );
+        REQUIRE( buffer[2] == 'l' );
+    }
+
+    SECTION("Appending pointers, FVector and std iterators"){
+        FVector<int> v;
+        const int data[] = { 1, 2, 3, 4 };
+        v.append(data, 4);
+        v.append(std::begin(data), std::end(data));
+        std::vector<int> x{ 7, 8 };
+        v.append(x.begin(), x.end());
+        FVector<int> w{ 5, 6 };
+        v.append(w.cbegin(), w.cend());
+        std::list<int> l{ 10, 11 };
+        v.append(l.begin(), l.end());
+        REQUIRE( (std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 1, 2, 3, 4, 1, 2, 3, 4, 7, 8, 5, 6, 10, 11 }) );
+    }
+
+    SECTION("Appending a vector to itself"){
+        FVector<int> v{ 1, 2, 3 };
+        v.shrink_to_fit();
+        v.append(v.data(), v.size());
+        v.append(v.begin(), v.end());
+        REQUIRE( (std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 1, 2, 3, 1, 2, 3, 1, 2, 3, 1, 2, 3 }) );
+    }
+
+    SECTION("Appending strings copies them"){
+        FVector<FString> v;
+        std::vector<FString> x{ FString(long_text), FString("b") };
+        v.append(x.data(), 2);
+        v.append(x.begin(), x.end());
+        REQUIRE( v.size() == 4 );
+        REQUIRE( v[2].to_string() == long_text );
+        REQUIRE( x[0].to_string() == long_text );
+    }
+
+    SECTION("Inserting a range"){
+        FVector<int> v{ 1, 2, 6 };
+        const int middle[] = { 3, 4, 5 };
+        auto it = v.insert(v.begin() + 2, std::begin(middle), std::end(middle));
+        REQUIRE( *it == 3 );
+        v.insert(v.begin(), std::begin(middle), std::begin(middle) + 1);
+        v.insert(v.end(), std::begin(middle), std::end(middle));
+        std::istringstream in("8 9");
+        v.insert(v.begin() + 1, std::istream_iterator<int>(in), std::istream_iterator<int>());
+        REQUIRE( (std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 3, 8, 9, 1, 2, 3, 4, 5, 6, 3, 4, 5 }) );
+
+        FVector<FString> s{ FString("a"), FString("d") };
+        std::vector<FString> bc{ FString(long_text), FString("c") };
+        auto at = s.insert(s.begin() + 1, bc.begin(), bc.end());
+        REQUIRE( at->to_string() == long_text );
+        REQUIRE( s.size() == 4 );
+        REQUIRE( s[2] == "c" );
+        REQUIRE( s[3] == "d" );
+    }
+}